@@ -10,6 +10,24 @@
 #include "../include/head.h" 
 
 
+/**
+ * @struct flight_stats
+ * @brief 航班统计结果
+ */
+typedef struct flight_stats {
+    int total;                       ///< 总航班数
+    int status_count[STATUS_KINDS];  ///< 各状态航班数
+    Money min_price;                 ///< 最低票价
+    Money max_price;                 ///< 最高票价
+    Money avg_price;                 ///< 平均票价（四舍五入到分）
+    long seats;                      ///< 总座位数
+    long seats_sold;                 ///< 已售座位数
+    int sold_out;                    ///< 座位已售完的航班数
+} FlightStats;
+
+/// 订单统计回调：用户名、订单数、消费金额、调用方参数
+typedef void (*OrderVisit)(const char* username, int orders, Money spent, void* ctx);
+
 // 分页显示航班信息
 void paginated_display(FlightNode* );
 
@@ -19,8 +37,15 @@ int set_flight_info();       ///< 添加航班信息
 int del_flight_info();       ///< 删除航班信息
 int change_flight_info();    ///< 修改航班信息
 int administrators();        ///< 管理员主菜单
-int update_flight_info();    ///< 更新航班信息文件
+int update_flight_info(int op, const char* number); ///< 记录航班修改到文件
 int flight_report();         ///< 航班统计报表
 int order_report();          ///< 订单统计报表
 
+// 不交互的管理操作（供菜单和批处理命令共用）
+int add_flight(const char* text);                                  ///< 按一行文本添加航班
+int remove_flight(const char* number);                             ///< 删除航班
+int modify_flight(const char* number, char field, const char* value); ///< 修改航班的一个字段
+int flight_stats(FlightStats* stats);                              ///< 统计航班状态和票价
+int order_stats(OrderVisit visit, void* ctx, int* total_orders, Money* total_revenue); ///< 逐个用户统计订单
+
 #endif
\ No newline at end of file
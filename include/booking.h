@@ -0,0 +1,40 @@
+/**
+ * @file booking.h
+ * @brief 线程安全的订票引擎接口
+ *
+ * 购票、退票和充值可以从多个工作线程同时调用。
+ * 加锁顺序固定为：目录共享锁 → 航班分段锁（按分段号升序） → 用户分段锁，
+ * 同一航班或同一用户的操作串行执行，不同航班、不同用户的操作并行执行。
+ *
+ * 订单提交和余额修改在用户锁内完成。订单文件是提交点：订单事件记录扣款或退款金额和
+ * 该用户的事件序号，提交后才修改用户记录的余额和order_seq；两次写入之间崩溃时，
+ * 下次登录或购票、退票前结算（settle）按序号补记，余额与订单不会不一致。
+ * 提交之前任何一步失败都撤回已完成的部分。
+ *
+ * 座位库存以原子比较交换修改：购票先暂占座位（held），订单提交后转为已售（sold），
+ * 失败时释放暂占；退票归还已售座位。sold和held合为一个字同时修改，
+ * sold + held 任何时刻都不超过 capacity，不加锁的读者经seats_stock()读到的也满足。
+ * 座位号在航班锁内从座位图分配，与订单一起提交，退票时释放。
+ */
+#ifndef __BOOKING_H__
+#define __BOOKING_H__
+
+#include "flight.h"
+#include "order.h"
+#include "seatmap.h"
+
+#define BOOKING_STRIPES 64                   ///< 航班锁和用户锁各自的分段数
+#define BOOKING_TICKETS_MAX SEAT_GROUP_MAX   ///< 一次购买的最多票数
+
+// 订票引擎函数声明
+int booking_purchase(User* u, OrderSession* orders, const char* const* numbers, int n, int* seats); ///< 扣款并购买一个或多个航段
+int booking_purchase_seats(User* u, OrderSession* orders, const char* number, int count, SeatPref pref,
+                           int* seats);                                                ///< 扣款并购买同一航班的多张票
+int booking_refund(User* u, OrderSession* orders, const char* number);                 ///< 退订一个航班的订单
+int booking_recharge(User* u, Money amount);                                           ///< 充值
+int booking_settle(User* u, OrderSession* orders);                                     ///< 把未结算的订单事件计入余额
+int booking_set_password(User* u, const char* password);                               ///< 修改密码（不覆盖余额）
+int seats_available(const Flight_n* f);                                                ///< 剩余可售座位数
+void seats_stock(const Flight_n* f, int* sold, int* held);                             ///< 一致地读取已售和暂占座位数
+
+#endif // __BOOKING_H__
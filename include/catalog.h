@@ -0,0 +1,33 @@
+/**
+ * @file catalog.h
+ * @brief 航班目录存储接口
+ *
+ * 主航班链表(List)的节点统一分配在按块连续存放的目录中，
+ * 每个节点拥有稳定的句柄（槽位号），可按槽位顺序连续遍历
+ */
+#ifndef __CATALOG_H__
+#define __CATALOG_H__
+
+#include "list.h"
+
+#define CATALOG_CHUNK_SIZE 4096 ///< 每块包含的节点数
+#define INVALID_HANDLE (-1)     ///< 无效句柄
+
+typedef int FlightHandle; ///< 航班句柄（目录槽位号）
+
+// 目录操作函数声明
+FlightNode* catalog_alloc(Flight_n* fn);       ///< 从目录分配节点
+void catalog_release(FlightNode* node);        ///< 归还节点槽位
+FlightNode* catalog_node(FlightHandle h);      ///< 句柄转节点指针
+int catalog_count();                           ///< 目录中的航班数
+int catalog_reserve(int n);                    ///< 预留至少n个槽位
+FlightHandle catalog_first();                  ///< 第一个有效句柄
+FlightHandle catalog_next(FlightHandle h);     ///< 下一个有效句柄
+void catalog_touch();                          ///< 标记目录内容已修改
+unsigned long catalog_generation();            ///< 目录修改计数
+void catalog_clear();                          ///< 释放整个目录
+void catalog_lock_shared();                    ///< 共享锁（订票线程读取航班）
+void catalog_lock_exclusive();                 ///< 独占锁（增删改航班）
+void catalog_unlock();                         ///< 解锁
+
+#endif // __CATALOG_H__
@@ -0,0 +1,24 @@
+/**
+ * @file command.h
+ * @brief 批处理命令接口
+ *
+ * 不经过交互菜单，按行执行命令（注册、登录、查询、购票、退票、充值、
+ * 航班增删改、报表），供脚本和压力测试驱动系统。
+ *
+ * 每条命令的输出为若干制表符分隔的数据行，最后一行为"ok"或
+ * "error\t<状态码>\t<说明>"。空行和以#开头的行被忽略。
+ */
+#ifndef __COMMAND_H__
+#define __COMMAND_H__
+
+#include <stdio.h>
+
+#define COMMAND_LINE_MAX 256 ///< 一条命令的最大长度（含换行）
+#define COMMAND_ARGS_MAX 12  ///< 一条命令的最多参数数（含命令名）
+
+// 批处理函数声明
+int command_execute(char* line, FILE* out); ///< 执行一条命令（line会被修改）
+int run_batch(FILE* in, FILE* out);         ///< 逐行执行命令直到输入结束或quit
+void command_reply(FILE* out, int code, const char* message); ///< 输出命令的结束行（ok或error）
+
+#endif // __COMMAND_H__
@@ -0,0 +1,53 @@
+/**
+ * @file dict.h
+ * @brief 航班字符串字典接口
+ *
+ * 机场名和航空公司名只有少量不同取值，在每个航班和订单中反复出现。
+ * 名称登记到字典后以小整数id保存和比较，航班状态为枚举。
+ * 字典只追加不删除（id永不复用），新名称登记时立即追加到字典文件，
+ * 因此引用id的航班数据文件、修改日志和订单文件总能找到对应名称。
+ */
+#ifndef __DICT_H__
+#define __DICT_H__
+
+#define DICT_NAME_MAX 20       ///< 名称最大长度（含结束符）
+#define DICT_NONE 0            ///< 无效id（未登记的名称）
+#define DICT_FILE_MAGIC "DICT" ///< 字典文件标识
+
+typedef unsigned short DictId; ///< 字典id（从1开始，按登记顺序分配）
+
+/**
+ * @enum dict_kind
+ * @brief 字典种类（各自独立编号）
+ */
+typedef enum dict_kind
+{
+    DICT_AIRPORT = 0, ///< 机场名
+    DICT_AIRLINE = 1, ///< 航空公司名
+    DICT_KINDS = 2    ///< 字典种类数
+} DictKind;
+
+/**
+ * @enum flight_status
+ * @brief 航班状态
+ */
+typedef enum flight_status
+{
+    STATUS_UNKNOWN = 0,   ///< 未知
+    STATUS_ON_TIME = 1,   ///< 准点
+    STATUS_DELAYED = 2,   ///< 延误
+    STATUS_CANCELLED = 3, ///< 取消
+    STATUS_KINDS = 4      ///< 状态种类数
+} FlightStatus;
+
+// 字典函数声明
+DictId dict_intern(DictKind kind, const char* name); ///< 登记名称（已登记返回原id），失败返回DICT_NONE
+DictId dict_lookup(DictKind kind, const char* name); ///< 查找名称，未登记返回DICT_NONE
+const char* dict_name(DictKind kind, DictId id);     ///< id对应的名称（无效id为空串）
+void dict_close();                                   ///< 关闭字典并释放内存
+
+// 航班状态函数声明
+const char* status_name(FlightStatus status);             ///< 状态显示名称
+int status_parse(const char* name, FlightStatus* status); ///< 解析状态名称
+
+#endif // __DICT_H__
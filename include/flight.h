@@ -30,7 +30,8 @@ typedef struct usertype {
     char username[U];           ///< 用户名
     char password[P];           ///< 密码
     Permission type;            ///< 权限级别
-    double balance;             ///< 账户余额
+    uint32_t order_seq;         ///< 已计入余额的最后一个订单事件序号
+    Money balance;              ///< 账户余额（分）
     struct FlightNode* userorders; ///< 用户订单链表
 } User;
 
@@ -42,5 +43,7 @@ int enroll(char username[20], char password[16]); ///< 用户注册
 int display();                   ///< 显示主菜单
 int sort_info(FlightNode* h);    ///< 航班信息排序
 int exit_system();               ///< 安全退出系统
+int log_off();                   ///< 退出登录（不交互）
+void release_system();           ///< 释放全局资源（不退出进程）
 
 #endif // __FLIGHT_H__
\ No newline at end of file
@@ -0,0 +1,49 @@
+/**
+ * @file graph.h
+ * @brief 航线图与中转查询接口
+ *
+ * 以机场为顶点、航班为带时刻的边构建航线图，随主航班链表的增删改
+ * 增量维护（由index_insert()/index_remove()调用），用于查询中转方案。
+ * 航班按每日同一时刻执行处理。
+ */
+#ifndef __GRAPH_H__
+#define __GRAPH_H__
+
+#include "list.h"
+
+#define MAX_LEGS 3          ///< 每个方案最多航段数（最多两次中转）
+#define MIN_LAYOVER 60      ///< 默认最短中转时间（分钟）
+
+/**
+ * @enum rank_order
+ * @brief 中转方案排序方式
+ */
+typedef enum rank_order {
+    RANK_BY_PRICE = 0,      ///< 按总价
+    RANK_BY_ARRIVAL = 1     ///< 按到达时间
+} RankOrder;
+
+/**
+ * @struct itinerary
+ * @brief 中转方案
+ *
+ * 时刻均为相对首段出发当日0点的分钟数，可超过1440表示次日及以后。
+ */
+typedef struct itinerary {
+    FlightNode* legs[MAX_LEGS]; ///< 各航段（主链表节点）
+    long departure[MAX_LEGS];   ///< 各航段出发时刻
+    long arrival[MAX_LEGS];     ///< 各航段到达时刻
+    int count;                  ///< 航段数
+    Money price;                ///< 总价（分）
+} Itinerary;
+
+// 航线图维护函数声明
+int graph_add_flight(FlightNode* node);     ///< 加入航班边
+int graph_remove_flight(FlightNode* node);  ///< 移除航班边
+void graph_clear();                         ///< 清空航线图
+
+// 中转查询函数声明
+int search_connections(const char* s, const char* e, int max_legs, int min_layover,
+                       RankOrder order, Itinerary* out, int k); ///< 查询最优的k个中转方案
+
+#endif // __GRAPH_H__
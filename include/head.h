@@ -17,6 +17,18 @@
 #include <errno.h>
 #include <time.h> 
 #include <dirent.h>
+#include <float.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <signal.h>
+#include <pthread.h>
 //#include <ctype.h>
 
 // 项目自定义头文件
@@ -24,7 +36,19 @@
 #include "user.h"    ///< 用户功能接口
 #include "admin.h"   ///< 管理员功能接口
 #include "list.h"    ///< 链表操作接口
+#include "dict.h"    ///< 航班字符串字典接口
+#include "money.h"   ///< 金额定点数接口
+#include "index.h"   ///< 航班索引接口
+#include "catalog.h" ///< 航班目录存储接口
+#include "pool.h"    ///< 链表节点池与临时内存区接口
+#include "graph.h"   ///< 航线图与中转查询接口
+#include "userstore.h" ///< 用户存储接口
+#include "record.h"  ///< 数据文件格式定义
 #include "order.h"   ///< 订单操作接口
+#include "command.h" ///< 批处理命令接口
+#include "server.h"  ///< 多客户端订票服务接口
+#include "booking.h" ///< 线程安全的订票引擎接口
+#include "seatmap.h" ///< 航班座位图接口
 
 // 系统状态码
 #define SUCCESS 0          ///< 操作成功
@@ -33,6 +57,9 @@
 #define ERR_NOT_FOUND -11  ///< 未找到错误
 #define ERR_EXISTS -12     ///< 已存在错误
 #define ERR_EMPTY -13      ///< 空数据错误
+#define ERR_BALANCE -14    ///< 余额不足
+#define ERR_SOLD_OUT -15   ///< 座位已售完
+#define ERR_SEAT_TAKEN -16 ///< 座位已被占用
 #define BACK 1             ///< 返回操作
 #define EXIT_SYSTEM 2      ///< 退出系统
 
@@ -46,5 +73,9 @@
 // 文件路径常量
 #define LOG_FILE "log/error.log"       ///< 错误日志文件路径
 #define flightS_FILE "data/flights.txt" ///< 航班数据文件路径
+#define JOURNAL_FILE "data/flights.journal" ///< 航班修改日志文件路径
+#define DICT_FILE "data/flights.dict" ///< 机场/航空公司字典文件路径
+#define USERINFO_FILE "data/userinfo.txt"   ///< 用户数据文件路径
+#define USERINDEX_FILE "data/userinfo.idx"  ///< 用户名索引文件路径
 
 #endif // __HEAD_H__
\ No newline at end of file
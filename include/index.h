@@ -0,0 +1,26 @@
+/**
+ * @file index.h
+ * @brief 航班索引接口
+ *
+ * 为主航班链表(List)维护按航班号的开放寻址哈希索引和
+ * 按(出发机场, 到达机场)的航线索引（每条航线另有按出发时间、价格排序的数组）
+ * 以及航线图(graph.h)，
+ * 由tail_insert()、delete_flight()、change_node()等链表操作同步更新
+ */
+#ifndef __INDEX_H__
+#define __INDEX_H__
+
+#include "list.h"
+
+// 索引操作函数声明
+int index_insert(FlightNode* node);            ///< 将节点加入全部索引
+int index_remove(FlightNode* node);            ///< 从全部索引中移除节点
+FlightNode* index_find(const char* number);    ///< 按航班号查找节点
+FlightNode* const* route_find(const char* s, const char* e, int* count); ///< 按航线查找航班
+FlightNode* const* route_time_range(const char* s, const char* e, int from, int to, int* count); ///< 按航线和出发时段查找航班
+FlightNode* const* route_price_range(const char* s, const char* e, Money low, Money high, int* count); ///< 按航线和价格区间查找航班
+int index_reserve(int n);                      ///< 预留至少n个航班的索引空间
+int index_rebuild(FlightNode* h);              ///< 按链表内容重建全部索引
+void index_clear();                            ///< 清空全部索引并释放内存
+
+#endif // __INDEX_H__
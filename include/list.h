@@ -7,19 +7,38 @@
 #ifndef __LIST_H__
 #define __LIST_H__
 
+#include <stdint.h>
+#include "dict.h"
+#include "money.h"
+
 /**
  * @struct flight_n
- * @brief 航班信息数据结构
+ * @brief 航班信息数据结构（56字节）
+ *
+ * 机场和航空公司为字典id（dict_name()取名称），状态为枚举。
+ * 座位库存sold、held合为一个64位字stock，由订票线程以一次比较交换同时修改，
+ * 不加锁的读者经seats_stock()读到的两个计数总是一致的；其余字段只在独占航班目录时修改。
+ * seat只在订单链表中使用，为该订单分配的座位号。
  */
 typedef struct flight_n {
     char number[10];           ///< 航班号
-    char airline[20];          ///< 航空公司
-    char departure_time[10];   ///< 出发时间
-    char arrival_time[10];     ///< 到达时间
-    char departure_airport[10];///< 出发机场
-    char arrival_airport[10];  ///< 到达机场
-    char status[10];           ///< 航班状态
-    double price;              ///< 机票价格
+    char departure_time[6];    ///< 出发时间"HH:MM"
+    char arrival_time[6];      ///< 到达时间"HH:MM"
+    DictId airline;            ///< 航空公司（DICT_AIRLINE）
+    DictId departure_airport;  ///< 出发机场（DICT_AIRPORT）
+    DictId arrival_airport;    ///< 到达机场（DICT_AIRPORT）
+    unsigned char status;      ///< 航班状态（FlightStatus）
+    unsigned char seats_per_row; ///< 每排座位数（0为默认布局）
+    short seat;                ///< 订单的座位号（订单链表中使用，未分配为SEAT_NONE）
+    Money price;               ///< 机票价格（分）
+    int capacity;              ///< 座位数
+    union {
+        struct {
+            int sold;          ///< 已售座位数
+            int held;          ///< 订票进行中暂占的座位数（不保存）
+        };
+        uint64_t stock;        ///< sold和held合成的字（原子操作的对象）
+    };
 } Flight_n;
 
 /**
@@ -28,32 +47,88 @@ typedef struct flight_n {
  */
 typedef struct FlightNode {
     Flight_n flight;           ///< 航班数据
+    short departure_minutes;   ///< 出发时间（当天分钟数，无效为TIME_INVALID）
+    short arrival_minutes;     ///< 到达时间（当天分钟数，无效为TIME_INVALID）
+    int handle;                ///< 目录句柄（不属于主链表目录时为-1）
+    uint64_t* seats;           ///< 座位占用位图（主链表节点使用，没有已分配座位时可为NULL）
     struct FlightNode* prev;   ///< 前驱节点指针
     struct FlightNode* next;   ///< 后继节点指针
 } FlightNode;
 
+#define TIME_INVALID (-1)      ///< 无效的时间分钟数
+
+#define FLIGHT_DEFAULT_CAPACITY 180 ///< 未指定座位数的航班（旧版数据、CSV）的座位数
+#define FLIGHT_CAPACITY_MAX 999     ///< 座位数上限
+
+#define JOURNAL_PUT 'P'        ///< 航班日志操作：新增或修改
+#define JOURNAL_DELETE 'D'     ///< 航班日志操作：删除
+#define JOURNAL_SEAT_TAKE 1    ///< 日志座位操作：分配座位
+#define JOURNAL_SEAT_RELEASE 2 ///< 日志座位操作：释放座位
+#define JOURNAL_CHECKPOINT_LIMIT 256 ///< 日志记录数达到该值时做检查点
+
+/**
+ * @struct flight_view
+ * @brief 航班视图：指向主链表节点的指针数组
+ *
+ * 搜索结果以视图形式返回，不复制航班数据；主链表被修改后视图失效。
+ */
+typedef struct flight_view {
+    FlightNode** items;        ///< 主链表节点指针数组
+    int count;                 ///< 节点数
+    int capacity;              ///< 数组容量
+} FlightView;
+
 // 比较函数指针类型
-typedef int (*CompareFunc)(const Flight_n*, const Flight_n*);
+typedef int (*CompareFunc)(const FlightNode*, const FlightNode*);
+
+// 遍历回调类型（返回非SUCCESS时停止遍历）
+typedef int (*FlightVisitor)(const FlightNode*, void*);
 
 // 比较函数声明
-int compare_by_departure_time(const Flight_n*, const Flight_n*); ///< 按出发时间比较
-int compare_by_price(const Flight_n*, const Flight_n*);          ///< 按价格比较
+int compare_by_departure_time(const FlightNode*, const FlightNode*); ///< 按出发时间比较
+int compare_by_price(const FlightNode*, const FlightNode*);          ///< 按价格比较
+int compare_by_price_then_time(const FlightNode*, const FlightNode*); ///< 按价格、再按出发时间比较
+int compare_by_time_then_price(const FlightNode*, const FlightNode*); ///< 按出发时间、再按价格比较
+
+// 时间解析函数声明
+int parse_time(char* text, short* minutes);      ///< 解析并规范化"HH:MM"时间
+int flight_duration(const FlightNode* node);     ///< 航班飞行时长（分钟）
 
 // 链表操作函数声明
 int load_flights_from_csv(const char* filename); ///< 从CSV加载航班数据
 int load_flights_from_file();  ///< 从文件加载航班数据
-int save_flights_to_file();    ///< 保存航班数据到文件
-int list();                    ///< 链表初始化
+int save_flights_to_file();    ///< 保存航班数据到文件（检查点）
+int journal_flight(int op, const char* number); ///< 记录一次航班修改到日志
+int journal_seat(const char* number, int seat, int seat_op); ///< 记录一次座位分配或释放到日志
+int journal_full();            ///< 日志记录数是否已达到检查点阈值
+int checkpoint_flights();      ///< 有未保存的修改时做检查点
+int list();                    ///< 链表初始化（当前版本数据文件只映射，推迟建立）
+int list_ensure();             ///< 确保主链表已建立
+int flight_count();            ///< 航班数（含尚未建立链表的映射文件）
+int flights_scan(FlightVisitor visit, void* arg); ///< 遍历全部航班（主链表未建立时先建立）
+int flight_snapshot(const char* number, FlightNode* copy); ///< 按航班号复制航班及座位图（只读查询）
 FlightNode* createHead();      ///< 创建链表头节点
 FlightNode* createNode(Flight_n*); ///< 创建新节点
 int isnempty(FlightNode*);     ///< 检查链表是否为空
-int tail_insert(FlightNode*, Flight_n*); ///< 尾插法插入节点
+int tail_insert(FlightNode*, Flight_n*); ///< 尾插法插入节点（解析时间）
+int tail_insert_times(FlightNode*, Flight_n*, short, short); ///< 尾插法插入已解析时间的节点
 int display_all(FlightNode* h); ///< 显示所有航班信息
+int display_orders(FlightNode* h); ///< 显示订单链表（含座位号）
 FlightNode* get_pos(FlightNode* h, char* number); ///< 按航班号查找节点
 int delete_flight(FlightNode* h, char* number); ///< 删除航班节点
 int change_node(FlightNode* h, char* number, char change_n, char* change_message); ///< 修改节点信息
 int search_info(FlightNode* h, char* s, char* e); ///< 搜索航班信息
-void sort_list(FlightNode** h, CompareFunc compare); ///< 链表排序
+void sort_list(FlightNode** h, CompareFunc compare); ///< 链表排序（稳定，结果缓存）
+int search_route(const char* s, const char* e, FlightView* v); ///< 按航线索引搜索航班（返回视图）
+int search_route_sorted(const char* s, const char* e, CompareFunc compare, FlightView* v); ///< 按航线和顺序搜索航班（带缓存）
+void route_cache_stats(unsigned long* hits, unsigned long* misses); ///< 航线搜索缓存命中统计
+int search_route_by_time(const char* s, const char* e, short from, short to, FlightView* v); ///< 按航线和出发时段搜索航班
+int search_route_by_price(const char* s, const char* e, Money low, Money high, FlightView* v); ///< 按航线和价格区间搜索航班
+int search_cheapest(const char* s, const char* e, int k, FlightView* v); ///< 票价最低的K个航班（机场为NULL时为全部航线）
+int display_view(const FlightView* v); ///< 显示视图中的航班信息
+FlightNode* view_find(const FlightView* v, const char* number); ///< 在视图中按航班号查找
+void sort_view(FlightView* v, CompareFunc compare); ///< 视图排序（不改变主链表）
+void free_view(FlightView* v); ///< 释放视图内存
 void paginated_display(FlightNode* );// 分页显示航班信息
 int free_node(FlightNode** h); ///< 释放链表内存
 
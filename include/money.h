@@ -0,0 +1,30 @@
+/**
+ * @file money.h
+ * @brief 金额定点数接口
+ *
+ * 票价、余额和报表金额统一以分为单位的64位整数保存，加减和汇总没有舍入误差，
+ * 分段汇总的结果与顺序汇总完全相同。输入按十进制精确解析，显示时格式化为"元.分"。
+ */
+#ifndef __MONEY_H__
+#define __MONEY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MONEY_SCALE 100        ///< 每元的分数
+#define MONEY_MAX INT64_MAX    ///< 最大金额
+#define MONEY_MIN INT64_MIN    ///< 最小金额
+#define MONEY_TEXT_MAX 32      ///< 格式化金额的缓冲区长度（含结束符）
+
+typedef int64_t Money; ///< 金额（分）
+
+// 转换函数声明
+int money_parse(const char* text, Money* value); ///< 精确解析金额文本（如"980.00元"）
+char* money_format(Money value, char* buf);      ///< 格式化为"980.00"（buf至少MONEY_TEXT_MAX字节）
+Money money_from_double(double yuan);            ///< 浮点元转为金额（旧版记录，四舍五入到分）
+
+// 汇总函数声明（连续数组，可向量化）
+Money money_sum(const Money* values, size_t n);  ///< 金额求和
+void money_minmax(const Money* values, size_t n, Money* min, Money* max); ///< 最小和最大金额
+
+#endif // __MONEY_H__
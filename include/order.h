@@ -7,14 +7,164 @@
 #ifndef ORDER_H
 #define ORDER_H
 
+#include "list.h"
+
+#define ORDER_BOOK 1         ///< 订单事件：购票
+#define ORDER_REFUND 2       ///< 订单事件：退票
+#define ORDER_COMPACT_MIN 32 ///< 读取订单时触发压缩的最少失效事件数
+
+typedef struct order_session OrderSession; ///< 会话订单缓存（定义在order.c中）
+
+/**
+ * @brief 登录时把用户订单加载到会话缓存（每次登录只读一次文件）
+ * @return 操作状态码(SUCCESS/FAILURE)
+ */
+int order_session_open();
+
+/**
+ * @brief 购票：加入会话缓存，待order_commit()写入文件
+ * @param order 购买的航班（价格为实付票价）
+ * @return 操作状态码(SUCCESS/FAILURE)
+ */
+int order_book(const FlightNode* order);
+
+/**
+ * @brief 退票：从会话缓存删除，待order_commit()写入文件
+ * @param number 航班号
+ * @return 操作状态码(SUCCESS/ERR_NOT_FOUND/FAILURE)
+ */
+int order_refund(const char* number);
+
+/**
+ * @brief 提交点：把待写入的购票/退票事件追加到订单文件
+ * @return 操作状态码(SUCCESS/FAILURE)
+ */
+int order_commit();
+
+/**
+ * @brief 退出登录时写入未提交的事件并关闭会话缓存
+ * @return 操作状态码(SUCCESS/FAILURE)
+ */
+int order_session_close();
+
+/**
+ * @brief 创建一个空的会话订单缓存
+ * @return 会话，内存不足返回NULL
+ */
+OrderSession* order_session_create();
+
+/**
+ * @brief 释放会话订单缓存（先order_session_close()）
+ * @param s 会话
+ */
+void order_session_destroy(OrderSession* s);
+
+/**
+ * @brief 切换订单函数操作的会话
+ * @param s 会话（NULL为交互模式的默认会话）
+ * @return 之前的会话
+ */
+OrderSession* order_session_bind(OrderSession* s);
+
+/**
+ * @brief 订单函数当前操作的会话
+ * @return 当前会话
+ */
+OrderSession* order_session_current();
+
+/**
+ * @brief 购票：加入指定会话，待order_session_commit()写入文件
+ * @param s 会话
+ * @param number 航班号
+ * @param price 实付票价（分）
+ * @param seat 座位号（未分配为SEAT_NONE）
+ * @return 操作状态码(SUCCESS/FAILURE)
+ */
+int order_session_book(OrderSession* s, const char* number, Money price, int seat);
+
+/**
+ * @brief 退票：从指定会话删除，待order_session_commit()写入文件
+ * @param s 会话
+ * @param number 航班号
+ * @param price 输出：被退订单的实付票价（可为NULL）
+ * @param seat 输出：被退订单的座位号（可为NULL）
+ * @return 操作状态码(SUCCESS/ERR_NOT_FOUND/FAILURE)
+ */
+int order_session_refund(OrderSession* s, const char* number, Money* price, int* seat);
+
+/**
+ * @brief 提交点：把指定会话待写入的事件追加到订单文件
+ * @param s 会话
+ * @return 操作状态码(SUCCESS/FAILURE)
+ */
+int order_session_commit(OrderSession* s);
+
+/**
+ * @brief 统计订单文件末尾尚未计入余额的事件
+ * @param s 会话
+ * @param settled 已计入余额的最后一个事件序号
+ * @param delta 输出：未计入的余额变化（分）
+ * @param last 输出：计入后的最后一个事件序号
+ * @return 操作状态码(SUCCESS/ERR_NOT_FOUND/FAILURE)
+ */
+int order_session_unsettled(OrderSession* s, uint32_t settled, Money* delta, uint32_t* last);
+
+/**
+ * @brief 记录用户余额已计入的最后一个事件序号
+ * @param s 会话
+ * @param seq 事件序号
+ */
+void order_session_settled(OrderSession* s, uint32_t seq);
+
+/**
+ * @brief 会话已用的最大事件序号
+ * @param s 会话
+ * @return 事件序号
+ */
+uint32_t order_session_seq(const OrderSession* s);
+
+/**
+ * @brief 撤销指定会话中尚未写入的事件
+ * @param s 会话
+ */
+void order_session_discard(OrderSession* s);
+
+/**
+ * @brief 压缩用户订单文件（折叠事件后重写）
+ * @return 操作状态码(SUCCESS/FAILURE)
+ */
+int compact_user_order();
+
+/**
+ * @brief 压缩指定订单文件（旧版文件同时转换为当前格式）
+ * @param filename 订单文件路径
+ * @return 操作状态码(SUCCESS/FAILURE)
+ */
+int compact_order_file(const char* filename);
+
+/**
+ * @brief 把所有旧版订单文件转换为当前格式
+ * @return 转换的文件数，失败返回FAILURE
+ */
+int migrate_order_files();
+
+/**
+ * @brief 按全部订单文件重新统计各航班的已售座位数和座位图（转换旧版航班数据时调用）
+ * @return 计入的订单数，失败返回FAILURE
+ */
+int order_count_seats();
+
 /**
- * @brief 更新用户订单文件
+ * @brief 统计订单文件中的有效订单数和金额
+ * @param filename 订单文件路径
+ * @param orders 输出：有效订单数
+ * @param spent 输出：有效订单总金额（分）
  * @return 操作状态码(SUCCESS/FAILURE)
  */
-int update_user_order();
+int read_order_summary(const char* filename, int* orders, Money* spent);
 
 /**
- * @brief 从文件读取用户订单
+ * @brief 由会话订单缓存建立用户订单链表（不读文件）
  * @return 操作状态码(SUCCESS/FAILURE)
  */
 int read_from_order();
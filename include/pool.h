@@ -0,0 +1,39 @@
+/**
+ * @file pool.h
+ * @brief 链表节点池与临时内存区接口
+ *
+ * 主链表以外的链表（搜索结果、用户订单）的节点从按块分配的节点池中取用，
+ * 释放的节点挂回空闲链表重复使用，整条链表可一次归还。
+ * 搜索和排序过程中的临时数组从临时内存区按栈方式分配，结束时按标记一次释放。
+ * 两者的内存块都保留复用，长时间运行时占用不随操作次数增长。
+ */
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include "list.h"
+
+#define NODE_POOL_SLAB 256         ///< 节点池每块的节点数
+#define ARENA_CHUNK_SIZE (64 * 1024) ///< 临时内存区每块的最小字节数
+
+/**
+ * @struct arena_mark
+ * @brief 临时内存区位置标记
+ */
+typedef struct arena_mark {
+    struct arena_chunk* chunk; ///< 标记时的当前块
+    size_t used;               ///< 标记时当前块已用字节数
+} ArenaMark;
+
+// 节点池函数声明
+FlightNode* node_pool_alloc();                  ///< 取一个节点（内容未初始化）
+void node_pool_free(FlightNode* node);          ///< 归还一个节点
+void node_pool_free_list(FlightNode* head);     ///< 归还整条链表（含头节点）
+void node_pool_clear();                         ///< 释放节点池全部内存
+
+// 临时内存区函数声明
+void* arena_alloc(size_t size);                 ///< 分配临时内存（按max_align_t对齐）
+ArenaMark arena_mark();                         ///< 记录当前位置
+void arena_release(ArenaMark mark);             ///< 释放标记之后分配的全部内存
+void arena_clear();                             ///< 释放临时内存区全部内存
+
+#endif // __POOL_H__
@@ -0,0 +1,184 @@
+/**
+ * @file record.h
+ * @brief 数据文件格式定义
+ *
+ * 所有数据文件以统一的文件头开始（标识、版本、字节序、记录长度、记录数、CRC），
+ * 其后为定长记录。记录只包含定宽字段，没有指针和编译器填充，
+ * 可直接映射到内存读取；内存中的结构体（Flight_n、User）与磁盘格式相互转换。
+ */
+#ifndef __RECORD_H__
+#define __RECORD_H__
+
+#include <stdint.h>
+#include "list.h"
+#include "flight.h"
+
+#define RECORD_VERSION 8            ///< 当前数据文件版本（无文件头的第1版数据在加载时转换）
+#define RECORD_ENDIAN 0x01020304u   ///< 字节序标记（按本机字节序写入）
+
+#define FLIGHTS_FILE_MAGIC "FLT3"   ///< 航班数据文件标识
+#define JOURNAL_FILE_MAGIC "FJN3"   ///< 航班修改日志标识
+#define USERS_FILE_MAGIC "USR3"     ///< 用户数据文件标识
+#define ORDERS_FILE_MAGIC "ORD3"    ///< 订单文件标识
+
+/**
+ * @struct file_header
+ * @brief 数据文件头（32字节）
+ *
+ * 整体写入的文件（航班数据）在payload_crc中记录全部记录的CRC；
+ * 追加或原地修改的文件（日志、用户、订单、字典）payload_crc为0，由每条记录自带CRC。
+ */
+typedef struct file_header {
+    char magic[4];          ///< 文件标识
+    uint16_t version;       ///< 文件版本RECORD_VERSION
+    uint16_t header_size;   ///< 文件头长度
+    uint32_t endian;        ///< 字节序标记RECORD_ENDIAN
+    uint32_t record_size;   ///< 单条记录长度
+    uint64_t count;         ///< 记录数
+    uint32_t payload_crc;   ///< 全部记录的CRC（0为不校验）
+    uint32_t header_crc;    ///< 文件头CRC（计算时本字段为0）
+} FileHeader;
+
+/**
+ * @struct flight_disk
+ * @brief 航班记录（40字节，机场和航空公司为字典id，时间只存分钟数）
+ *
+ * 暂占座位数只在内存中，不保存。座位图不在记录中：航班数据文件在全部记录之后
+ * 按记录顺序存放各航班的座位图（每个座位1位，seatmap_bytes(capacity)字节）。
+ */
+typedef struct flight_disk {
+    char number[10];            ///< 航班号
+    uint16_t airline;           ///< 航空公司（DICT_AIRLINE）
+    uint16_t departure_airport; ///< 出发机场（DICT_AIRPORT）
+    uint16_t arrival_airport;   ///< 到达机场（DICT_AIRPORT）
+    uint8_t status;             ///< 航班状态（FlightStatus）
+    uint8_t seats_per_row;      ///< 每排座位数（0为默认布局）
+    uint8_t reserved[2];        ///< 保留，写0
+    int16_t departure_minutes;  ///< 出发时间（分钟，无效为TIME_INVALID）
+    int16_t arrival_minutes;    ///< 到达时间（分钟，无效为TIME_INVALID）
+    int64_t price;              ///< 机票价格（分）
+    uint16_t capacity;          ///< 座位数
+    uint16_t sold;              ///< 已售座位数
+    uint8_t reserved2[4];       ///< 保留，写0
+} FlightDisk;
+
+/**
+ * @struct journal_disk
+ * @brief 航班修改日志记录（64字节）
+ *
+ * 分配或释放座位时记录一条JOURNAL_PUT，seat_op和seat为该座位的操作，
+ * 重放时先覆盖航班再修改座位图。
+ */
+typedef struct journal_disk {
+    int32_t op;             ///< 操作（JOURNAL_PUT/JOURNAL_DELETE）
+    uint32_t crc;           ///< 记录CRC（计算时本字段为0）
+    char number[10];        ///< 航班号
+    int16_t seat;           ///< 座位号（seat_op为0时不使用）
+    uint8_t seat_op;        ///< 座位操作（0/JOURNAL_SEAT_TAKE/JOURNAL_SEAT_RELEASE）
+    uint8_t reserved[3];    ///< 保留，写0
+    FlightDisk flight;      ///< 新增或修改后的航班（删除时为空）
+} JournalDisk;
+
+/**
+ * @struct user_disk
+ * @brief 用户记录（64字节）
+ *
+ * 余额包含订单文件中序号不超过order_seq的购票、退票事件；
+ * 订单事件先于用户记录写入，序号更大的事件在下次结算时计入余额。
+ */
+typedef struct user_disk {
+    char username[U];       ///< 用户名
+    char password[P];       ///< 密码
+    int32_t type;           ///< 权限级别
+    uint32_t crc;           ///< 记录CRC（计算时本字段为0）
+    int64_t balance;        ///< 账户余额（分）
+    uint32_t order_seq;     ///< 已计入余额的最后一个订单事件序号
+    uint8_t reserved[4];    ///< 保留，写0
+} UserDisk;
+
+/**
+ * @struct order_disk
+ * @brief 订单事件记录（40字节）
+ *
+ * 只引用航班号，不复制航班数据；显示订单时到航班目录中查找航班。
+ * seq为该用户的订单事件序号（1起递增），购票事件的票价为扣款金额，退票事件的票价为退款金额；
+ * 序号为0的事件（第1版转换而来、压缩后的订单）已计入余额。
+ */
+typedef struct order_disk {
+    uint32_t crc;           ///< 记录CRC（计算时本字段为0）
+    uint8_t type;           ///< 事件类型（ORDER_BOOK/ORDER_REFUND）
+    uint8_t reserved;       ///< 保留，写0
+    char number[10];        ///< 航班号
+    int64_t time;           ///< 事件时间（Unix时间，第1版订单转换而来为0）
+    int64_t price;          ///< 实付票价（分）
+    int16_t seat;           ///< 座位号（未分配为SEAT_NONE）
+    uint16_t reserved2;     ///< 保留，写0
+    uint32_t seq;           ///< 订单事件序号（0为已计入余额）
+} OrderDisk;
+
+/**
+ * @struct dict_disk
+ * @brief 字典记录（32字节）
+ */
+typedef struct dict_disk {
+    uint16_t kind;              ///< 字典种类（DictKind）
+    uint16_t id;                ///< 名称id
+    uint32_t crc;               ///< 记录CRC（计算时本字段为0）
+    char name[DICT_NAME_MAX];   ///< 名称
+    char reserved[4];           ///< 保留，写0
+} DictDisk;
+
+/**
+ * @struct legacy_flight
+ * @brief 第1版航班数据文件和订单文件中的航班（当时内存中的Flight_n，88字节）
+ */
+typedef struct legacy_flight {
+    char number[10];           ///< 航班号
+    char airline[20];          ///< 航空公司
+    char departure_time[10];   ///< 出发时间
+    char arrival_time[10];     ///< 到达时间
+    char departure_airport[10];///< 出发机场
+    char arrival_airport[10];  ///< 到达机场
+    char status[10];           ///< 航班状态
+    double price;              ///< 机票价格
+} LegacyFlight;
+
+/**
+ * @struct legacy_user
+ * @brief 第1版用户数据文件中的用户（当时内存中的User，64字节）
+ */
+typedef struct legacy_user {
+    char username[U];       ///< 用户名
+    char password[P];       ///< 密码
+    int32_t type;           ///< 权限级别
+    uint8_t padding[4];     ///< 编译器填充
+    double balance;         ///< 账户余额（元）
+    uint64_t userorders;    ///< 订单链表指针（无意义）
+} LegacyUser;
+
+// 记录长度在编译期固定，结构体变化时编译失败
+typedef char flight_disk_size_check[sizeof(FlightDisk) == 40 ? 1 : -1];
+typedef char journal_disk_size_check[sizeof(JournalDisk) == 64 ? 1 : -1];
+typedef char user_disk_size_check[sizeof(UserDisk) == 64 ? 1 : -1];
+typedef char order_disk_size_check[sizeof(OrderDisk) == 40 ? 1 : -1];
+typedef char dict_disk_size_check[sizeof(DictDisk) == 32 ? 1 : -1];
+typedef char file_header_size_check[sizeof(FileHeader) == 32 ? 1 : -1];
+typedef char legacy_flight_size_check[sizeof(LegacyFlight) == 88 ? 1 : -1];
+typedef char legacy_user_size_check[sizeof(LegacyUser) == 64 ? 1 : -1];
+
+// 校验与文件头函数声明
+uint32_t crc32_update(uint32_t crc, const void* data, size_t len); ///< 累加计算CRC32
+uint32_t record_crc(const void* record, size_t size, size_t crc_offset); ///< 计算自带CRC字段的记录CRC
+void header_init(FileHeader* h, const char* magic, uint32_t record_size, uint64_t count, uint32_t payload_crc); ///< 填写文件头
+int header_check(const FileHeader* h, const char* magic, uint32_t record_size); ///< 校验当前版本文件头
+int header_write(int fd, const char* magic, uint32_t record_size, uint64_t count, uint32_t payload_crc); ///< 写入文件头
+
+// 记录转换函数声明
+void flight_to_disk(const Flight_n* f, short dep, short arr, FlightDisk* d); ///< 航班转为磁盘记录
+void flight_from_disk(const FlightDisk* d, Flight_n* f, short* dep, short* arr); ///< 磁盘记录转为航班
+int flight_from_legacy(const LegacyFlight* l, Flight_n* f); ///< 第1版航班数据转为航班
+void user_to_disk(const User* u, UserDisk* d); ///< 用户转为磁盘记录
+void user_from_disk(const UserDisk* d, User* u); ///< 磁盘记录转为用户
+void user_from_legacy(const LegacyUser* l, User* u); ///< 第1版用户数据转为用户
+
+#endif // __RECORD_H__
@@ -0,0 +1,50 @@
+/**
+ * @file seatmap.h
+ * @brief 航班座位图接口
+ *
+ * 每个主链表航班节点有一张按座位号排列的占用位图（第i位为1表示座位i已分配），
+ * 座位号i对应第 i / 每排座位数 + 1 排、第 i % 每排座位数 列（A、B、C…）。
+ * 查找空座位按64位字整体运算：取反得到空位，移位相与得到连续空位，
+ * 与按列生成的掩码相与后用ctz取第一个满足条件的位置；已分配座位数用popcount统计。
+ * 座位图的修改由订票引擎的航班锁串行化。
+ */
+#ifndef __SEATMAP_H__
+#define __SEATMAP_H__
+
+#include <stdint.h>
+#include "list.h"
+
+#define SEAT_ROW_MAX 10            ///< 每排最多座位数（列A至J）
+#define SEAT_DEFAULT_PER_ROW 6     ///< 未指定布局的航班每排座位数
+#define SEAT_GROUP_MAX SEAT_ROW_MAX ///< 一次最多购买的同行座位数
+#define SEAT_LABEL_MAX 12          ///< 座位名（如"12A"）缓冲区长度，容纳任意int行号加列字母
+#define SEAT_NONE (-1)             ///< 未分配座位
+
+/**
+ * @enum seat_pref
+ * @brief 选座偏好
+ */
+typedef enum seat_pref {
+    SEAT_ANY = 0,    ///< 不限
+    SEAT_WINDOW = 1, ///< 靠窗
+    SEAT_AISLE = 2   ///< 靠过道
+} SeatPref;
+
+// 座位图函数声明
+int seat_row_size(const Flight_n* f);                            ///< 每排座位数
+int seat_take(FlightNode* node, int seat);                       ///< 分配指定座位
+void seat_release(FlightNode* node, int seat);                   ///< 释放座位
+int seat_is_taken(const FlightNode* node, int seat);             ///< 座位是否已分配
+int seat_find(const FlightNode* node, int count, SeatPref pref); ///< 查找同排相邻的空座位
+int seat_taken_count(const FlightNode* node);                    ///< 已分配座位数
+int seat_last_taken(const FlightNode* node);                     ///< 最大的已分配座位号
+int seatmap_resize(FlightNode* node, int capacity);              ///< 按新座位数调整座位图
+void seatmap_free(FlightNode* node);                             ///< 释放座位图
+size_t seatmap_bytes(int capacity);                              ///< 座位图保存所需字节数
+void seatmap_store(const FlightNode* node, unsigned char* bytes);  ///< 座位图写为字节序列
+int seatmap_load(FlightNode* node, const unsigned char* bytes);    ///< 由字节序列恢复座位图
+int seat_parse(const Flight_n* f, const char* text, int* seat);  ///< 解析座位名
+char* seat_label(const Flight_n* f, int seat, char* text);       ///< 座位号转为座位名
+void seatmap_display(const FlightNode* node);                    ///< 显示座位图
+
+#endif // __SEATMAP_H__
@@ -0,0 +1,23 @@
+/**
+ * @file server.h
+ * @brief 多客户端订票服务接口
+ *
+ * 服务器模式下航班数据常驻内存，经本地Unix域套接字同时服务多个客户端。
+ * 单线程非阻塞epoll事件循环；每个连接一行一条请求，命令和应答格式与
+ * 批处理模式相同（见command.h），同一连接上的请求按顺序应答，可以连续发送。
+ *
+ * 登录状态按连接保存：同一用户的多个连接共用一个会话（用户记录和订单缓存），
+ * 最后一个连接退出登录或断开时写入订单并释放会话。
+ */
+#ifndef __SERVER_H__
+#define __SERVER_H__
+
+#define SERVER_SOCKET "data/flight.sock"  ///< 默认套接字路径
+#define SERVER_MAX_EVENTS 256             ///< 每次epoll_wait最多处理的事件数
+#define SERVER_OUTPUT_LIMIT (256 * 1024)  ///< 连接待发送数据超过该值时暂停读取请求
+#define SERVER_SESSION_BUCKETS 1024       ///< 会话哈希表桶数
+
+// 服务器函数声明
+int run_server(const char* path); ///< 运行服务器直到收到SIGINT/SIGTERM
+
+#endif // __SERVER_H__
@@ -7,6 +7,8 @@
 #ifndef USER_H
 #define USER_H
 
+#include "seatmap.h"
+
 /**
  * @brief 用户功能主菜单
  * @return 操作状态码(SUCCESS/FAILURE)
@@ -15,11 +17,19 @@ int user_function();
 
 // 用户操作函数
 int buy_ticket();               ///< 购买机票
+int buy_connection(const char* s, const char* e); ///< 查询并购买中转方案
 void view_my_orders();          ///< 查看用户订单
 int refund_ticket();            ///< 退票操作
 int view_balance();             ///< 查看余额
 int recharge_balance();         ///< 充值余额
-int update_user_balance(double); ///< 更新用户余额
+int update_user_balance(Money); ///< 更新用户余额
 int modify_personal_info();     ///< 修改个人信息
 
+// 不交互的用户操作（供菜单和批处理命令共用）
+struct itinerary; // 中转方案（定义见graph.h）
+int purchase_flight(const FlightNode* flight, int count, SeatPref pref, int* seats); ///< 扣款并购买一个航班的一张或多张票
+int purchase_itinerary(const struct itinerary* it, int* seats); ///< 扣款并购买中转方案的全部航段
+int refund_order(const char* number);                ///< 退订一个航班的订单
+int recharge(Money amount);                          ///< 充值
+
 #endif // USER_H
\ No newline at end of file
@@ -0,0 +1,24 @@
+/**
+ * @file userstore.h
+ * @brief 用户存储接口
+ *
+ * 用户记录定长存放在用户数据文件中，另有持久化的用户名哈希索引文件
+ * （用户名→记录号，映射到内存），登录、注册和修改用户信息均为O(1)。
+ * 索引与数据文件记录数不一致时（首次运行、异常退出）自动重建。
+ * 数据文件格式见record.h（USR3文件头+UserDisk记录），旧版文件打开时自动转换。
+ */
+#ifndef __USERSTORE_H__
+#define __USERSTORE_H__
+
+#include "flight.h"
+
+#define USERINDEX_MAGIC "UIX2" ///< 用户索引文件标识
+
+// 用户存储函数声明
+int userstore_find(const char* username, User* out); ///< 按用户名读取用户记录
+int userstore_add(const User* u);                    ///< 追加新用户
+int userstore_update(const User* u);                 ///< 按用户名原地更新用户记录
+int userstore_migrate_all();                         ///< 打开用户存储并完成数据文件格式转换
+void userstore_close();                              ///< 关闭用户存储
+
+#endif // __USERSTORE_H__
@@ -1,6 +1,9 @@
 #include "../include/head.h"
 #include "../include/admin.h"
 
+#define REPORT_TOP_K 5 ///< 航班报表列出的最低票价航班数
+#define STATS_BATCH 1024 ///< 统计票价时每批汇总的航班数
+
 /**
  * @brief 分页显示航班信息
  * @param list 航班链表头节点指针
@@ -36,20 +39,23 @@ void paginated_display(FlightNode *list)
             ;
 
         // 打印表头
-        printf("航班号     航空公司      出发时间    到达时间    出发机场    到达机场    航班状态      机票价格\n");
+        printf("航班号     航空公司      出发时间    到达时间    出发机场    到达机场    航班状态      机票价格      余座/座位\n");
 
         // 打印当前页的数据
+        char price[MONEY_TEXT_MAX];
         while (p && count < PAGE_SIZE)
         {
-            printf("%-11s%-19s%-12s%-12s%-14s%-14s%-15s%-.2f\n",
+            printf("%-11s%-19s%-12s%-12s%-14s%-14s%-15s%-14s%d/%d\n",
                    p->flight.number,
-                   p->flight.airline,
+                   dict_name(DICT_AIRLINE, p->flight.airline),
                    p->flight.departure_time,
                    p->flight.arrival_time,
-                   p->flight.departure_airport,
-                   p->flight.arrival_airport,
-                   p->flight.status,
-                   p->flight.price);
+                   dict_name(DICT_AIRPORT, p->flight.departure_airport),
+                   dict_name(DICT_AIRPORT, p->flight.arrival_airport),
+                   status_name(p->flight.status),
+                   money_format(p->flight.price, price),
+                   seats_available(&p->flight),
+                   p->flight.capacity);
             p = p->next;
             count++;
         }
@@ -89,6 +95,8 @@ void paginated_display(FlightNode *list)
 void see_flight_info()
 {
     system("clear");
+    if (list_ensure() != SUCCESS) // 航班数据只映射未建立链表时先建立
+        return;
     while (1)
     {
         // 检查航班链表是否为空
@@ -113,6 +121,117 @@ void see_flight_info()
     return;
 }
 
+/**
+ * @brief 添加航班（不交互）
+ *
+ * 时间须为HH:MM格式，状态须为准点/延误/取消，价格最多两位小数。
+ *
+ * @param text 航班信息："航班号 航空公司 出发时间 到达时间 出发机场 到达机场 航班状态 机票价格 [座位数] [每排座位数]"
+ * @return int 成功返回SUCCESS，格式错误返回ERR_INVALID_INPUT，
+ *             航班号已存在返回ERR_EXISTS，失败返回FAILURE
+ */
+int add_flight(const char *text)
+{
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
+
+    // 解析输入
+    Flight_n flight;
+    memset(&flight, 0, sizeof(Flight_n));
+    short dep, arr;
+    char airline[DICT_NAME_MAX], dep_time[10], arr_time[10], dep_port[10], arr_port[10], status_text[10];
+    char price_text[MONEY_TEXT_MAX];
+    FlightStatus status;
+    int per_row = SEAT_DEFAULT_PER_ROW;
+    int fields = sscanf(text, "%9s %19s %9s %9s %9s %9s %9s %31s %d %d",
+                        flight.number,
+                        airline,
+                        dep_time,
+                        arr_time,
+                        dep_port,
+                        arr_port,
+                        status_text,
+                        price_text,
+                        &flight.capacity,
+                        &per_row);
+    if (fields == 8)
+        flight.capacity = FLIGHT_DEFAULT_CAPACITY; // 未指定座位数
+    if (fields < 8 || flight.capacity < 1 || flight.capacity > FLIGHT_CAPACITY_MAX ||
+        per_row < 1 || per_row > SEAT_ROW_MAX ||
+        money_parse(price_text, &flight.price) != SUCCESS ||
+        parse_time(dep_time, &dep) != SUCCESS ||
+        parse_time(arr_time, &arr) != SUCCESS ||
+        status_parse(status_text, &status) != SUCCESS ||
+        (flight.airline = dict_intern(DICT_AIRLINE, airline)) == DICT_NONE ||
+        (flight.departure_airport = dict_intern(DICT_AIRPORT, dep_port)) == DICT_NONE ||
+        (flight.arrival_airport = dict_intern(DICT_AIRPORT, arr_port)) == DICT_NONE)
+        return ERR_INVALID_INPUT;
+    strcpy(flight.departure_time, dep_time);
+    strcpy(flight.arrival_time, arr_time);
+    flight.status = status;
+    flight.seats_per_row = (unsigned char)per_row;
+
+    // 将新航班添加到链表尾部（航班号已存在时返回ERR_EXISTS）并记录到修改日志
+    catalog_lock_exclusive();
+    int ret = tail_insert_times(List, &flight, dep, arr);
+    if (ret == SUCCESS && update_flight_info(JOURNAL_PUT, flight.number) != SUCCESS)
+        ret = FAILURE;
+    catalog_unlock();
+    return ret;
+}
+
+/**
+ * @brief 删除航班（不交互）
+ *
+ * @param number 航班号
+ * @return int 成功返回SUCCESS，航班不存在返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+int remove_flight(const char *number)
+{
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
+    char n[10];
+    snprintf(n, sizeof(n), "%s", number);
+    int ret = SUCCESS;
+    catalog_lock_exclusive();
+    if (get_pos(List, n) == NULL)
+        ret = ERR_NOT_FOUND;
+    else if (delete_flight(List, n) || update_flight_info(JOURNAL_DELETE, n))
+        ret = FAILURE;
+    catalog_unlock();
+    return ret;
+}
+
+/**
+ * @brief 修改航班的一个字段（不交互）
+ *
+ * @param number 航班号
+ * @param field 字段（'1'航空公司 '2'出发时间 '3'到达时间 '4'出发机场 '5'到达机场 '6'航班状态 '7'机票价格
+ *              '8'座位数 '9'每排座位数）
+ * @param value 新值
+ * @return int 成功返回SUCCESS，航班不存在返回ERR_NOT_FOUND，新值无效返回ERR_INVALID_INPUT，失败返回FAILURE
+ */
+int modify_flight(const char *number, char field, const char *value)
+{
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
+    if (field < '1' || field > '9')
+        return ERR_INVALID_INPUT;
+    char n[10], message[20];
+    snprintf(n, sizeof(n), "%s", number);
+    snprintf(message, sizeof(message), "%s", value);
+    int ret;
+    catalog_lock_exclusive();
+    if (get_pos(List, n) == NULL)
+        ret = ERR_NOT_FOUND;
+    else if ((ret = change_node(List, n, field, message)) != SUCCESS)
+        ret = ret == ERR_INVALID_INPUT ? ERR_INVALID_INPUT : FAILURE;
+    else if (update_flight_info(JOURNAL_PUT, n))
+        ret = FAILURE;
+    catalog_unlock();
+    return ret;
+}
+
 /**
  * @brief 添加航班信息
  * @return 操作结果（成功/失败）
@@ -123,9 +242,12 @@ void see_flight_info()
 int set_flight_info()
 {
     system("clear");
-    printf("请按以下顺序输入：\n航班号 航空公司 出发时间 到达时间 出发机场 到达机场 航班状态 机票价格\n");
-    Flight_n *new_f_info = NULL; // 新航班信息指针
-    char buffer[100];            // 输入缓冲区
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
+    printf("请按以下顺序输入（座位数和每排座位数可省略，默认%d和%d）：\n"
+           "航班号 航空公司 出发时间 到达时间 出发机场 到达机场 航班状态 机票价格 座位数 每排座位数\n",
+           FLIGHT_DEFAULT_CAPACITY, SEAT_DEFAULT_PER_ROW);
+    char buffer[100]; // 输入缓冲区
 
     // 获取用户输入
     if (!fgets(buffer, sizeof(buffer), stdin))
@@ -134,92 +256,34 @@ int set_flight_info()
         return FAILURE;
     }
 
-    // 分配内存并解析输入
-    new_f_info = (Flight_n *)malloc(sizeof(Flight_n));
-    if (sscanf(buffer, "%s %s %s %s %s %s %s %lf",
-               new_f_info->number,
-               new_f_info->airline,
-               new_f_info->departure_time,
-               new_f_info->arrival_time,
-               new_f_info->departure_airport,
-               new_f_info->arrival_airport,
-               new_f_info->status,
-               &new_f_info->price) != 8)
+    int ret = add_flight(buffer);
+    if (ret == FAILURE)
     {
-        free(new_f_info);
-        printf("输入格式错误\n");
-        printf("请选择：\n>1.返回\t   >2.重新添加\n");
-        char n = getchar();
-        while (getchar() != '\n')
-            ;
-        switch (n)
-        {
-        case '1':
-            system("clear");
-            break;
-        case '2':
-            system("clear");
-            set_flight_info(); // 递归调用重新添加
-            break;
-        }
-        return ERR_INVALID_INPUT;
-    }
-
-    // 检查航班号是否已存在
-    if (get_pos(List, new_f_info->number) != NULL)
-    {
-        printf("航班号已存在！\n");
-        free(new_f_info);
-        printf("请选择：\n>1.返回\t  >2.继续添加\n");
-        char n = getchar();
-        while (getchar() != '\n')
-            ;
-        switch (n)
-        {
-        case '1':
-            break;
-        case '2':
-            system("clear");
-            set_flight_info(); // 递归调用重新添加
-            break;
-        }
-        return ERR_EXISTS;
+        printf("添加失败\n");
+        return FAILURE;
     }
+    if (ret == ERR_INVALID_INPUT)
+        printf("输入格式错误\n请选择：\n>1.返回\t   >2.重新添加\n");
+    else if (ret == ERR_EXISTS)
+        printf("航班号已存在！\n请选择：\n>1.返回\t  >2.继续添加\n");
+    else
+        printf("添加成功！\n请选择：\n>1.返回\t  >2.继续添加\n");
 
-    // 将新航班添加到链表尾部
-    if (0 == tail_insert(List, new_f_info))
+    char n = getchar();
+    while (getchar() != '\n')
+        ;
+    switch (n)
     {
-        // 更新航班信息文件
-        if (update_flight_info())
-        {
-            printf("更新航班信息到文件失败\n");
-            return FAILURE;
-        };
-
-        printf("添加成功！\n");
-        free(new_f_info); // 释放内存
-
-        printf("请选择：\n>1.返回\t  >2.继续添加\n");
-        char n = getchar();
-        while (getchar() != '\n')
-            ;
-        switch (n)
-        {
-        case '1':
-            break;
-        case '2':
+    case '1':
+        if (ret == ERR_INVALID_INPUT)
             system("clear");
-            set_flight_info(); // 递归调用继续添加
-            break;
-        }
-        return SUCCESS;
-    }
-    else
-    {
-        printf("添加失败\n");
-        free(new_f_info); // 释放内存避免泄漏
-        return FAILURE;
+        break;
+    case '2':
+        system("clear");
+        set_flight_info(); // 递归调用继续添加
+        break;
     }
+    return ret;
 }
 
 /**
@@ -232,25 +296,25 @@ int set_flight_info()
 int del_flight_info()
 {
     system("clear");
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
     char n[10]; // 航班号缓冲区
     printf("请输入要删除的航班的航班号：\n");
-    scanf("%s", n);
+    scanf("%9s", n);
     while ((getchar()) != '\n')
         ; // 清空输入缓冲区
 
     // 检查航班是否存在并删除
-    if (get_pos(List, n) == NULL || delete_flight(List, n))
+    int ret = remove_flight(n);
+    if (ret == ERR_NOT_FOUND)
         printf("删除失败！\n");
-    else
+    else if (ret != SUCCESS)
     {
-        // 更新航班信息文件
-        if (update_flight_info())
-        {
-            printf("更新航班信息到文件失败\n");
-            return FAILURE;
-        };
-        printf("删除成功！\n");
+        printf("更新航班信息到文件失败\n");
+        return FAILURE;
     }
+    else
+        printf("删除成功！\n");
 
     // 提供继续操作选项
     printf("请选择：\n>1.返回\t  >2.继续删除\n");
@@ -280,12 +344,14 @@ int del_flight_info()
 int change_flight_info()
 {
     system("clear");
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
     char n[10];       // 航班号缓冲区
     char m;           // 菜单选项
     char message[20]; // 新值缓冲区
     paginated_display(List);
     printf(" 请输入要改变的航班号： ");
-    scanf("%s", n);
+    scanf("%9s", n);
     while (getchar() != '\n')
         ; // 清空输入缓冲区
 
@@ -298,7 +364,8 @@ int change_flight_info()
     printf(">1.航空公司      >2.出发时间\n"
            ">3.到达时间      >4.出发机场\n"
            ">5.到达机场      >6.航班状态\n"
-           ">7.机票价格\n");
+           ">7.机票价格      >8.座位数\n"
+           ">9.每排座位数\n");
     printf(" 请输入要修改的选项： ");
 
     m = getchar();
@@ -306,7 +373,7 @@ int change_flight_info()
         ; // 清空输入缓冲区
 
     // 验证菜单选项有效性
-    while (m != '1' && m != '2' && m != '3' && m != '4' && m != '5' && m != '6' && m != '7')
+    while (m < '1' || m > '9')
     {
         printf(" 没有此选项，请重新输入： ");
         m = getchar();
@@ -319,19 +386,12 @@ int change_flight_info()
     while (getchar() != '\n')
         ; // 清空输入缓冲区
 
-    // 执行修改操作
-    if (SUCCESS != change_node(List, n, m, message))
+    // 执行修改操作并记录到修改日志
+    if (SUCCESS != modify_flight(n, m, message))
     {
         printf("修改失败！\n");
         return FAILURE;
     }
-
-    // 更新航班信息文件
-    if (update_flight_info())
-    {
-        printf("更新航班信息到文件失败\n");
-        return FAILURE;
-    };
     printf("修改成功！\n");
 
     return SUCCESS;
@@ -412,40 +472,104 @@ int administrators()
 
 /**
  * @brief 更新航班信息到文件
+ * @param op 操作（JOURNAL_PUT：新增或修改，JOURNAL_DELETE：删除）
+ * @param number 航班号
  * @return 操作结果（成功/失败）
  *
- * 该函数将航班链表中的数据写入文件保存。
+ * 该函数把一次航班修改追加到修改日志，不再重写整个航班数据文件；
+ * 日志累积到一定条数时自动做检查点。
  */
-int update_flight_info()
+int update_flight_info(int op, const char *number)
 {
-    // 打开航班信息文件
-    FILE *fp = fopen("data/flights.txt", "w");
-    if (fp == NULL)
-    {
-        perror("fopen");
+    // 航班数据已提交，基于目录的查询缓存一并失效
+    catalog_touch();
+    if (journal_flight(op, number) != SUCCESS)
         return FAILURE;
-    }
+    return SUCCESS;
+}
 
-    // 检查链表是否为空
-    if (isnempty(List) != SUCCESS)
-        return isnempty(List);
+/**
+ * @struct stats_scan
+ * @brief 统计航班时的累计状态：票价按批收集为连续数组后汇总
+ */
+typedef struct stats_scan
+{
+    FlightStats *stats;        ///< 统计结果
+    Money prices[STATS_BATCH]; ///< 本批票价
+    int n;                     ///< 本批航班数
+    Money total_price;         ///< 已汇总的票价总额
+} StatsScan;
 
-    // 遍历链表并写入文件
-    FlightNode *p = List->next;
-    if (fwrite(&p->flight, sizeof(Flight_n), 1, fp) != 1)
+/**
+ * @brief 汇总一批票价（可向量化的汇总函数）
+ *
+ * @param c 累计状态
+ */
+static void stats_flush(StatsScan *c)
+{
+    if (c->n == 0)
+        return;
+    Money lo, hi;
+    money_minmax(c->prices, c->n, &lo, &hi);
+    if (c->stats->total == c->n) // 第一批
     {
-        perror("fwrite");
-        fclose(fp);
-        return FAILURE;
+        c->stats->min_price = lo;
+        c->stats->max_price = hi;
     }
-
-    p = p->next;
-    while (p != NULL && fwrite(&p->flight, sizeof(Flight_n), 1, fp))
+    else
     {
-        p = p->next;
+        c->stats->min_price = lo < c->stats->min_price ? lo : c->stats->min_price;
+        c->stats->max_price = hi > c->stats->max_price ? hi : c->stats->max_price;
     }
+    c->total_price += money_sum(c->prices, c->n);
+    c->n = 0;
+}
 
-    fclose(fp);
+/**
+ * @brief 遍历回调：统计一个航班的状态、座位并收集票价
+ *
+ * @param node 航班
+ * @param arg StatsScan
+ * @return int SUCCESS
+ */
+static int stats_visit(const FlightNode *node, void *arg)
+{
+    StatsScan *c = (StatsScan *)arg;
+    const Flight_n *f = &node->flight;
+    c->prices[c->n++] = f->price;
+    c->stats->total++;
+    c->stats->status_count[f->status < STATUS_KINDS ? f->status : STATUS_UNKNOWN]++;
+    c->stats->seats += f->capacity;
+    c->stats->seats_sold += __atomic_load_n(&f->sold, __ATOMIC_RELAXED);
+    if (seats_available(f) == 0)
+        c->stats->sold_out++;
+    if (c->n == STATS_BATCH)
+        stats_flush(c);
+    return SUCCESS;
+}
+
+/**
+ * @brief 统计航班状态分布和票价
+ *
+ * 票价按批收集后汇总，内存占用与航班数无关。
+ *
+ * @param stats 输出：统计结果
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+int flight_stats(FlightStats *stats)
+{
+    memset(stats, 0, sizeof(FlightStats));
+    StatsScan c;
+    c.stats = stats;
+    c.n = 0;
+    c.total_price = 0;
+    if (flights_scan(stats_visit, &c) != SUCCESS)
+        return FAILURE;
+    stats_flush(&c);
+
+    // 平均票价四舍五入到分
+    if (stats->total)
+        stats->avg_price = (c.total_price + stats->total / 2) / stats->total;
     return SUCCESS;
 }
 
@@ -461,25 +585,13 @@ int flight_report()
     system("clear");
     printf("============ 航班报表 ============\n");
 
-    // 航班统计变量
-    int total_flights = 0;     // 总航班数
-    int active_flights = 0;    // 正常航班数
-    int delayed_flights = 0;   // 延误航班数
-    int cancelled_flights = 0; // 取消航班数
-
-    // 遍历航班链表进行统计
-    FlightNode *p = List->next;
-    while (p)
-    {
-        total_flights++;
-        if (strcmp(p->flight.status, "准点") == 0)
-            active_flights++;
-        else if (strcmp(p->flight.status, "延误") == 0)
-            delayed_flights++;
-        else if (strcmp(p->flight.status, "取消") == 0)
-            cancelled_flights++;
-        p = p->next;
-    }
+    FlightStats stats;
+    if (flight_stats(&stats) != SUCCESS)
+        return FAILURE;
+    int total_flights = stats.total;                              // 总航班数
+    int active_flights = stats.status_count[STATUS_ON_TIME];      // 正常航班数
+    int delayed_flights = stats.status_count[STATUS_DELAYED];     // 延误航班数
+    int cancelled_flights = stats.status_count[STATUS_CANCELLED]; // 取消航班数
 
     // 显示航班统计信息
     printf("\n航班统计:\n");
@@ -488,27 +600,41 @@ int flight_report()
     printf("延误航班: %d (%.1f%%)\n", delayed_flights, total_flights ? (float)delayed_flights / total_flights * 100 : 0);
     printf("取消航班: %d (%.1f%%)\n", cancelled_flights, total_flights ? (float)cancelled_flights / total_flights * 100 : 0);
 
-    // 价格分析
-    double min_price = 99999, max_price = 0, avg_price = 0;
-    p = List->next;
-    while (p)
+    // 显示价格分析
+    char min_text[MONEY_TEXT_MAX], max_text[MONEY_TEXT_MAX], avg_text[MONEY_TEXT_MAX], price[MONEY_TEXT_MAX];
+    money_format(stats.min_price, min_text);
+    money_format(stats.max_price, max_text);
+    money_format(stats.avg_price, avg_text);
+    printf("\n价格分析:\n");
+    printf("最低票价: ¥%s\n", min_text);
+    printf("最高票价: ¥%s\n", max_text);
+    printf("平均票价: ¥%s\n", avg_text);
+
+    // 显示座位库存
+    double load_factor = stats.seats ? (double)stats.seats_sold / stats.seats * 100 : 0;
+    printf("\n座位库存:\n");
+    printf("总座位数: %ld\n", stats.seats);
+    printf("已售座位: %ld (客座率 %.1f%%)\n", stats.seats_sold, load_factor);
+    printf("售完航班: %d\n", stats.sold_out);
+
+    // 全部航线中票价最低的航班（有界堆筛选，不排序全部航班）
+    FlightView cheapest;
+    search_cheapest(NULL, NULL, REPORT_TOP_K, &cheapest);
+    printf("\n最低票价航班（前%d）:\n", REPORT_TOP_K);
+    for (int i = 0; i < cheapest.count; i++)
     {
-        if (p->flight.price < min_price)
-            min_price = p->flight.price;
-        if (p->flight.price > max_price)
-            max_price = p->flight.price;
-        avg_price += p->flight.price;
-        p = p->next;
+        const Flight_n *f = &cheapest.items[i]->flight;
+        printf("%-11s%-14s→ %-14s¥%s\n", f->number, dict_name(DICT_AIRPORT, f->departure_airport),
+               dict_name(DICT_AIRPORT, f->arrival_airport), money_format(f->price, price));
     }
 
-    if (total_flights)
-        avg_price /= total_flights;
-
-    // 显示价格分析
-    printf("\n价格分析:\n");
-    printf("最低票价: ¥%.2f\n", min_price);
-    printf("最高票价: ¥%.2f\n", max_price);
-    printf("平均票价: ¥%.2f\n", avg_price);
+    // 航线搜索缓存命中情况（用于调整缓存大小）
+    unsigned long hits, misses;
+    route_cache_stats(&hits, &misses);
+    printf("\n航线查询缓存: 命中 %lu 次, 未命中 %lu 次", hits, misses);
+    if (hits + misses)
+        printf(" (命中率 %.1f%%)", (double)hits / (hits + misses) * 100);
+    printf("\n");
 
     // 生成报表文件名（含日期）
     time_t now = time(NULL);
@@ -527,9 +653,19 @@ int flight_report()
         fprintf(report_fp, "正常航班: %d\n", active_flights);
         fprintf(report_fp, "延误航班: %d\n", delayed_flights);
         fprintf(report_fp, "取消航班: %d\n", cancelled_flights);
-        fprintf(report_fp, "\n最低票价: %.2f\n", min_price);
-        fprintf(report_fp, "最高票价: %.2f\n", max_price);
-        fprintf(report_fp, "平均票价: %.2f\n", avg_price);
+        fprintf(report_fp, "\n最低票价: %s\n", min_text);
+        fprintf(report_fp, "最高票价: %s\n", max_text);
+        fprintf(report_fp, "平均票价: %s\n", avg_text);
+        fprintf(report_fp, "\n总座位数: %ld\n", stats.seats);
+        fprintf(report_fp, "已售座位: %ld (客座率 %.1f%%)\n", stats.seats_sold, load_factor);
+        fprintf(report_fp, "售完航班: %d\n", stats.sold_out);
+        fprintf(report_fp, "\n最低票价航班（前%d）:\n", REPORT_TOP_K);
+        for (int i = 0; i < cheapest.count; i++)
+        {
+            const Flight_n *f = &cheapest.items[i]->flight;
+            fprintf(report_fp, "%s %s-%s %s\n", f->number, dict_name(DICT_AIRPORT, f->departure_airport),
+                    dict_name(DICT_AIRPORT, f->arrival_airport), money_format(f->price, price));
+        }
         fclose(report_fp);
         printf("\n报表已保存至: %s\n", report_filename);
     }
@@ -537,6 +673,7 @@ int flight_report()
     {
         perror("保存报表失败");
     }
+    free_view(&cheapest);
 
     // 等待用户按键返回
     printf("\n按任意键返回...");
@@ -547,6 +684,76 @@ int flight_report()
     return SUCCESS;
 }
 
+/**
+ * @brief 逐个用户统计订单
+ *
+ * 遍历订单目录，折叠每个用户订单文件中的购票/退票记录。
+ *
+ * @param visit 每个用户的回调（可为NULL）：用户名、订单数、消费金额、ctx
+ * @param ctx 传给回调的参数
+ * @param total_orders 输出：总订单数
+ * @param total_revenue 输出：总收入（分）
+ * @return int 成功返回SUCCESS，订单目录无法打开返回FAILURE
+ */
+int order_stats(OrderVisit visit, void *ctx, int *total_orders, Money *total_revenue)
+{
+    *total_orders = 0;
+    *total_revenue = 0;
+
+    // 创建必要的目录
+    system("mkdir -p data/order");
+
+    DIR *dir = opendir("data/order");
+    if (dir == NULL)
+    {
+        perror("无法打开订单目录");
+        return FAILURE;
+    }
+
+    // 遍历目录中的文件
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_type != DT_REG) // 只处理普通文件
+            continue;
+        char filename[256];
+        snprintf(filename, sizeof(filename), "data/order/%s", entry->d_name);
+
+        // 只统计订单文件（跳过压缩时的临时文件）
+        size_t len = strlen(entry->d_name);
+        if (len < 5 || len - 4 >= U || strcmp(entry->d_name + len - 4, ".txt"))
+            continue;
+
+        int user_orders = 0;    // 用户订单数
+        Money user_revenue = 0; // 用户消费金额（分）
+        if (read_order_summary(filename, &user_orders, &user_revenue) != SUCCESS)
+            continue;
+
+        // 从文件名提取用户名（移除.txt后缀）
+        char username[U];
+        memcpy(username, entry->d_name, len - 4);
+        username[len - 4] = '\0';
+
+        // 累加到总计
+        *total_orders += user_orders;
+        *total_revenue += user_revenue;
+        if (visit)
+            visit(username, user_orders, user_revenue, ctx);
+    }
+    closedir(dir);
+    return SUCCESS;
+}
+
+/**
+ * @brief 在终端显示一个用户的订单统计（order_stats回调）
+ */
+static void print_order_row(const char *username, int orders, Money spent, void *ctx)
+{
+    (void)ctx;
+    char revenue[MONEY_TEXT_MAX];
+    printf("%-15s %-10d ¥%-8s\n", username, orders, money_format(spent, revenue));
+}
+
 /**
  * @brief 生成订单报表
  * @return 操作结果（成功/失败）
@@ -559,64 +766,20 @@ int order_report()
     system("clear");
     printf("============ 订单报表 ============\n");
 
-    // 创建必要的目录
-    system("mkdir -p data/order");
+    // 创建报表目录
     system("mkdir -p data/reports");
 
-    DIR *dir;                   // 目录指针
-    struct dirent *entry;       // 目录条目
     int total_orders = 0;       // 总订单数
-    double total_revenue = 0.0; // 总收入
+    Money total_revenue = 0;    // 总收入（分）
+    char revenue[MONEY_TEXT_MAX];
 
-    // 打开订单目录
-    if ((dir = opendir("data/order")) != NULL)
+    printf("\n%-15s %-10s %-8s\n", "用户名", "订单数", "总消费");
+    printf("--------------------------------\n");
+    if (order_stats(print_order_row, NULL, &total_orders, &total_revenue) == SUCCESS)
     {
-        printf("\n%-15s %-10s %-8s\n", "用户名", "订单数", "总消费");
-        printf("--------------------------------\n");
-
-        // 遍历目录中的文件
-        while ((entry = readdir(dir)) != NULL)
-        {
-            if (entry->d_type == DT_REG)
-            { // 只处理普通文件
-                char filename[256];
-                snprintf(filename, sizeof(filename), "data/order/%s", entry->d_name);
-
-                // 打开用户订单文件
-                FILE *fp = fopen(filename, "r");
-                if (fp)
-                {
-                    // 从文件名提取用户名（移除.txt后缀）
-                    char username[U];
-                    strncpy(username, entry->d_name, strlen(entry->d_name) - 4);
-                    username[strlen(entry->d_name) - 4] = '\0';
-
-                    int user_orders = 0;       // 用户订单数
-                    double user_revenue = 0.0; // 用户消费金额
-                    Flight_n flight;
-
-                    // 读取文件中的航班信息
-                    while (fread(&flight, sizeof(Flight_n), 1, fp) == 1)
-                    {
-                        user_orders++;
-                        user_revenue += flight.price;
-                    }
-
-                    // 累加到总计
-                    total_orders += user_orders;
-                    total_revenue += user_revenue;
-
-                    // 显示用户订单信息
-                    printf("%-15s %-10d ¥%-8.2f\n", username, user_orders, user_revenue);
-                    fclose(fp);
-                }
-            }
-        }
-        closedir(dir);
-
         // 显示总计信息
         printf("--------------------------------\n");
-        printf("%-15s %-10d ¥%-8.2f\n", "总计", total_orders, total_revenue);
+        printf("%-15s %-10d ¥%-8s\n", "总计", total_orders, money_format(total_revenue, revenue));
 
         // 生成报表文件名（含日期）
         time_t now = time(NULL);
@@ -632,7 +795,7 @@ int order_report()
             fprintf(report_fp, "订单报表 - %04d-%02d-%02d\n\n",
                     t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
             fprintf(report_fp, "总订单数: %d\n", total_orders);
-            fprintf(report_fp, "总收入: ¥%.2f\n", total_revenue);
+            fprintf(report_fp, "总收入: ¥%s\n", money_format(total_revenue, revenue));
             fclose(report_fp);
             printf("\n报表已保存至: %s\n", report_filename);
         }
@@ -641,10 +804,6 @@ int order_report()
             perror("保存报表失败");
         }
     }
-    else
-    {
-        perror("无法打开订单目录");
-    }
 
     // 等待用户按键返回
     printf("\n按任意键返回...");
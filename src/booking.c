@@ -0,0 +1,655 @@
+#include "../include/head.h"
+
+static pthread_mutex_t flight_locks[BOOKING_STRIPES]; // 航班分段锁（按航班号哈希）
+static pthread_mutex_t user_locks[BOOKING_STRIPES];   // 用户分段锁（按用户名哈希）
+static pthread_once_t locks_once = PTHREAD_ONCE_INIT; // 分段锁只初始化一次
+
+/**
+ * @brief 计算名称哈希值（FNV-1a）
+ *
+ * @param name 航班号或用户名
+ * @return unsigned int 哈希值
+ */
+static unsigned int hash_name(const char *name)
+{
+    unsigned int h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++)
+    {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief 初始化分段锁
+ */
+static void locks_init()
+{
+    for (int i = 0; i < BOOKING_STRIPES; i++)
+    {
+        pthread_mutex_init(&flight_locks[i], NULL);
+        pthread_mutex_init(&user_locks[i], NULL);
+    }
+}
+
+/**
+ * @brief 锁住一组航班（分段号去重后按升序加锁，避免死锁）
+ *
+ * @param numbers 航班号数组
+ * @param n 航班数（不超过BOOKING_TICKETS_MAX）
+ * @param stripes 输出：已加锁的分段号（升序）
+ * @return int 加锁的分段数
+ */
+static int lock_flights(const char *const *numbers, int n, int *stripes)
+{
+    int count = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int stripe = hash_name(numbers[i]) % BOOKING_STRIPES;
+        int j = count;
+        while (j > 0 && stripes[j - 1] > stripe)
+        {
+            stripes[j] = stripes[j - 1];
+            j--;
+        }
+        if (j > 0 && stripes[j - 1] == stripe)
+        {
+            // 已在数组中：撤回移动
+            for (; j < count; j++)
+                stripes[j] = stripes[j + 1];
+            continue;
+        }
+        stripes[j] = stripe;
+        count++;
+    }
+    for (int i = 0; i < count; i++)
+        pthread_mutex_lock(&flight_locks[stripes[i]]);
+    return count;
+}
+
+/**
+ * @brief 解锁lock_flights()锁住的航班
+ *
+ * @param stripes 分段号
+ * @param count 分段数
+ */
+static void unlock_flights(const int *stripes, int count)
+{
+    while (count-- > 0)
+        pthread_mutex_unlock(&flight_locks[stripes[count]]);
+}
+
+/**
+ * @brief 用户分段锁
+ *
+ * @param u 用户
+ * @return pthread_mutex_t* 该用户所在分段的锁
+ */
+static pthread_mutex_t *user_lock(const User *u)
+{
+    return &user_locks[hash_name(u->username) % BOOKING_STRIPES];
+}
+
+/**
+ * @union seat_stock
+ * @brief 座位库存字的两个计数（与Flight_n中sold、held的布局相同）
+ */
+typedef union seat_stock
+{
+    struct
+    {
+        int sold; ///< 已售座位数
+        int held; ///< 暂占的座位数
+    };
+    uint64_t word; ///< 合成的字
+} SeatStock;
+
+/**
+ * @brief 一致地读取航班的已售和暂占座位数（不加锁，可与订票线程并发调用）
+ *
+ * @param f 航班
+ * @param sold 输出：已售座位数
+ * @param held 输出：暂占的座位数
+ */
+void seats_stock(const Flight_n *f, int *sold, int *held)
+{
+    SeatStock stock = {.word = __atomic_load_n(&f->stock, __ATOMIC_ACQUIRE)};
+    *sold = stock.sold;
+    *held = stock.held;
+}
+
+/**
+ * @brief 剩余可售座位数（不加锁，可与订票线程并发调用）
+ *
+ * @param f 航班
+ * @return int 座位数减去已售和暂占的座位数
+ */
+int seats_available(const Flight_n *f)
+{
+    int sold, held;
+    seats_stock(f, &sold, &held);
+    int left = f->capacity - sold - held;
+    return left > 0 ? left : 0;
+}
+
+/**
+ * @brief 以一次比较交换同时修改已售和暂占座位数
+ *
+ * 其间其他线程改动了库存则重新读取后重试。
+ * 暂占时要求修改后sold + held不超过座位数，其余修改要求两个计数都不减到负数。
+ *
+ * @param f 航班
+ * @param sold_delta 已售座位数的变化
+ * @param held_delta 暂占座位数的变化
+ * @return int 成功返回SUCCESS，超过座位数返回ERR_SOLD_OUT，计数不足返回ERR_EMPTY
+ */
+static int seats_change(Flight_n *f, int sold_delta, int held_delta)
+{
+    SeatStock cur = {.word = __atomic_load_n(&f->stock, __ATOMIC_ACQUIRE)}, next;
+    do
+    {
+        next.sold = cur.sold + sold_delta;
+        next.held = cur.held + held_delta;
+        if (next.sold < 0 || next.held < 0)
+            return ERR_EMPTY;
+        if (held_delta > 0 && next.sold + next.held > f->capacity)
+            return ERR_SOLD_OUT;
+    } while (!__atomic_compare_exchange_n(&f->stock, &cur.word, next.word, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    return SUCCESS;
+}
+
+/**
+ * @brief 暂占一个座位
+ *
+ * @param f 航班
+ * @return int 成功返回SUCCESS，座位已售完返回ERR_SOLD_OUT
+ */
+static int seats_hold(Flight_n *f)
+{
+    return seats_change(f, 0, 1);
+}
+
+/**
+ * @brief 释放暂占的座位（订单未提交）
+ *
+ * @param f 航班
+ */
+static void seats_unhold(Flight_n *f)
+{
+    seats_change(f, 0, -1);
+}
+
+/**
+ * @brief 暂占的座位转为已售（订单已提交）
+ *
+ * 两个计数在同一次比较交换中修改，sold + held保持不变。
+ *
+ * @param f 航班
+ */
+static void seats_confirm(Flight_n *f)
+{
+    seats_change(f, 1, -1);
+}
+
+/**
+ * @brief 归还一个已售座位（退票），已售座位数不减到负数
+ *
+ * @param f 航班
+ */
+static void seats_return(Flight_n *f)
+{
+    seats_change(f, -1, 0);
+}
+
+/**
+ * @brief 把航班的座位库存和座位操作写入航班日志
+ *
+ * 订单已经提交，日志写入失败只影响重启后的已售座位数和座位图，不撤回订单。
+ *
+ * @param node 航班
+ * @param seat 座位号（SEAT_NONE为没有座位操作）
+ * @param seat_op 座位操作（JOURNAL_SEAT_TAKE/JOURNAL_SEAT_RELEASE）
+ */
+static void seats_journal(const FlightNode *node, int seat, int seat_op)
+{
+    if (journal_seat(node->flight.number, seat, seat == SEAT_NONE ? 0 : seat_op) != SUCCESS)
+        fprintf(stderr, "航班%s座位库存写入日志失败\n", node->flight.number);
+}
+
+/**
+ * @brief 日志记录数达到阈值时做检查点（调用者不持有任何订票锁）
+ *
+ * 检查点读取全部航班的座位库存和座位图，在航班目录独占锁内执行，
+ * 不与其他线程的座位修改并发；多个线程同时发现时只有第一个做检查点。
+ */
+static void seats_checkpoint()
+{
+    if (!journal_full())
+        return;
+    catalog_lock_exclusive();
+    if (journal_full() && checkpoint_flights() != SUCCESS)
+        fprintf(stderr, "航班数据检查点失败\n");
+    catalog_unlock();
+}
+
+/**
+ * @brief 查找count个同排相邻的空座位，满足偏好的座位块优先
+ *
+ * @param node 航班
+ * @param count 座位数
+ * @param pref 选座偏好
+ * @return int 第一个座位的座位号，没有返回SEAT_NONE
+ */
+static int find_block(const FlightNode *node, int count, SeatPref pref)
+{
+    int seat = seat_find(node, count, pref);
+    if (seat == SEAT_NONE && pref != SEAT_ANY)
+        seat = seat_find(node, count, SEAT_ANY);
+    return seat;
+}
+
+/**
+ * @brief 为每张票分配座位（调用者持有这些航班的锁）
+ *
+ * 先分配指定的座位；其余的票按航班成组分配同排相邻的座位，
+ * 找不到时依次减少成组的票数，先分配最大的相邻座位块。已售座位数是按订单统计的，旧版订单没有座位号，
+ * 空座位总是不少于可售座位；万一没有空座位，该票不分配座位。
+ * 失败时释放本次已分配的座位。
+ *
+ * @param legs 每张票的航班
+ * @param n 票数
+ * @param pref 自动分配的选座偏好
+ * @param seats 输入：指定的座位号或SEAT_NONE；输出：分配的座位号
+ * @return int 成功返回SUCCESS，指定座位已被占用返回ERR_SEAT_TAKEN，
+ *             座位号无效返回ERR_INVALID_INPUT，内存不足返回FAILURE
+ */
+static int assign_seats(FlightNode *const *legs, int n, SeatPref pref, int *seats)
+{
+    int ret = SUCCESS, taken[BOOKING_TICKETS_MAX] = {0};
+    for (int i = 0; i < n && ret == SUCCESS; i++)
+    {
+        if (seats[i] == SEAT_NONE)
+            continue;
+        ret = seat_take(legs[i], seats[i]);
+        if (ret == ERR_EXISTS)
+            ret = ERR_SEAT_TAKEN;
+        taken[i] = ret == SUCCESS;
+    }
+
+    for (int i = 0; i < n && ret == SUCCESS; i++)
+    {
+        if (taken[i])
+            continue;
+        // 同一航班尚未分配的票一起找相邻座位，找不到时减少块中的座位数
+        int count = 0, seat = SEAT_NONE;
+        for (int j = i; j < n; j++)
+            count += legs[j] == legs[i] && !taken[j];
+        while (count > 0 && (seat = find_block(legs[i], count, pref)) == SEAT_NONE)
+            count--;
+        for (int j = i; j < n && count > 0 && ret == SUCCESS; j++)
+        {
+            if (legs[j] != legs[i] || taken[j])
+                continue;
+            if ((ret = seat_take(legs[j], seat)) == SUCCESS)
+            {
+                seats[j] = seat++;
+                taken[j] = 1;
+            }
+            count--;
+        }
+    }
+
+    if (ret != SUCCESS)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            if (taken[i])
+                seat_release(legs[i], seats[i]);
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief 在用户锁内读取最新的用户记录，修改余额后写回
+ *
+ * 以存储中的余额为准（同一用户的其他会话可能已修改），成功后同步到u。
+ * 结算序号原样写回，尚未结算的订单事件仍在下次结算时计入。
+ *
+ * @param u 用户
+ * @param delta 余额变化（分，扣款为负）
+ * @return int 成功返回SUCCESS，余额不足返回ERR_BALANCE，超出范围返回ERR_INVALID_INPUT，失败返回FAILURE
+ */
+static int adjust_balance(User *u, Money delta)
+{
+    User fresh;
+    int ret = userstore_find(u->username, &fresh);
+    if (ret != SUCCESS)
+        return ret == ERR_NOT_FOUND ? ERR_NOT_FOUND : FAILURE;
+    u->balance = fresh.balance;
+    if (delta < 0 && fresh.balance < -delta)
+        return ERR_BALANCE;
+    if (delta > 0 && fresh.balance > MONEY_MAX - delta)
+        return ERR_INVALID_INPUT;
+    fresh.balance += delta;
+    if (userstore_update(&fresh) != SUCCESS)
+        return FAILURE;
+    u->balance = fresh.balance;
+    return SUCCESS;
+}
+
+/**
+ * @brief 在用户锁内读取最新的用户记录，把尚未计入余额的订单事件计入
+ *
+ * 订单事件提交后才写用户记录，两次写入之间崩溃或写用户记录失败时，
+ * 用户记录的order_seq落后于订单文件，在这里补扣购票款、补退退票款。
+ * 成功后会话记下已结算的序号，余额和序号同步到u。
+ *
+ * @param u 用户
+ * @param orders 该用户的订单会话
+ * @param fresh 输出：结算后的用户记录
+ * @return int 成功返回SUCCESS，用户不存在返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+static int settle(User *u, OrderSession *orders, User *fresh)
+{
+    int ret = userstore_find(u->username, fresh);
+    if (ret != SUCCESS)
+        return ret == ERR_NOT_FOUND ? ERR_NOT_FOUND : FAILURE;
+
+    Money delta;
+    uint32_t last;
+    ret = order_session_unsettled(orders, fresh->order_seq, &delta, &last);
+    if (ret == FAILURE)
+        return FAILURE;
+    if (ret == SUCCESS && last != fresh->order_seq)
+    {
+        fresh->balance += delta;
+        fresh->order_seq = last;
+        if (userstore_update(fresh) != SUCCESS)
+            return FAILURE;
+    }
+    order_session_settled(orders, fresh->order_seq);
+    u->balance = fresh->balance;
+    u->order_seq = fresh->order_seq;
+    return SUCCESS;
+}
+
+/**
+ * @brief 订单提交后把余额变化和最后一个事件序号写入用户记录
+ *
+ * 订单文件是提交点：写用户记录失败时只记录错误，下次结算时按订单事件补记。
+ *
+ * @param u 用户
+ * @param orders 该用户的订单会话
+ * @param fresh 结算后的用户记录
+ * @param delta 余额变化（分，扣款为负）
+ */
+static void apply_committed(User *u, OrderSession *orders, User *fresh, Money delta)
+{
+    fresh->balance += delta;
+    fresh->order_seq = order_session_seq(orders);
+    if (userstore_update(fresh) == SUCCESS)
+        order_session_settled(orders, fresh->order_seq);
+    else
+        fprintf(stderr, "用户%s的余额写入失败，下次结算时补记\n", u->username);
+    u->balance = fresh->balance;
+    u->order_seq = fresh->order_seq;
+}
+
+/**
+ * @brief 扣款并购买一组票
+ *
+ * 每张票先暂占一个座位并分配座位号，每张票一条订单（票价即扣款金额），全部订单一次提交，
+ * 提交成功后再扣款；暂占转为已售并写入航班日志。提交之前任何一步失败都撤回订单、座位和暂占。
+ *
+ * @param u 用户
+ * @param orders 该用户的订单会话
+ * @param numbers 每张票的航班号
+ * @param n 票数（1至BOOKING_TICKETS_MAX）
+ * @param pref 自动分配的选座偏好
+ * @param seats 输入：指定的座位号或SEAT_NONE；输出：分配的座位号
+ * @return int 同booking_purchase_seats()
+ */
+static int purchase(User *u, OrderSession *orders, const char *const *numbers, int n, SeatPref pref, int *seats)
+{
+    pthread_once(&locks_once, locks_init);
+
+    catalog_lock_shared();
+    int stripes[BOOKING_TICKETS_MAX];
+    int locked = lock_flights(numbers, n, stripes);
+
+    // 在航班锁内读取票价、暂占座位并分配座位号
+    int ret = SUCCESS, held = 0;
+    Money total = 0;
+    FlightNode *legs[BOOKING_TICKETS_MAX];
+    for (; held < n && ret == SUCCESS; held++)
+    {
+        legs[held] = index_find(numbers[held]);
+        if (legs[held] == NULL)
+            ret = ERR_NOT_FOUND;
+        else if ((ret = seats_hold(&legs[held]->flight)) == SUCCESS)
+            total += legs[held]->flight.price;
+    }
+    if (ret != SUCCESS)
+        held--; // 最后一张票没有暂占成功
+    int assigned = ret == SUCCESS && (ret = assign_seats(legs, n, pref, seats)) == SUCCESS;
+
+    if (ret == SUCCESS)
+    {
+        pthread_mutex_lock(user_lock(u));
+        User fresh;
+        ret = settle(u, orders, &fresh);
+        if (ret == SUCCESS && fresh.balance < total)
+            ret = ERR_BALANCE;
+        if (ret == SUCCESS)
+        {
+            for (int i = 0; i < n && ret == SUCCESS; i++)
+                ret = order_session_book(orders, numbers[i], legs[i]->flight.price, seats[i]);
+            if (ret == SUCCESS)
+                ret = order_session_commit(orders);
+            if (ret == SUCCESS)
+                apply_committed(u, orders, &fresh, -total);
+            else
+            {
+                // 订单未写入：撤回订单，没有扣款
+                order_session_discard(orders);
+                ret = FAILURE;
+            }
+        }
+        pthread_mutex_unlock(user_lock(u));
+    }
+
+    // 提交成功则暂占转为已售，否则释放座位和暂占
+    for (int i = 0; i < held; i++)
+    {
+        if (ret == SUCCESS)
+            seats_confirm(&legs[i]->flight);
+        else
+        {
+            if (assigned)
+                seat_release(legs[i], seats[i]);
+            seats_unhold(&legs[i]->flight);
+        }
+    }
+    for (int i = 0; i < held && ret == SUCCESS; i++)
+        seats_journal(legs[i], seats[i], JOURNAL_SEAT_TAKE);
+
+    unlock_flights(stripes, locked);
+    catalog_unlock();
+    if (ret == SUCCESS)
+        seats_checkpoint();
+    return ret;
+}
+
+/**
+ * @brief 扣款并购买一个或多个航段（中转方案），自动分配座位
+ *
+ * @param u 用户（同一用户的各会话应共用同一个订单会话）
+ * @param orders 该用户的订单会话
+ * @param numbers 航班号数组
+ * @param n 航段数（1至MAX_LEGS）
+ * @param seats 输出：各航段分配的座位号（可为NULL）
+ * @return int 成功返回SUCCESS，航班不存在返回ERR_NOT_FOUND，座位已售完返回ERR_SOLD_OUT，
+ *             余额不足返回ERR_BALANCE，参数无效返回ERR_INVALID_INPUT，失败返回FAILURE
+ */
+int booking_purchase(User *u, OrderSession *orders, const char *const *numbers, int n, int *seats)
+{
+    if (n < 1 || n > MAX_LEGS)
+        return ERR_INVALID_INPUT;
+    int assigned[MAX_LEGS];
+    for (int i = 0; i < n; i++)
+        assigned[i] = SEAT_NONE;
+    int ret = purchase(u, orders, numbers, n, SEAT_ANY, assigned);
+    if (ret == SUCCESS && seats != NULL)
+        memcpy(seats, assigned, n * sizeof(int));
+    return ret;
+}
+
+/**
+ * @brief 扣款并购买同一航班的多张票（同行旅客）
+ *
+ * 未指定座位的票优先分配同排相邻、满足偏好的座位。
+ *
+ * @param u 用户
+ * @param orders 该用户的订单会话
+ * @param number 航班号
+ * @param count 票数（1至BOOKING_TICKETS_MAX）
+ * @param pref 自动分配的选座偏好
+ * @param seats 输入：每张票指定的座位号或SEAT_NONE；输出：分配的座位号
+ * @return int 成功返回SUCCESS，航班不存在返回ERR_NOT_FOUND，座位已售完返回ERR_SOLD_OUT，
+ *             指定座位已被占用返回ERR_SEAT_TAKEN，余额不足返回ERR_BALANCE，
+ *             参数或座位号无效返回ERR_INVALID_INPUT，失败返回FAILURE
+ */
+int booking_purchase_seats(User *u, OrderSession *orders, const char *number, int count, SeatPref pref, int *seats)
+{
+    if (count < 1 || count > BOOKING_TICKETS_MAX)
+        return ERR_INVALID_INPUT;
+    const char *numbers[BOOKING_TICKETS_MAX];
+    for (int i = 0; i < count; i++)
+        numbers[i] = number;
+    return purchase(u, orders, numbers, count, pref, seats);
+}
+
+/**
+ * @brief 退订一个航班的订单
+ *
+ * 退票事件记录退款金额（实付票价），提交后退款到余额；提交失败时撤回退票。
+ * 提交成功后归还一个座位并释放订单的座位号（航班已删除时跳过）。
+ *
+ * @param u 用户
+ * @param orders 该用户的订单会话
+ * @param number 航班号
+ * @return int 成功返回SUCCESS，没有该航班的订单返回ERR_NOT_FOUND，
+ *             退款后余额超出范围返回ERR_INVALID_INPUT，失败返回FAILURE
+ */
+int booking_refund(User *u, OrderSession *orders, const char *number)
+{
+    pthread_once(&locks_once, locks_init);
+
+    catalog_lock_shared();
+    int stripe;
+    lock_flights(&number, 1, &stripe);
+    pthread_mutex_lock(user_lock(u));
+
+    User fresh;
+    Money price;
+    int seat;
+    int ret = settle(u, orders, &fresh);
+    if (ret == SUCCESS)
+        ret = order_session_refund(orders, number, &price, &seat);
+    if (ret == SUCCESS && fresh.balance > MONEY_MAX - price)
+    {
+        order_session_discard(orders);
+        ret = ERR_INVALID_INPUT;
+    }
+    if (ret == SUCCESS && order_session_commit(orders) != SUCCESS)
+    {
+        order_session_discard(orders);
+        ret = FAILURE;
+    }
+    if (ret == SUCCESS)
+        apply_committed(u, orders, &fresh, price);
+    pthread_mutex_unlock(user_lock(u));
+
+    FlightNode *flight = ret == SUCCESS ? index_find(number) : NULL;
+    if (flight != NULL)
+    {
+        seats_return(&flight->flight);
+        seat_release(flight, seat);
+        seats_journal(flight, seat, JOURNAL_SEAT_RELEASE);
+    }
+
+    unlock_flights(&stripe, 1);
+    catalog_unlock();
+    if (ret == SUCCESS)
+        seats_checkpoint();
+    return ret;
+}
+
+/**
+ * @brief 结算用户余额（登录时调用）
+ *
+ * 把订单文件中尚未计入余额的事件计入用户记录，u的余额随之更新。
+ *
+ * @param u 用户
+ * @param orders 该用户的订单会话（已打开）
+ * @return int 成功返回SUCCESS，用户不存在返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+int booking_settle(User *u, OrderSession *orders)
+{
+    pthread_once(&locks_once, locks_init);
+
+    User fresh;
+    pthread_mutex_lock(user_lock(u));
+    int ret = settle(u, orders, &fresh);
+    pthread_mutex_unlock(user_lock(u));
+    return ret;
+}
+
+/**
+ * @brief 修改密码
+ *
+ * 在用户锁内读取最新的用户记录后只修改密码，不覆盖其他会话写入的余额和结算序号。
+ *
+ * @param u 用户（成功后同步密码）
+ * @param password 新密码
+ * @return int 成功返回SUCCESS，用户不存在返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+int booking_set_password(User *u, const char *password)
+{
+    pthread_once(&locks_once, locks_init);
+
+    User fresh;
+    pthread_mutex_lock(user_lock(u));
+    int ret = userstore_find(u->username, &fresh);
+    if (ret == SUCCESS)
+    {
+        memset(fresh.password, 0, sizeof(fresh.password));
+        strncpy(fresh.password, password, P - 1);
+        ret = userstore_update(&fresh);
+    }
+    if (ret == SUCCESS)
+        memcpy(u->password, fresh.password, sizeof(u->password));
+    pthread_mutex_unlock(user_lock(u));
+    return ret;
+}
+
+/**
+ * @brief 充值
+ *
+ * @param u 用户
+ * @param amount 充值金额（分）
+ * @return int 成功返回SUCCESS，金额超出范围返回ERR_INVALID_INPUT，失败返回FAILURE
+ */
+int booking_recharge(User *u, Money amount)
+{
+    if (amount < 0)
+        return ERR_INVALID_INPUT;
+    pthread_once(&locks_once, locks_init);
+
+    pthread_mutex_lock(user_lock(u));
+    int ret = adjust_balance(u, amount);
+    pthread_mutex_unlock(user_lock(u));
+    return ret;
+}
@@ -0,0 +1,270 @@
+#include "../include/head.h"
+
+/**
+ * @struct catalog_chunk
+ * @brief 目录块：连续存放的一组节点及其占用标记
+ */
+typedef struct catalog_chunk
+{
+    FlightNode nodes[CATALOG_CHUNK_SIZE];   ///< 节点数组
+    unsigned char used[CATALOG_CHUNK_SIZE]; ///< 槽位占用标记
+} CatalogChunk;
+
+static CatalogChunk **chunks = NULL; // 块指针数组
+static int chunk_count = 0;          // 已分配块数
+static int chunk_capacity = 0;       // 块指针数组容量
+static int high_water = 0;           // 从未使用过的第一个槽位
+static int live = 0;                 // 有效节点数
+static FlightHandle *free_slots = NULL; // 已归还的槽位栈
+static int free_count = 0;           // 栈中槽位数
+static int free_capacity = 0;        // 栈容量
+static unsigned long generation = 0; // 目录修改计数
+static pthread_rwlock_t catalog_rwlock = PTHREAD_RWLOCK_INITIALIZER; // 订票线程共享，增删改航班独占
+
+/**
+ * @brief 追加一个目录块
+ *
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int add_chunk()
+{
+    if (chunk_count == chunk_capacity)
+    {
+        int new_capacity = chunk_capacity ? chunk_capacity * 2 : 16;
+        CatalogChunk **grown = (CatalogChunk **)realloc(chunks, new_capacity * sizeof(CatalogChunk *));
+        if (grown == NULL)
+        {
+            perror("catalog realloc");
+            return FAILURE;
+        }
+        chunks = grown;
+        chunk_capacity = new_capacity;
+    }
+
+    // 块内存只清占用标记，节点在分配时初始化
+    CatalogChunk *c = (CatalogChunk *)malloc(sizeof(CatalogChunk));
+    if (c == NULL)
+    {
+        perror("catalog chunk malloc");
+        return FAILURE;
+    }
+    memset(c->used, 0, sizeof(c->used));
+    chunks[chunk_count++] = c;
+    return SUCCESS;
+}
+
+/**
+ * @brief 预留至少n个槽位（批量加载前调用，避免逐块扩容）
+ *
+ * @param n 槽位数
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+int catalog_reserve(int n)
+{
+    while (chunk_count * CATALOG_CHUNK_SIZE < n)
+    {
+        if (add_chunk() != SUCCESS)
+            return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 从目录分配节点并复制航班数据
+ *
+ * 优先复用已归还的槽位，否则顺序使用新槽位，使节点在内存中连续排列。
+ *
+ * @param fn 航班数据指针
+ * @return FlightNode* 成功返回节点指针，失败返回NULL
+ */
+FlightNode *catalog_alloc(Flight_n *fn)
+{
+    FlightHandle h;
+    if (free_count > 0)
+    {
+        h = free_slots[--free_count];
+    }
+    else
+    {
+        if (high_water == chunk_count * CATALOG_CHUNK_SIZE && add_chunk() != SUCCESS)
+            return NULL;
+        h = high_water++;
+    }
+
+    CatalogChunk *c = chunks[h / CATALOG_CHUNK_SIZE];
+    FlightNode *node = &c->nodes[h % CATALOG_CHUNK_SIZE];
+    memcpy(&node->flight, fn, sizeof(Flight_n));
+    node->prev = node->next = NULL;
+    node->seats = NULL;
+    node->handle = h;
+    c->used[h % CATALOG_CHUNK_SIZE] = 1;
+    live++;
+    generation++;
+    return node;
+}
+
+/**
+ * @brief 归还节点槽位（节点须已从链表中摘除）
+ *
+ * @param node 目录中的节点
+ */
+void catalog_release(FlightNode *node)
+{
+    if (node == NULL || node->handle == INVALID_HANDLE)
+        return;
+    generation++;
+    seatmap_free(node);
+
+    if (free_count == free_capacity)
+    {
+        int new_capacity = free_capacity ? free_capacity * 2 : 64;
+        FlightHandle *grown = (FlightHandle *)realloc(free_slots, new_capacity * sizeof(FlightHandle));
+        if (grown == NULL)
+        {
+            // 无法记录空闲槽位时只标记未占用，槽位不再复用
+            perror("catalog realloc");
+            chunks[node->handle / CATALOG_CHUNK_SIZE]->used[node->handle % CATALOG_CHUNK_SIZE] = 0;
+            live--;
+            return;
+        }
+        free_slots = grown;
+        free_capacity = new_capacity;
+    }
+
+    chunks[node->handle / CATALOG_CHUNK_SIZE]->used[node->handle % CATALOG_CHUNK_SIZE] = 0;
+    free_slots[free_count++] = node->handle;
+    live--;
+}
+
+/**
+ * @brief 句柄转节点指针
+ *
+ * @param h 航班句柄
+ * @return FlightNode* 有效句柄返回节点指针，否则返回NULL
+ */
+FlightNode *catalog_node(FlightHandle h)
+{
+    if (h < 0 || h >= high_water)
+        return NULL;
+    CatalogChunk *c = chunks[h / CATALOG_CHUNK_SIZE];
+    if (!c->used[h % CATALOG_CHUNK_SIZE])
+        return NULL;
+    return &c->nodes[h % CATALOG_CHUNK_SIZE];
+}
+
+/**
+ * @brief 目录中的航班数
+ *
+ * @return int 有效节点数
+ */
+int catalog_count()
+{
+    return live;
+}
+
+/**
+ * @brief 从指定槽位开始查找有效句柄
+ *
+ * @param h 起始槽位
+ * @return FlightHandle 有效句柄，没有时返回INVALID_HANDLE
+ */
+static FlightHandle seek_used(FlightHandle h)
+{
+    while (h < high_water)
+    {
+        CatalogChunk *c = chunks[h / CATALOG_CHUNK_SIZE];
+        int end = (h / CATALOG_CHUNK_SIZE + 1) * CATALOG_CHUNK_SIZE;
+        if (end > high_water)
+            end = high_water;
+        for (; h < end; h++)
+        {
+            if (c->used[h % CATALOG_CHUNK_SIZE])
+                return h;
+        }
+    }
+    return INVALID_HANDLE;
+}
+
+/**
+ * @brief 第一个有效句柄（按槽位顺序遍历，与链表顺序无关）
+ *
+ * @return FlightHandle 有效句柄，目录为空时返回INVALID_HANDLE
+ */
+FlightHandle catalog_first()
+{
+    return seek_used(0);
+}
+
+/**
+ * @brief 下一个有效句柄
+ *
+ * @param h 当前句柄
+ * @return FlightHandle 有效句柄，遍历结束返回INVALID_HANDLE
+ */
+FlightHandle catalog_next(FlightHandle h)
+{
+    return seek_used(h + 1);
+}
+
+/**
+ * @brief 标记目录内容已修改（原地修改节点后调用）
+ */
+void catalog_touch()
+{
+    generation++;
+}
+
+/**
+ * @brief 目录修改计数
+ *
+ * 分配、归还、清空和catalog_touch()都会递增，可用于判断基于目录的缓存是否过期。
+ *
+ * @return unsigned long 修改计数
+ */
+unsigned long catalog_generation()
+{
+    return generation;
+}
+
+/**
+ * @brief 释放整个目录（目录中的节点全部失效）
+ */
+void catalog_clear()
+{
+    for (FlightHandle h = catalog_first(); h != INVALID_HANDLE; h = catalog_next(h))
+        seatmap_free(catalog_node(h));
+    for (int i = 0; i < chunk_count; i++)
+        free(chunks[i]);
+    free(chunks);
+    free(free_slots);
+    chunks = NULL;
+    free_slots = NULL;
+    chunk_count = chunk_capacity = 0;
+    free_count = free_capacity = 0;
+    high_water = live = 0;
+    generation++;
+}
+
+/**
+ * @brief 以共享方式锁住目录（订票线程读取航班期间航班不被增删改）
+ */
+void catalog_lock_shared()
+{
+    pthread_rwlock_rdlock(&catalog_rwlock);
+}
+
+/**
+ * @brief 以独占方式锁住目录（增删改航班）
+ */
+void catalog_lock_exclusive()
+{
+    pthread_rwlock_wrlock(&catalog_rwlock);
+}
+
+/**
+ * @brief 解锁目录
+ */
+void catalog_unlock()
+{
+    pthread_rwlock_unlock(&catalog_rwlock);
+}
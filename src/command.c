@@ -0,0 +1,546 @@
+#include "../include/head.h"
+
+/**
+ * @enum command_access
+ * @brief 命令的登录要求
+ */
+typedef enum command_access
+{
+    ACCESS_ANY = 0,   ///< 无需登录
+    ACCESS_USER = 1,  ///< 普通用户
+    ACCESS_ADMIN = 2  ///< 管理员
+} CommandAccess;
+
+/// 命令处理函数：参数（argv[0]为命令名）、参数数、原始命令行中参数之后的部分、输出
+typedef int (*CommandFunc)(char **argv, int argc, const char *rest, FILE *out);
+
+/**
+ * @struct command
+ * @brief 命令表项
+ */
+typedef struct command
+{
+    const char *name;     ///< 命令名
+    CommandFunc run;      ///< 处理函数
+    CommandAccess access; ///< 登录要求
+    int min_args;         ///< 最少参数数（不含命令名）
+    const char *usage;    ///< 参数说明
+} Command;
+
+static const char *command_error = NULL; // 处理函数给出的错误说明（NULL时按状态码说明）
+
+/**
+ * @brief 输出一个航班数据行
+ *
+ * @param tag 行类型（flight/order）
+ * @param f 航班信息
+ * @param out 输出
+ */
+static void print_flight_row(const char *tag, const Flight_n *f, FILE *out)
+{
+    char price[MONEY_TEXT_MAX];
+    fprintf(out, "%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%d\t%d", tag, f->number,
+            dict_name(DICT_AIRLINE, f->airline), f->departure_time, f->arrival_time,
+            dict_name(DICT_AIRPORT, f->departure_airport), dict_name(DICT_AIRPORT, f->arrival_airport),
+            status_name(f->status), money_format(f->price, price), seats_available(f), f->capacity);
+    // 订单行最后一列为座位号
+    if (!strcmp(tag, "order"))
+    {
+        char seat[SEAT_LABEL_MAX];
+        fprintf(out, "\t%s", seat_label(f, f->seat, seat));
+    }
+    fputc('\n', out);
+}
+
+/**
+ * @brief 输出当前用户数据行
+ *
+ * @param out 输出
+ */
+static void print_user_row(FILE *out)
+{
+    char balance[MONEY_TEXT_MAX];
+    fprintf(out, "user\t%s\t%s\t%s\n", user->username, user->type == ADMIN ? "admin" : "user",
+            money_format(user->balance, balance));
+}
+
+/**
+ * @brief 输出视图中的航班并释放视图
+ *
+ * @param v 航班视图
+ * @param out 输出
+ * @return int SUCCESS
+ */
+static int print_view(FlightView *v, FILE *out)
+{
+    for (int i = 0; i < v->count; i++)
+        print_flight_row("flight", &v->items[i]->flight, out);
+    free_view(v);
+    return SUCCESS;
+}
+
+/**
+ * @brief register <用户名> <密码>
+ */
+static int cmd_register(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argc; (void)rest; (void)out;
+    if (strlen(argv[1]) >= U || strlen(argv[2]) >= P)
+        return ERR_INVALID_INPUT;
+    int ret = enroll(argv[1], argv[2]);
+    return ret == ERR_NOT_FOUND ? ERR_EXISTS : ret; // enroll()以ERR_NOT_FOUND表示用户名已存在
+}
+
+/**
+ * @brief login <用户名> <密码>（已登录时先退出当前用户）
+ */
+static int cmd_login(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argc; (void)rest;
+    if (strlen(argv[1]) >= U || strlen(argv[2]) >= P)
+        return ERR_INVALID_INPUT;
+    log_off();
+    int ret = log_on(argv[1], argv[2]);
+    if (ret != SUCCESS)
+    {
+        command_error = "用户名或密码错误";
+        return ret;
+    }
+    // 普通用户加载订单到会话缓存，并结算上次未计入余额的订单
+    user->userorders = NULL;
+    if (user->type != ADMIN &&
+        (order_session_open() != SUCCESS || booking_settle(user, order_session_current()) != SUCCESS))
+    {
+        log_off();
+        command_error = "读取订单失败";
+        return FAILURE;
+    }
+    print_user_row(out);
+    return SUCCESS;
+}
+
+/**
+ * @brief logout
+ */
+static int cmd_logout(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argv; (void)argc; (void)rest; (void)out;
+    if (user == NULL)
+    {
+        command_error = "未登录";
+        return FAILURE;
+    }
+    return log_off();
+}
+
+/**
+ * @brief search <出发地> <目的地> [time|price]
+ */
+static int cmd_search(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)rest;
+    CompareFunc compare = NULL;
+    if (argc > 3)
+    {
+        if (!strcmp(argv[3], "time"))
+            compare = compare_by_time_then_price;
+        else if (!strcmp(argv[3], "price"))
+            compare = compare_by_price_then_time;
+        else
+            return ERR_INVALID_INPUT;
+    }
+    FlightView v;
+    if (search_route_sorted(argv[1], argv[2], compare, &v) == FAILURE)
+        return FAILURE;
+    return print_view(&v, out);
+}
+
+/**
+ * @brief cheapest <出发地> <目的地> <航班数>
+ */
+static int cmd_cheapest(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argc; (void)rest;
+    int k = atoi(argv[3]);
+    if (k <= 0)
+        return ERR_INVALID_INPUT;
+    FlightView v;
+    if (search_cheapest(argv[1], argv[2], k, &v) == FAILURE)
+        return FAILURE;
+    return print_view(&v, out);
+}
+
+/**
+ * @brief book <航班号> [座位号|window|aisle|any] [张数]
+ *
+ * 指定座位号时只买一张；其余方式为每张票自动分配座位（同排相邻优先）。
+ */
+static int cmd_book(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)rest;
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
+    char number[10];
+    snprintf(number, sizeof(number), "%s", argv[1]);
+    FlightNode *flight = get_pos(List, number);
+    if (flight == NULL)
+        return ERR_NOT_FOUND;
+
+    SeatPref pref = SEAT_ANY;
+    int count = argc > 3 ? atoi(argv[3]) : 1;
+    int seats[SEAT_GROUP_MAX];
+    if (count < 1 || count > SEAT_GROUP_MAX)
+        return ERR_INVALID_INPUT;
+    for (int i = 0; i < count; i++)
+        seats[i] = SEAT_NONE;
+    if (argc > 2)
+    {
+        if (!strcmp(argv[2], "window"))
+            pref = SEAT_WINDOW;
+        else if (!strcmp(argv[2], "aisle"))
+            pref = SEAT_AISLE;
+        else if (strcmp(argv[2], "any") &&
+                 (count != 1 || seat_parse(&flight->flight, argv[2], &seats[0]) != SUCCESS))
+            return ERR_INVALID_INPUT;
+    }
+
+    int ret = purchase_flight(flight, count, pref, seats);
+    if (ret != SUCCESS)
+        return ret;
+    for (int i = 0; i < count; i++)
+    {
+        char label[SEAT_LABEL_MAX];
+        fprintf(out, "seat\t%s\t%s\n", flight->flight.number, seat_label(&flight->flight, seats[i], label));
+    }
+    print_user_row(out);
+    return SUCCESS;
+}
+
+/**
+ * @brief seats <航班号>（每排一行，空座位为列字母，已分配为x）
+ */
+static int cmd_seats(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argc; (void)rest;
+    FlightNode flight;
+    int ret = flight_snapshot(argv[1], &flight);
+    if (ret != SUCCESS)
+        return ret;
+
+    int per = seat_row_size(&flight.flight), capacity = flight.flight.capacity;
+    fprintf(out, "seatmap\t%s\t%d\t%d\t%d\n", flight.flight.number, capacity, per, seat_taken_count(&flight));
+    for (int row = 0; row * per < capacity; row++)
+    {
+        char text[SEAT_ROW_MAX + 1];
+        int n = 0;
+        for (; n < per && row * per + n < capacity; n++)
+            text[n] = seat_is_taken(&flight, row * per + n) ? 'x' : 'A' + n;
+        text[n] = '\0';
+        fprintf(out, "row\t%d\t%s\n", row + 1, text);
+    }
+    seatmap_free(&flight);
+    return SUCCESS;
+}
+
+/**
+ * @brief refund <航班号>
+ */
+static int cmd_refund(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argc; (void)rest; (void)out;
+    return refund_order(argv[1]);
+}
+
+/**
+ * @brief orders（显示当前航班信息和实付票价）
+ */
+static int cmd_orders(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argv; (void)argc; (void)rest;
+    if (read_from_order() != SUCCESS)
+        return FAILURE;
+    for (FlightNode *p = user->userorders->next; p; p = p->next)
+        print_flight_row("order", &p->flight, out);
+    return SUCCESS;
+}
+
+/**
+ * @brief balance
+ */
+static int cmd_balance(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argv; (void)argc; (void)rest;
+    print_user_row(out);
+    return SUCCESS;
+}
+
+/**
+ * @brief recharge <金额>
+ */
+static int cmd_recharge(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argc; (void)rest;
+    Money amount;
+    if (money_parse(argv[1], &amount) != SUCCESS)
+        return ERR_INVALID_INPUT;
+    int ret = recharge(amount);
+    if (ret == SUCCESS)
+        print_user_row(out);
+    return ret;
+}
+
+/**
+ * @brief add <航班号> <航空公司> <出发时间> <到达时间> <出发机场> <到达机场> <航班状态> <机票价格> [座位数] [每排座位数]
+ */
+static int cmd_add(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argv; (void)argc; (void)out;
+    return add_flight(rest);
+}
+
+/**
+ * @brief change <航班号> <字段> <新值>
+ *
+ * 字段可以是名称（airline/departure/arrival/from/to/status/price/seats/row）或菜单中的编号1-9。
+ */
+static int cmd_change(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argc; (void)rest; (void)out;
+    static const char *fields[] = {"airline", "departure", "arrival", "from", "to", "status", "price", "seats", "row"};
+    char field = 0;
+    if (argv[2][0] >= '1' && argv[2][0] <= '9' && argv[2][1] == '\0')
+        field = argv[2][0];
+    for (int i = 0; i < 9; i++)
+    {
+        if (!strcmp(argv[2], fields[i]))
+            field = '1' + i;
+    }
+    if (field == 0)
+        return ERR_INVALID_INPUT;
+    return modify_flight(argv[1], field, argv[3]);
+}
+
+/**
+ * @brief delete <航班号>
+ */
+static int cmd_delete(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argc; (void)rest; (void)out;
+    return remove_flight(argv[1]);
+}
+
+/**
+ * @brief 输出一个用户的订单统计（order_stats回调）
+ */
+static void print_order_stat(const char *username, int orders, Money spent, void *ctx)
+{
+    char text[MONEY_TEXT_MAX];
+    fprintf((FILE *)ctx, "stat\tuser\t%s\t%d\t%s\n", username, orders, money_format(spent, text));
+}
+
+/**
+ * @brief report flights|orders
+ */
+static int cmd_report(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argc; (void)rest;
+    char text[MONEY_TEXT_MAX];
+    if (!strcmp(argv[1], "flights"))
+    {
+        FlightStats stats;
+        if (flight_stats(&stats) != SUCCESS)
+            return FAILURE;
+        fprintf(out, "stat\ttotal\t%d\n", stats.total);
+        for (int i = 0; i < STATUS_KINDS; i++)
+        {
+            if (i != STATUS_UNKNOWN)
+                fprintf(out, "stat\tstatus\t%s\t%d\n", status_name(i), stats.status_count[i]);
+        }
+        fprintf(out, "stat\tmin_price\t%s\n", money_format(stats.min_price, text));
+        fprintf(out, "stat\tmax_price\t%s\n", money_format(stats.max_price, text));
+        fprintf(out, "stat\tavg_price\t%s\n", money_format(stats.avg_price, text));
+        fprintf(out, "stat\tseats\t%ld\n", stats.seats);
+        fprintf(out, "stat\tseats_sold\t%ld\n", stats.seats_sold);
+        fprintf(out, "stat\tsold_out\t%d\n", stats.sold_out);
+        return SUCCESS;
+    }
+    if (!strcmp(argv[1], "orders"))
+    {
+        int total_orders;
+        Money total_revenue;
+        if (order_stats(print_order_stat, out, &total_orders, &total_revenue) != SUCCESS)
+            return FAILURE;
+        fprintf(out, "stat\ttotal_orders\t%d\n", total_orders);
+        fprintf(out, "stat\ttotal_revenue\t%s\n", money_format(total_revenue, text));
+        return SUCCESS;
+    }
+    return ERR_INVALID_INPUT;
+}
+
+/**
+ * @brief quit（结束批处理）
+ */
+static int cmd_quit(char **argv, int argc, const char *rest, FILE *out)
+{
+    (void)argv; (void)argc; (void)rest; (void)out;
+    return EXIT_SYSTEM;
+}
+
+static const Command commands[] = {
+    {"register", cmd_register, ACCESS_ANY, 2, "<用户名> <密码>"},
+    {"login", cmd_login, ACCESS_ANY, 2, "<用户名> <密码>"},
+    {"logout", cmd_logout, ACCESS_ANY, 0, ""},
+    {"search", cmd_search, ACCESS_ANY, 2, "<出发地> <目的地> [time|price]"},
+    {"cheapest", cmd_cheapest, ACCESS_ANY, 3, "<出发地> <目的地> <航班数>"},
+    {"book", cmd_book, ACCESS_USER, 1, "<航班号> [座位号|window|aisle|any] [张数]"},
+    {"seats", cmd_seats, ACCESS_ANY, 1, "<航班号>"},
+    {"refund", cmd_refund, ACCESS_USER, 1, "<航班号>"},
+    {"orders", cmd_orders, ACCESS_USER, 0, ""},
+    {"balance", cmd_balance, ACCESS_USER, 0, ""},
+    {"recharge", cmd_recharge, ACCESS_USER, 1, "<金额>"},
+    {"add", cmd_add, ACCESS_ADMIN, 8, "<航班号> <航空公司> <出发时间> <到达时间> <出发机场> <到达机场> <航班状态> <机票价格> [座位数] [每排座位数]"},
+    {"change", cmd_change, ACCESS_ADMIN, 3, "<航班号> <字段> <新值>"},
+    {"delete", cmd_delete, ACCESS_ADMIN, 1, "<航班号>"},
+    {"report", cmd_report, ACCESS_ADMIN, 1, "flights|orders"},
+    {"quit", cmd_quit, ACCESS_ANY, 0, ""},
+};
+
+/**
+ * @brief 状态码的默认说明
+ *
+ * @param code 状态码
+ * @return const char* 说明文字
+ */
+static const char *status_message(int code)
+{
+    switch (code)
+    {
+    case ERR_INVALID_INPUT:
+        return "输入格式错误";
+    case ERR_NOT_FOUND:
+        return "未找到";
+    case ERR_EXISTS:
+        return "已存在";
+    case ERR_EMPTY:
+        return "没有数据";
+    case ERR_BALANCE:
+        return "余额不足";
+    case ERR_SOLD_OUT:
+        return "座位已售完";
+    case ERR_SEAT_TAKEN:
+        return "座位已被占用";
+    default:
+        return "操作失败";
+    }
+}
+
+/**
+ * @brief 执行一条命令并输出结果
+ *
+ * @param line 命令行（会被切分修改）
+ * @param out 输出
+ * @return int 命令的状态码；空行和注释返回SUCCESS，quit返回EXIT_SYSTEM
+ */
+int command_execute(char *line, FILE *out)
+{
+    line[strcspn(line, "\r\n")] = '\0';
+    char *p = line + strspn(line, " \t");
+    if (*p == '\0' || *p == '#')
+        return SUCCESS;
+
+    // 切分参数，同时记下第一个参数在原始命令行中的位置（add按整行解析）
+    char *argv[COMMAND_ARGS_MAX + 1];
+    int argc = 0;
+    char rest[COMMAND_LINE_MAX] = "";
+    char *save = NULL;
+    for (char *tok = strtok_r(p, " \t", &save); tok && argc <= COMMAND_ARGS_MAX; tok = strtok_r(NULL, " \t", &save))
+    {
+        if (argc == 0 && save && *save)
+            snprintf(rest, sizeof(rest), "%s", save);
+        argv[argc++] = tok;
+    }
+
+    const Command *cmd = NULL;
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+    {
+        if (!strcmp(argv[0], commands[i].name))
+            cmd = &commands[i];
+    }
+
+    int ret;
+    command_error = NULL;
+    if (cmd == NULL)
+    {
+        ret = ERR_INVALID_INPUT;
+        command_error = "未知命令";
+    }
+    else if (cmd->access != ACCESS_ANY && user == NULL)
+    {
+        ret = FAILURE;
+        command_error = "未登录";
+    }
+    else if (cmd->access == ACCESS_ADMIN && user->type != ADMIN)
+    {
+        ret = FAILURE;
+        command_error = "需要管理员权限";
+    }
+    else if (cmd->access == ACCESS_USER && user->type == ADMIN)
+    {
+        ret = FAILURE;
+        command_error = "管理员不能执行此命令";
+    }
+    else if (argc - 1 < cmd->min_args || argc > COMMAND_ARGS_MAX)
+    {
+        ret = ERR_INVALID_INPUT;
+        command_error = cmd->usage;
+    }
+    else
+    {
+        ret = cmd->run(argv, argc, rest, out);
+    }
+
+    command_reply(out, ret == EXIT_SYSTEM ? SUCCESS : ret, command_error);
+    return ret;
+}
+
+/**
+ * @brief 输出命令的结束行
+ *
+ * @param out 输出
+ * @param code 状态码（SUCCESS输出"ok"）
+ * @param message 错误说明（NULL时按状态码说明）
+ */
+void command_reply(FILE *out, int code, const char *message)
+{
+    if (code == SUCCESS)
+        fprintf(out, "ok\n");
+    else
+        fprintf(out, "error\t%d\t%s\n", code, message ? message : status_message(code));
+    fflush(out);
+}
+
+/**
+ * @brief 批处理：逐行执行命令直到输入结束或quit
+ *
+ * 结束时退出仍在登录的用户（写入未提交的订单），并把航班修改日志合并到数据文件。
+ *
+ * @param in 命令输入
+ * @param out 结果输出
+ * @return int 全部命令成功返回SUCCESS，否则返回FAILURE
+ */
+int run_batch(FILE *in, FILE *out)
+{
+    char line[COMMAND_LINE_MAX];
+    int failed = 0;
+    while (fgets(line, sizeof(line), in))
+    {
+        int ret = command_execute(line, out);
+        if (ret == EXIT_SYSTEM)
+            break;
+        if (ret != SUCCESS)
+            failed++;
+    }
+    if (log_off() != SUCCESS || checkpoint_flights() != SUCCESS)
+        failed++;
+    return failed ? FAILURE : SUCCESS;
+}
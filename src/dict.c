@@ -0,0 +1,297 @@
+#include "../include/head.h"
+
+#define DICT_MIN_CAPACITY 64 ///< 名称哈希表初始槽位数（2的幂）
+
+/**
+ * @struct dictionary
+ * @brief 一种字典：按id存放的名称数组及名称哈希表
+ */
+typedef struct dictionary
+{
+    char (*names)[DICT_NAME_MAX]; ///< 名称数组（下标为id-1）
+    int count;                    ///< 已登记名称数
+    int capacity;                 ///< 名称数组容量
+    DictId *slots;                ///< 名称哈希表（开放寻址，存id，DICT_NONE为空）
+    size_t slot_capacity;         ///< 哈希表槽位总数
+} Dictionary;
+
+static Dictionary dicts[DICT_KINDS]; // 各种类的字典
+static int dict_fd = -1;             // 字典文件（首次使用时打开并加载）
+static uint64_t dict_records = 0;    // 字典文件中的记录数
+
+static const char *status_names[STATUS_KINDS] = {"未知", "准点", "延误", "取消"};
+
+/**
+ * @brief 计算名称哈希值（FNV-1a）
+ *
+ * @param name 名称
+ * @return unsigned int 哈希值
+ */
+static unsigned int hash_name(const char *name)
+{
+    unsigned int h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++)
+    {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief 在哈希表中查找名称
+ *
+ * @param d 字典
+ * @param name 名称
+ * @return size_t 名称所在槽位，未登记时为应插入的空槽
+ */
+static size_t slot_find(const Dictionary *d, const char *name)
+{
+    size_t pos = hash_name(name) & (d->slot_capacity - 1);
+    while (d->slots[pos] != DICT_NONE && strcmp(d->names[d->slots[pos] - 1], name))
+        pos = (pos + 1) & (d->slot_capacity - 1);
+    return pos;
+}
+
+/**
+ * @brief 把名称加入内存中的字典（不写文件）
+ *
+ * @param d 字典
+ * @param name 名称（长度已检查）
+ * @return DictId 新名称的id，失败返回DICT_NONE
+ */
+static DictId dict_add(Dictionary *d, const char *name)
+{
+    if (d->count >= 0xFFFF)
+    {
+        fprintf(stderr, "字典已满，无法登记%s\n", name);
+        return DICT_NONE;
+    }
+
+    // 名称数组扩容
+    if (d->count == d->capacity)
+    {
+        int new_capacity = d->capacity ? d->capacity * 2 : DICT_MIN_CAPACITY;
+        char(*grown)[DICT_NAME_MAX] = realloc(d->names, (size_t)new_capacity * DICT_NAME_MAX);
+        if (grown == NULL)
+        {
+            perror("dict realloc");
+            return DICT_NONE;
+        }
+        d->names = grown;
+        d->capacity = new_capacity;
+    }
+
+    // 哈希表装载因子超过0.5时扩容并重新放置
+    if ((size_t)(d->count + 1) * 2 > d->slot_capacity)
+    {
+        size_t new_capacity = d->slot_capacity ? d->slot_capacity * 2 : DICT_MIN_CAPACITY;
+        DictId *grown = (DictId *)calloc(new_capacity, sizeof(DictId));
+        if (grown == NULL)
+        {
+            perror("dict calloc");
+            return DICT_NONE;
+        }
+        free(d->slots);
+        d->slots = grown;
+        d->slot_capacity = new_capacity;
+        for (int i = 0; i < d->count; i++)
+            d->slots[slot_find(d, d->names[i])] = (DictId)(i + 1);
+    }
+
+    strcpy(d->names[d->count], name);
+    d->count++;
+    d->slots[slot_find(d, name)] = (DictId)d->count;
+    return (DictId)d->count;
+}
+
+/**
+ * @brief 打开并加载字典文件（首次调用时执行）
+ *
+ * 逐条校验记录CRC和id顺序，末尾残缺或无效的记录被截掉。
+ *
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int dict_open()
+{
+    if (dict_fd >= 0)
+        return SUCCESS;
+
+    int fd = open(DICT_FILE, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        perror("打开字典文件失败");
+        return FAILURE;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        perror("读取字典文件信息失败");
+        close(fd);
+        return FAILURE;
+    }
+
+    // 新文件写入文件头
+    FileHeader header;
+    if (st.st_size < (off_t)sizeof(header))
+    {
+        if (ftruncate(fd, 0) != 0 || header_write(fd, DICT_FILE_MAGIC, sizeof(DictDisk), 0, 0) != SUCCESS)
+        {
+            close(fd);
+            return FAILURE;
+        }
+        dict_fd = fd;
+        dict_records = 0;
+        return SUCCESS;
+    }
+    if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        header_check(&header, DICT_FILE_MAGIC, sizeof(DictDisk)) != SUCCESS)
+    {
+        fprintf(stderr, "字典文件头无效（版本、字节序或校验不符）\n");
+        close(fd);
+        return FAILURE;
+    }
+
+    // 逐条加载，id须按登记顺序连续
+    uint64_t n = (st.st_size - sizeof(header)) / sizeof(DictDisk);
+    uint64_t valid = 0;
+    for (; valid < n; valid++)
+    {
+        DictDisk rec;
+        off_t offset = sizeof(header) + valid * sizeof(DictDisk);
+        if (pread(fd, &rec, sizeof(rec), offset) != (ssize_t)sizeof(rec) ||
+            rec.crc != record_crc(&rec, sizeof(rec), offsetof(DictDisk, crc)) ||
+            rec.kind >= DICT_KINDS || rec.id != dicts[rec.kind].count + 1)
+            break;
+        rec.name[DICT_NAME_MAX - 1] = '\0';
+        if (dict_add(&dicts[rec.kind], rec.name) == DICT_NONE)
+            break;
+    }
+    if ((off_t)(sizeof(header) + valid * sizeof(DictDisk)) != st.st_size)
+    {
+        fprintf(stderr, "字典文件末尾有残缺记录，已忽略\n");
+        if (ftruncate(fd, sizeof(header) + valid * sizeof(DictDisk)) != 0)
+            perror("截断字典文件失败");
+    }
+    dict_fd = fd;
+    dict_records = valid;
+    return SUCCESS;
+}
+
+/**
+ * @brief 登记名称
+ *
+ * 已登记的名称直接返回id；新名称先追加到字典文件并fdatasync，再加入内存。
+ *
+ * @param kind 字典种类
+ * @param name 名称（不超过DICT_NAME_MAX-1字节）
+ * @return DictId 名称id，名称无效或写文件失败返回DICT_NONE
+ */
+DictId dict_intern(DictKind kind, const char *name)
+{
+    DictId id = dict_lookup(kind, name);
+    if (id != DICT_NONE || dict_fd < 0)
+        return id;
+    if (name[0] == '\0' || strlen(name) >= DICT_NAME_MAX)
+    {
+        fprintf(stderr, "名称\"%s\"为空或过长\n", name);
+        return DICT_NONE;
+    }
+
+    Dictionary *d = &dicts[kind];
+    DictDisk rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.kind = kind;
+    rec.id = d->count + 1;
+    strcpy(rec.name, name);
+    rec.crc = record_crc(&rec, sizeof(rec), offsetof(DictDisk, crc));
+    off_t offset = sizeof(FileHeader) + dict_records * sizeof(DictDisk);
+    if (pwrite(dict_fd, &rec, sizeof(rec), offset) != (ssize_t)sizeof(rec) ||
+        header_write(dict_fd, DICT_FILE_MAGIC, sizeof(DictDisk), dict_records + 1, 0) != SUCCESS ||
+        fdatasync(dict_fd) != 0)
+    {
+        perror("写入字典文件失败");
+        return DICT_NONE;
+    }
+    dict_records++;
+    return dict_add(d, name);
+}
+
+/**
+ * @brief 查找名称（不登记）
+ *
+ * @param kind 字典种类
+ * @param name 名称
+ * @return DictId 名称id，未登记返回DICT_NONE
+ */
+DictId dict_lookup(DictKind kind, const char *name)
+{
+    if (dict_open() != SUCCESS)
+        return DICT_NONE;
+    const Dictionary *d = &dicts[kind];
+    if (d->slot_capacity == 0)
+        return DICT_NONE;
+    return d->slots[slot_find(d, name)];
+}
+
+/**
+ * @brief id对应的名称
+ *
+ * @param kind 字典种类
+ * @param id 名称id
+ * @return const char* 名称，无效id返回空串
+ */
+const char *dict_name(DictKind kind, DictId id)
+{
+    if (dict_open() != SUCCESS || id == DICT_NONE || id > dicts[kind].count)
+        return "";
+    return dicts[kind].names[id - 1];
+}
+
+/**
+ * @brief 关闭字典文件并释放内存
+ */
+void dict_close()
+{
+    for (int k = 0; k < DICT_KINDS; k++)
+    {
+        free(dicts[k].names);
+        free(dicts[k].slots);
+        memset(&dicts[k], 0, sizeof(Dictionary));
+    }
+    if (dict_fd >= 0)
+        close(dict_fd);
+    dict_fd = -1;
+    dict_records = 0;
+}
+
+/**
+ * @brief 航班状态显示名称
+ *
+ * @param status 航班状态
+ * @return const char* 名称
+ */
+const char *status_name(FlightStatus status)
+{
+    return (unsigned)status < STATUS_KINDS ? status_names[status] : status_names[STATUS_UNKNOWN];
+}
+
+/**
+ * @brief 解析航班状态名称
+ *
+ * @param name 名称（准点/延误/取消）
+ * @param status 输出：航班状态
+ * @return int 成功返回SUCCESS，不是有效状态返回ERR_INVALID_INPUT
+ */
+int status_parse(const char *name, FlightStatus *status)
+{
+    for (int s = STATUS_ON_TIME; s < STATUS_KINDS; s++)
+    {
+        if (!strcmp(name, status_names[s]))
+        {
+            *status = (FlightStatus)s;
+            return SUCCESS;
+        }
+    }
+    return ERR_INVALID_INPUT;
+}
@@ -41,27 +41,16 @@ void get_password(char *password, int max_length)
  */
 int init()
 {
-    FILE *fp;
-
-    // 检查用户数据文件是否存在，不存在则创建
-    fp = fopen("data/userinfo.txt", "r");
-    if (fp == NULL)
+    // 检查用户数据文件是否存在，不存在则创建并初始化管理员账户
+    if (access(USERINFO_FILE, F_OK) != 0)
     {
-        // 创建文件并初始化管理员账户
-        fp = fopen("data/userinfo.txt", "w+");
-        User *admin = (User *)malloc(sizeof(User));
-        if (admin == NULL)
-        {
-            perror("malloc");
-            fclose(fp);
-            return FAILURE;
-        }
-        strcpy(admin->username, "admin"); // 默认管理员账号
-        strcpy(admin->password, "123");   // 默认密码
-        admin->type = 0;                  // 管理员类型标识
-        if (1 != fwrite(admin, sizeof(User), 1, fp))
-            perror("fwrite");
-        fclose(fp);
+        User admin;
+        memset(&admin, 0, sizeof(admin));
+        strcpy(admin.username, "admin"); // 默认管理员账号
+        strcpy(admin.password, "123");   // 默认密码
+        admin.type = 0;                  // 管理员类型标识
+        if (userstore_add(&admin) != SUCCESS)
+            printf("创建管理员账户失败\n");
     }
 
     int r = 1; // 循环控制标志
@@ -87,8 +76,8 @@ int init()
         // 退出系统处理
         if (in == '0')
         {
-            if (update_flight_info())
-            { // 保存航班数据
+            if (checkpoint_flights())
+            { // 保存航班数据（合并修改日志）
                 printf("更新航班信息到文件失败\n");
                 return FAILURE;
             };
@@ -171,37 +160,24 @@ int log_on(char *un, char *pd)
     }
     memset(newuser, 0, sizeof(User));
 
-    FILE *fp = fopen("data/userinfo.txt", "r");
-    if (fp == NULL)
+    // 通过用户名索引读取记录
+    int ret = userstore_find(un, newuser);
+    if (ret != SUCCESS)
     {
-        perror("fopen");
         free(newuser);
-        return FAILURE;
+        return ret == FAILURE ? FAILURE : ERR_NOT_FOUND; // 用户不存在
     }
-
-    // 遍历用户文件查找匹配项
-    while (fread(newuser, sizeof(User), 1, fp))
+    newuser->password[P - 1] = '\0';
+    if (strcmp(newuser->password, pd))
     {
-        if (!strcmp(newuser->username, un) && !strcmp(newuser->password, pd))
-        {
-            // 分配全局用户结构体
-            user = (User *)malloc(sizeof(User));
-            if (user == NULL)
-            {
-                perror("global user malloc");
-                free(newuser);
-                fclose(fp);
-                return FAILURE;
-            }
-            memcpy(user, newuser, sizeof(User)); // 复制用户数据
-            free(newuser);
-            fclose(fp);
-            return SUCCESS; // 登录成功
-        }
+        free(newuser);
+        return ERR_NOT_FOUND; // 密码错误
     }
-    free(newuser);
-    fclose(fp);
-    return ERR_NOT_FOUND; // 用户不存在
+
+    // 读出的记录即为当前登录用户（替换上一次登录的用户）
+    free(user);
+    user = newuser;
+    return SUCCESS; // 登录成功
 }
 
 /**
@@ -212,54 +188,20 @@ int log_on(char *un, char *pd)
  */
 int enroll(char *un, char *pd)
 {
-    User *user = (User *)malloc(sizeof(User));
-    if (user == NULL)
-    {
-        perror("User malloc");
-        return FAILURE;
-    }
-    memset(user, 0, sizeof(User));
-
-    // 以读写方式打开文件
-    FILE *fp = fopen("data/userinfo.txt", "r+");
-    if (fp == NULL)
-    {
-        perror("fopen");
-        free(user);
-        return FAILURE;
-    }
-
-    // 检查用户名是否已存在
-    while (fread(user, sizeof(User), 1, fp))
-    {
-        if (!strcmp(user->username, un))
-        {
-            free(user);
-            fclose(fp);
-            return ERR_NOT_FOUND; // 用户名已存在
-        }
-    }
+    User newuser;
+    memset(&newuser, 0, sizeof(User));
 
     // 创建新用户
-    strcpy(user->username, un);
-    strcpy(user->password, pd);
-    user->type = 1;    // 普通用户类型
-    user->balance = 0; // 初始余额
-
-    // 写入文件末尾
-    if (fseek(fp, 0, SEEK_END))
-    {
-        perror("fseek");
-        return FAILURE;
-    }
-    if (1 != fwrite(user, sizeof(User), 1, fp))
-    {
-        perror("fwrite");
-    }
+    strncpy(newuser.username, un, U - 1);
+    strncpy(newuser.password, pd, P - 1);
+    newuser.type = 1;    // 普通用户类型
+    newuser.balance = 0; // 初始余额
 
-    free(user);
-    fclose(fp);
-    return SUCCESS; // 注册成功
+    // 用户名已存在时不写入
+    int ret = userstore_add(&newuser);
+    if (ret == ERR_EXISTS)
+        return ERR_NOT_FOUND; // 用户名已存在
+    return ret;
 }
 
 /**
@@ -300,11 +242,11 @@ int sort_info(FlightNode *h)
     {
     case '1': // 按出发时间排序
         system("clear");
-        sort_list(&h, compare_by_departure_time);
+        sort_list(&h, compare_by_time_then_price);
         break;
     case '2': // 按价格排序
         system("clear");
-        sort_list(&h, compare_by_price);
+        sort_list(&h, compare_by_price_then_time);
         break;
     case '3': // 返回
         system("clear");
@@ -316,15 +258,31 @@ int sort_info(FlightNode *h)
 }
 
 /**
- * @brief 系统退出函数
- * @return 退出状态码
- * @note 释放资源并安全退出程序
+ * @brief 退出登录（不交互）
+ *
+ * 普通用户写入未提交的订单并关闭会话缓存，然后释放当前用户。
+ *
+ * @return int 订单写入失败返回FAILURE，否则返回SUCCESS
  */
-int exit_system()
+int log_off()
 {
-    printf("感谢使用航班管理系统，再见！\n");
+    if (user == NULL)
+        return SUCCESS;
+    int ret = SUCCESS;
+    if (user->type != 0)
+        ret = order_session_close();
+    if (user->userorders)
+        free_node(&user->userorders);
+    free(user);
+    user = NULL;
+    return ret;
+}
 
-    // 释放全局资源
+/**
+ * @brief 释放全局资源（不输出、不退出进程）
+ */
+void release_system()
+{
     if (user)
     {
         free(user);
@@ -335,7 +293,24 @@ int exit_system()
     {
         free_node(&List); // 释放航班链表内存
     }
+    userstore_close(); // 关闭用户存储
+    dict_close();      // 关闭机场/航空公司字典
+    node_pool_clear(); // 释放搜索结果和订单链表的节点池
+    arena_clear();     // 释放临时内存区
+}
+
+/**
+ * @brief 系统退出函数
+ * @return 退出状态码
+ * @note 释放资源并安全退出程序
+ */
+int exit_system()
+{
+    printf("感谢使用航班管理系统，再见！\n");
+
+    // 释放全局资源
+    release_system();
 
     exit(0); // 终止程序
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,448 @@
+#include "../include/head.h"
+
+#define GRAPH_MIN_CAPACITY 64   ///< 机场表初始槽位数（2的幂）
+#define MINUTES_PER_DAY (24 * 60)
+
+/**
+ * @struct graph_edge
+ * @brief 航线图的边：一个航班及其到达机场编号
+ */
+typedef struct graph_edge
+{
+    FlightNode *flight; ///< 主链表中的航班节点
+    int to;             ///< 到达机场编号
+} GraphEdge;
+
+/**
+ * @struct airport_vertex
+ * @brief 航线图的顶点：一个机场及其出发的全部航班
+ */
+typedef struct airport_vertex
+{
+    DictId airport;     ///< 机场（字典id）
+    GraphEdge *edges;   ///< 出发航班（按插入顺序）
+    int count;          ///< 出发航班数
+    int capacity;       ///< 出发航班数组容量
+} AirportVertex;
+
+/**
+ * @struct search_label
+ * @brief 中转查询中的部分方案：以某航段结尾的一条航段链
+ */
+typedef struct search_label
+{
+    FlightNode *leg;    ///< 最后一个航段
+    int prev;           ///< 上一航段的标签编号（首段为-1）
+    int airport;        ///< 当前所在机场编号
+    int legs;           ///< 已有航段数
+    long departure;     ///< 最后一个航段的出发时刻
+    long arrival;       ///< 最后一个航段的到达时刻
+    Money price;        ///< 累计价格（分）
+} SearchLabel;
+
+static AirportVertex *vertices = NULL; // 机场数组（编号即下标，机场不删除）
+static int vertex_count = 0;           // 机场数
+static int vertex_capacity = 0;        // 机场数组容量
+static int *vertex_slots = NULL;       // 机场名哈希表（开放寻址，存机场编号，-1为空）
+static size_t slot_capacity = 0;       // 哈希表槽位总数
+
+/**
+ * @brief 计算机场哈希值（乘法散列）
+ *
+ * @param airport 机场id
+ * @return unsigned int 哈希值
+ */
+static unsigned int hash_airport(DictId airport)
+{
+    return airport * 2654435761u;
+}
+
+/**
+ * @brief 扩容机场名哈希表并重新放置全部机场
+ *
+ * @param new_capacity 新槽位数（2的幂）
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int vertex_resize(size_t new_capacity)
+{
+    int *grown = (int *)malloc(new_capacity * sizeof(int));
+    if (grown == NULL)
+    {
+        perror("graph malloc");
+        return FAILURE;
+    }
+    memset(grown, -1, new_capacity * sizeof(int));
+    for (int i = 0; i < vertex_count; i++)
+    {
+        size_t pos = hash_airport(vertices[i].airport) & (new_capacity - 1);
+        while (grown[pos] != -1)
+            pos = (pos + 1) & (new_capacity - 1);
+        grown[pos] = i;
+    }
+    free(vertex_slots);
+    vertex_slots = grown;
+    slot_capacity = new_capacity;
+    return SUCCESS;
+}
+
+/**
+ * @brief 查找机场编号
+ *
+ * @param airport 机场id
+ * @param create 不存在时是否创建
+ * @return int 机场编号，不存在且不创建或失败时返回-1
+ */
+static int vertex_find(DictId airport, int create)
+{
+    if (slot_capacity != 0)
+    {
+        size_t pos = hash_airport(airport) & (slot_capacity - 1);
+        while (vertex_slots[pos] != -1)
+        {
+            if (vertices[vertex_slots[pos]].airport == airport)
+                return vertex_slots[pos];
+            pos = (pos + 1) & (slot_capacity - 1);
+        }
+    }
+    if (!create)
+        return -1;
+
+    // 装载因子超过0.5时扩容
+    if ((size_t)(vertex_count + 1) * 2 > slot_capacity &&
+        vertex_resize(slot_capacity ? slot_capacity * 2 : GRAPH_MIN_CAPACITY) != SUCCESS)
+        return -1;
+    if (vertex_count == vertex_capacity)
+    {
+        int new_capacity = vertex_capacity ? vertex_capacity * 2 : 16;
+        AirportVertex *grown = (AirportVertex *)realloc(vertices, new_capacity * sizeof(AirportVertex));
+        if (grown == NULL)
+        {
+            perror("graph realloc");
+            return -1;
+        }
+        vertices = grown;
+        vertex_capacity = new_capacity;
+    }
+
+    AirportVertex *v = &vertices[vertex_count];
+    v->airport = airport;
+    v->edges = NULL;
+    v->count = v->capacity = 0;
+
+    size_t pos = hash_airport(v->airport) & (slot_capacity - 1);
+    while (vertex_slots[pos] != -1)
+        pos = (pos + 1) & (slot_capacity - 1);
+    vertex_slots[pos] = vertex_count;
+    return vertex_count++;
+}
+
+/**
+ * @brief 将航班加入航线图（出发机场到到达机场的一条边）
+ *
+ * @param node 主链表中的节点
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+int graph_add_flight(FlightNode *node)
+{
+    if (node == NULL)
+        return FAILURE;
+    int from = vertex_find(node->flight.departure_airport, 1);
+    int to = vertex_find(node->flight.arrival_airport, 1);
+    if (from == -1 || to == -1)
+        return FAILURE;
+
+    AirportVertex *v = &vertices[from];
+    if (v->count == v->capacity)
+    {
+        int new_capacity = v->capacity ? v->capacity * 2 : 4;
+        GraphEdge *grown = (GraphEdge *)realloc(v->edges, new_capacity * sizeof(GraphEdge));
+        if (grown == NULL)
+        {
+            perror("graph realloc");
+            return FAILURE;
+        }
+        v->edges = grown;
+        v->capacity = new_capacity;
+    }
+    v->edges[v->count].flight = node;
+    v->edges[v->count].to = to;
+    v->count++;
+    return SUCCESS;
+}
+
+/**
+ * @brief 从航线图中移除航班
+ *
+ * 修改节点的机场字段前需先移除，修改后再重新加入。
+ *
+ * @param node 待移除的节点
+ * @return int 成功返回SUCCESS，未找到返回ERR_NOT_FOUND
+ */
+int graph_remove_flight(FlightNode *node)
+{
+    if (node == NULL)
+        return ERR_NOT_FOUND;
+    int from = vertex_find(node->flight.departure_airport, 0);
+    if (from == -1)
+        return ERR_NOT_FOUND;
+
+    AirportVertex *v = &vertices[from];
+    for (int i = 0; i < v->count; i++)
+    {
+        if (v->edges[i].flight == node)
+        {
+            // 出发航班顺序无意义，用末尾元素填补
+            v->edges[i] = v->edges[--v->count];
+            return SUCCESS;
+        }
+    }
+    return ERR_NOT_FOUND;
+}
+
+/**
+ * @brief 清空航线图并释放内存
+ */
+void graph_clear()
+{
+    for (int i = 0; i < vertex_count; i++)
+        free(vertices[i].edges);
+    free(vertices);
+    free(vertex_slots);
+    vertices = NULL;
+    vertex_slots = NULL;
+    vertex_count = vertex_capacity = 0;
+    slot_capacity = 0;
+}
+
+/**
+ * @brief 部分方案的排序键是否a优于b
+ *
+ * @param a 标签A
+ * @param b 标签B
+ * @param order 排序方式
+ * @return int a优于b返回真
+ */
+static int label_less(const SearchLabel *a, const SearchLabel *b, RankOrder order)
+{
+    if (order == RANK_BY_PRICE)
+    {
+        if (a->price != b->price)
+            return a->price < b->price;
+        return a->arrival < b->arrival;
+    }
+    if (a->arrival != b->arrival)
+        return a->arrival < b->arrival;
+    return a->price < b->price;
+}
+
+/**
+ * @brief 标签堆上浮
+ *
+ * @param heap 堆（存标签编号）
+ * @param n 堆中元素数（新元素在末尾）
+ * @param labels 标签数组
+ * @param order 排序方式
+ */
+static void heap_push(int *heap, int n, const SearchLabel *labels, RankOrder order)
+{
+    int i = n;
+    int id = heap[i];
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (!label_less(&labels[id], &labels[heap[parent]], order))
+            break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = id;
+}
+
+/**
+ * @brief 弹出堆顶
+ *
+ * @param heap 堆（存标签编号）
+ * @param n 堆中元素数
+ * @param labels 标签数组
+ * @param order 排序方式
+ * @return int 堆顶标签编号
+ */
+static int heap_pop(int *heap, int n, const SearchLabel *labels, RankOrder order)
+{
+    int top = heap[0];
+    int id = heap[--n];
+    int i = 0;
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n && label_less(&labels[heap[child + 1]], &labels[heap[child]], order))
+            child++;
+        if (!label_less(&labels[heap[child]], &labels[id], order))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = id;
+    return top;
+}
+
+/**
+ * @brief 检查机场是否已在部分方案中出现（避免绕回）
+ *
+ * @param labels 标签数组
+ * @param id 部分方案的末尾标签编号
+ * @param origin 出发机场编号
+ * @param airport 待检查的机场编号
+ * @return int 已出现返回真
+ */
+static int label_visits(const SearchLabel *labels, int id, int origin, int airport)
+{
+    if (airport == origin)
+        return 1;
+    for (; id != -1; id = labels[id].prev)
+    {
+        if (labels[id].airport == airport)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 查询最优的k个中转方案
+ *
+ * 在航线图上做按总价或到达时间的最优优先搜索：堆中每次取出当前最优的部分方案，
+ * 到达终点即为下一个最优方案；不经过重复机场，航段数不超过max_legs，
+ * 每个中转机场最多展开k次以限制搜索规模。
+ * 航班按每日执行处理，中转航段取最短中转时间后的最近一班。
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @param max_legs 最多航段数（1~MAX_LEGS）
+ * @param min_layover 最短中转时间（分钟）
+ * @param order 排序方式
+ * @param out 输出：方案数组（至少k个元素）
+ * @param k 最多返回的方案数
+ * @return int 方案数，失败返回FAILURE
+ */
+int search_connections(const char *s, const char *e, int max_legs, int min_layover,
+                       RankOrder order, Itinerary *out, int k)
+{
+    if (s == NULL || e == NULL || out == NULL || k <= 0 || !strcmp(s, e))
+        return 0;
+    if (max_legs < 1 || max_legs > MAX_LEGS)
+        max_legs = MAX_LEGS;
+    if (min_layover < 0)
+        min_layover = 0;
+
+    int origin = vertex_find(dict_lookup(DICT_AIRPORT, s), 0);
+    int dest = vertex_find(dict_lookup(DICT_AIRPORT, e), 0);
+    if (origin == -1 || dest == -1)
+        return 0;
+
+    // 搜索用的数组都从临时内存区分配，结束时一次释放
+    ArenaMark mark = arena_mark();
+    int *expanded = (int *)arena_alloc(vertex_count * sizeof(int));
+    int label_capacity = 256;
+    SearchLabel *labels = (SearchLabel *)arena_alloc(label_capacity * sizeof(SearchLabel));
+    int *heap = (int *)arena_alloc(label_capacity * sizeof(int));
+    if (expanded == NULL || labels == NULL || heap == NULL)
+    {
+        arena_release(mark);
+        return FAILURE;
+    }
+    memset(expanded, 0, vertex_count * sizeof(int));
+    int label_count = 0, heap_count = 0, found = 0;
+
+    // 虚拟起点：从出发机场展开全部首段
+    int current = -1;
+    int airport = origin;
+    for (;;)
+    {
+        AirportVertex *v = &vertices[airport];
+        const SearchLabel *at = current == -1 ? NULL : &labels[current];
+        for (int i = 0; i < v->count; i++)
+        {
+            FlightNode *f = v->edges[i].flight;
+            int to = v->edges[i].to;
+            int duration = flight_duration(f);
+            if (duration == TIME_INVALID)
+                continue;
+            if (current != -1 ? label_visits(labels, current, origin, to) : to == origin)
+                continue;
+
+            // 首段当日出发；后续航段取中转就绪后的最近一班
+            long departure = f->departure_minutes;
+            if (at != NULL)
+            {
+                long ready = at->arrival + min_layover;
+                long day = (ready - departure + MINUTES_PER_DAY - 1) / MINUTES_PER_DAY;
+                if (day > 0)
+                    departure += day * MINUTES_PER_DAY;
+            }
+
+            if (label_count == label_capacity)
+            {
+                // 扩容时复制到新数组，旧数组随临时内存区一起释放
+                int new_capacity = label_capacity * 2;
+                SearchLabel *grown_labels = (SearchLabel *)arena_alloc(new_capacity * sizeof(SearchLabel));
+                int *grown_heap = (int *)arena_alloc(new_capacity * sizeof(int));
+                if (grown_labels == NULL || grown_heap == NULL)
+                {
+                    arena_release(mark);
+                    return FAILURE;
+                }
+                memcpy(grown_labels, labels, label_count * sizeof(SearchLabel));
+                memcpy(grown_heap, heap, heap_count * sizeof(int));
+                labels = grown_labels;
+                heap = grown_heap;
+                label_capacity = new_capacity;
+                at = current == -1 ? NULL : &labels[current];
+            }
+
+            SearchLabel *l = &labels[label_count];
+            l->leg = f;
+            l->prev = current;
+            l->airport = to;
+            l->legs = at != NULL ? at->legs + 1 : 1;
+            l->departure = departure;
+            l->arrival = departure + duration;
+            l->price = (at != NULL ? at->price : 0) + f->flight.price;
+            heap[heap_count] = label_count++;
+            heap_push(heap, heap_count++, labels, order);
+        }
+
+        // 取出下一个可展开的部分方案
+        current = -1;
+        while (heap_count > 0 && found < k)
+        {
+            int id = heap_pop(heap, heap_count--, labels, order);
+            SearchLabel *l = &labels[id];
+            if (l->airport == dest)
+            {
+                Itinerary *it = &out[found++];
+                it->count = l->legs;
+                it->price = l->price;
+                for (int j = l->legs - 1, p = id; j >= 0; j--, p = labels[p].prev)
+                {
+                    it->legs[j] = labels[p].leg;
+                    it->departure[j] = labels[p].departure;
+                    it->arrival[j] = labels[p].arrival;
+                }
+                continue;
+            }
+            if (l->legs >= max_legs || expanded[l->airport] >= k)
+                continue;
+            expanded[l->airport]++;
+            current = id;
+            break;
+        }
+        if (current == -1)
+            break;
+        airport = labels[current].airport;
+    }
+
+    arena_release(mark);
+    return found;
+}
@@ -0,0 +1,654 @@
+#include "../include/head.h"
+
+#define INDEX_MIN_CAPACITY 64                  ///< 索引初始槽位数（2的幂）
+#define INDEX_DELETED ((FlightNode *)-1)       ///< 已删除槽位标记
+
+/**
+ * @enum run_kind
+ * @brief 航线有序数组的排序键
+ */
+enum run_kind
+{
+    RUN_TIME = 0,  ///< 按出发时间
+    RUN_PRICE = 1, ///< 按价格
+    RUN_KINDS = 2  ///< 有序数组种类数
+};
+
+/**
+ * @struct index_slot
+ * @brief 航班号索引槽位
+ */
+typedef struct index_slot
+{
+    unsigned int hash; ///< 航班号哈希值
+    FlightNode *node;  ///< 节点指针（NULL为空槽，INDEX_DELETED为已删除）
+} IndexSlot;
+
+/**
+ * @struct route_entry
+ * @brief 航线索引条目：一条(出发机场, 到达机场)航线下的全部航班
+ */
+typedef struct route_entry
+{
+    unsigned int hash;                  ///< 航线哈希值
+    DictId departure_airport;           ///< 出发机场
+    DictId arrival_airport;             ///< 到达机场
+    FlightNode **flights;               ///< 该航线的航班节点（按插入顺序）
+    FlightNode **runs[RUN_KINDS];       ///< 按出发时间/价格排序的航班节点（与flights等容量）
+    int run_sorted[RUN_KINDS];          ///< 有序数组是否有效（无效时在查询时重新排序）
+    int count;                          ///< 航班数
+    int capacity;                       ///< 航班数组容量
+} RouteEntry;
+
+static IndexSlot *slots = NULL; // 槽位数组
+static size_t capacity = 0;     // 槽位总数
+static size_t live = 0;         // 有效节点数
+static size_t deleted = 0;      // 已删除槽位数
+
+static RouteEntry *routes = NULL; // 航线表（开放寻址，条目不删除）
+static size_t route_capacity = 0; // 航线表槽位总数
+static size_t route_used = 0;     // 已使用的航线条目数
+
+/**
+ * @brief 计算航班号哈希值（FNV-1a）
+ *
+ * @param number 航班号
+ * @return unsigned int 哈希值
+ */
+static unsigned int hash_number(const char *number)
+{
+    unsigned int h = 2166136261u;
+    while (*number)
+    {
+        h ^= (unsigned char)*number++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief 计算航线哈希值（两个机场id拼接后乘法散列）
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @return unsigned int 哈希值
+ */
+static unsigned int hash_route(DictId s, DictId e)
+{
+    return (((unsigned int)s << 16) | e) * 2654435761u;
+}
+
+/**
+ * @brief 重新分配槽位数组并迁移有效节点
+ *
+ * @param new_capacity 新槽位数（2的幂）
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int index_resize(size_t new_capacity)
+{
+    IndexSlot *new_slots = (IndexSlot *)calloc(new_capacity, sizeof(IndexSlot));
+    if (new_slots == NULL)
+    {
+        perror("index calloc");
+        return FAILURE;
+    }
+
+    // 迁移有效节点，丢弃删除标记
+    for (size_t i = 0; i < capacity; i++)
+    {
+        if (slots[i].node == NULL || slots[i].node == INDEX_DELETED)
+            continue;
+        size_t pos = slots[i].hash & (new_capacity - 1);
+        while (new_slots[pos].node != NULL)
+            pos = (pos + 1) & (new_capacity - 1);
+        new_slots[pos] = slots[i];
+    }
+
+    free(slots);
+    slots = new_slots;
+    capacity = new_capacity;
+    deleted = 0;
+    return SUCCESS;
+}
+
+/**
+ * @brief 将节点加入航班号索引
+ *
+ * 航班号已存在时保留先插入的节点，与链表顺序查找的结果一致。
+ *
+ * @param node 主链表中的节点
+ * @return int 成功返回SUCCESS，已存在返回ERR_EXISTS，失败返回FAILURE
+ */
+static int number_insert(FlightNode *node)
+{
+    // 装载因子（含删除标记）超过0.7时扩容或清理
+    if ((live + deleted + 1) * 10 > capacity * 7)
+    {
+        size_t new_capacity = capacity ? capacity : INDEX_MIN_CAPACITY;
+        while ((live + 1) * 10 > new_capacity * 5)
+            new_capacity <<= 1;
+        if (index_resize(new_capacity) != SUCCESS)
+            return FAILURE;
+    }
+
+    unsigned int h = hash_number(node->flight.number);
+    size_t pos = h & (capacity - 1);
+    size_t reuse = capacity; // 可复用的删除槽位
+
+    while (slots[pos].node != NULL)
+    {
+        if (slots[pos].node == INDEX_DELETED)
+        {
+            if (reuse == capacity)
+                reuse = pos;
+        }
+        else if (slots[pos].hash == h && !strcmp(slots[pos].node->flight.number, node->flight.number))
+        {
+            return ERR_EXISTS;
+        }
+        pos = (pos + 1) & (capacity - 1);
+    }
+
+    if (reuse != capacity)
+    {
+        pos = reuse;
+        deleted--;
+    }
+    slots[pos].hash = h;
+    slots[pos].node = node;
+    live++;
+    return SUCCESS;
+}
+
+/**
+ * @brief 从航班号索引中移除节点
+ *
+ * @param node 待移除的节点
+ * @return int 成功返回SUCCESS，未找到返回ERR_NOT_FOUND
+ */
+static int number_remove(FlightNode *node)
+{
+    if (capacity == 0)
+        return ERR_NOT_FOUND;
+
+    unsigned int h = hash_number(node->flight.number);
+    size_t pos = h & (capacity - 1);
+    while (slots[pos].node != NULL)
+    {
+        if (slots[pos].node == node)
+        {
+            slots[pos].node = INDEX_DELETED;
+            live--;
+            deleted++;
+            return SUCCESS;
+        }
+        pos = (pos + 1) & (capacity - 1);
+    }
+    return ERR_NOT_FOUND;
+}
+
+/**
+ * @brief 查找航线条目
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @param create 不存在时是否创建
+ * @return RouteEntry* 航线条目，不存在且不创建时返回NULL
+ */
+static RouteEntry *route_entry(DictId s, DictId e, int create)
+{
+    // 航线表装载因子超过0.5时扩容
+    if (create && (route_used + 1) * 2 > route_capacity)
+    {
+        size_t new_capacity = route_capacity ? route_capacity << 1 : INDEX_MIN_CAPACITY;
+        RouteEntry *new_routes = (RouteEntry *)calloc(new_capacity, sizeof(RouteEntry));
+        if (new_routes == NULL)
+        {
+            perror("route calloc");
+            return NULL;
+        }
+        for (size_t i = 0; i < route_capacity; i++)
+        {
+            if (routes[i].flights == NULL)
+                continue;
+            size_t pos = routes[i].hash & (new_capacity - 1);
+            while (new_routes[pos].flights != NULL)
+                pos = (pos + 1) & (new_capacity - 1);
+            new_routes[pos] = routes[i];
+        }
+        free(routes);
+        routes = new_routes;
+        route_capacity = new_capacity;
+    }
+    if (route_capacity == 0)
+        return NULL;
+
+    unsigned int h = hash_route(s, e);
+    size_t pos = h & (route_capacity - 1);
+    while (routes[pos].flights != NULL)
+    {
+        if (routes[pos].departure_airport == s && routes[pos].arrival_airport == e)
+            return &routes[pos];
+        pos = (pos + 1) & (route_capacity - 1);
+    }
+    if (!create)
+        return NULL;
+
+    // 创建新航线条目
+    RouteEntry *r = &routes[pos];
+    r->flights = (FlightNode **)malloc(4 * sizeof(FlightNode *));
+    if (r->flights == NULL)
+    {
+        perror("route malloc");
+        return NULL;
+    }
+    r->hash = h;
+    r->departure_airport = s;
+    r->arrival_airport = e;
+    for (int k = 0; k < RUN_KINDS; k++)
+    {
+        r->runs[k] = NULL;
+        r->run_sorted[k] = 0;
+    }
+    r->count = 0;
+    r->capacity = 4;
+    route_used++;
+    return r;
+}
+
+
+/**
+ * @brief 按机场名查找航线条目（机场未登记时不存在）
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @return RouteEntry* 航线条目，不存在返回NULL
+ */
+static RouteEntry *route_lookup(const char *s, const char *e)
+{
+    if (s == NULL || e == NULL)
+        return NULL;
+    DictId from = dict_lookup(DICT_AIRPORT, s), to = dict_lookup(DICT_AIRPORT, e);
+    if (from == DICT_NONE || to == DICT_NONE)
+        return NULL;
+    return route_entry(from, to, 0);
+}
+/**
+ * @brief 取节点在有序数组中的排序键
+ *
+ * @param node 航班节点
+ * @param kind 有序数组种类
+ * @return Money 出发时间（分钟）或价格（分）
+ */
+static Money run_key(const FlightNode *node, int kind)
+{
+    return kind == RUN_TIME ? node->departure_minutes : node->flight.price;
+}
+
+/**
+ * @brief 在有序数组中查找第一个键大于(或不小于)指定值的位置
+ *
+ * @param a 有序航班节点数组
+ * @param n 节点数
+ * @param kind 有序数组种类
+ * @param key 查找的键
+ * @param upper 非0查找大于key的位置，0查找不小于key的位置
+ * @return int 位置下标
+ */
+static int run_bound(FlightNode *const *a, int n, int kind, Money key, int upper)
+{
+    int lo = 0, hi = n;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        Money k = run_key(a[mid], kind);
+        if (k < key || (upper && k == key))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief qsort比较函数：按出发时间，相同时按目录句柄
+ */
+static int compare_departure(const void *a, const void *b)
+{
+    const FlightNode *x = *(FlightNode *const *)a;
+    const FlightNode *y = *(FlightNode *const *)b;
+    if (x->departure_minutes != y->departure_minutes)
+        return x->departure_minutes - y->departure_minutes;
+    return x->handle - y->handle;
+}
+
+/**
+ * @brief qsort比较函数：按价格，相同时按目录句柄
+ */
+static int compare_price(const void *a, const void *b)
+{
+    const FlightNode *x = *(FlightNode *const *)a;
+    const FlightNode *y = *(FlightNode *const *)b;
+    if (x->flight.price != y->flight.price)
+        return x->flight.price < y->flight.price ? -1 : 1;
+    return x->handle - y->handle;
+}
+
+/**
+ * @brief 确保航线的某个有序数组有效
+ *
+ * 批量加载期间只追加航班、标记失效，首次按时段/价格查询时整体排序一次；
+ * 之后的增删在有序数组上就地维护。
+ *
+ * @param r 航线条目
+ * @param kind 有序数组种类
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int route_sort_run(RouteEntry *r, int kind)
+{
+    if (r->run_sorted[kind])
+        return SUCCESS;
+    if (r->runs[kind] == NULL)
+    {
+        r->runs[kind] = (FlightNode **)malloc(r->capacity * sizeof(FlightNode *));
+        if (r->runs[kind] == NULL)
+        {
+            perror("route malloc");
+            return FAILURE;
+        }
+    }
+    memcpy(r->runs[kind], r->flights, r->count * sizeof(FlightNode *));
+    qsort(r->runs[kind], r->count, sizeof(FlightNode *),
+          kind == RUN_TIME ? compare_departure : compare_price);
+    r->run_sorted[kind] = 1;
+    return SUCCESS;
+}
+
+/**
+ * @brief 将节点加入航线索引
+ *
+ * @param node 主链表中的节点
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int route_insert(FlightNode *node)
+{
+    RouteEntry *r = route_entry(node->flight.departure_airport, node->flight.arrival_airport, 1);
+    if (r == NULL)
+        return FAILURE;
+    if (r->count == r->capacity)
+    {
+        FlightNode **grown = (FlightNode **)realloc(r->flights, r->capacity * 2 * sizeof(FlightNode *));
+        if (grown == NULL)
+        {
+            perror("route realloc");
+            return FAILURE;
+        }
+        r->flights = grown;
+        r->capacity *= 2;
+
+        // 有序数组随之失效，下次查询时重新分配并排序
+        for (int k = 0; k < RUN_KINDS; k++)
+        {
+            free(r->runs[k]);
+            r->runs[k] = NULL;
+            r->run_sorted[k] = 0;
+        }
+    }
+
+    // 有序数组有效时按键插入（键相同排在已有航班之后）
+    for (int k = 0; k < RUN_KINDS; k++)
+    {
+        if (!r->run_sorted[k])
+            continue;
+        int pos = run_bound(r->runs[k], r->count, k, run_key(node, k), 1);
+        memmove(&r->runs[k][pos + 1], &r->runs[k][pos], (r->count - pos) * sizeof(FlightNode *));
+        r->runs[k][pos] = node;
+    }
+    r->flights[r->count++] = node;
+    return SUCCESS;
+}
+
+/**
+ * @brief 从航线索引中移除节点（保持其余航班顺序）
+ *
+ * @param node 待移除的节点
+ * @return int 成功返回SUCCESS，未找到返回ERR_NOT_FOUND
+ */
+static int route_remove(FlightNode *node)
+{
+    RouteEntry *r = route_entry(node->flight.departure_airport, node->flight.arrival_airport, 0);
+    if (r == NULL)
+        return ERR_NOT_FOUND;
+    for (int i = 0; i < r->count; i++)
+    {
+        if (r->flights[i] == node)
+        {
+            memmove(&r->flights[i], &r->flights[i + 1], (r->count - i - 1) * sizeof(FlightNode *));
+
+            // 同步移除有序数组中的节点
+            for (int k = 0; k < RUN_KINDS; k++)
+            {
+                if (!r->run_sorted[k])
+                    continue;
+                FlightNode **run = r->runs[k];
+                int pos = run_bound(run, r->count, k, run_key(node, k), 0);
+                while (pos < r->count && run[pos] != node)
+                    pos++;
+                if (pos < r->count)
+                    memmove(&run[pos], &run[pos + 1], (r->count - pos - 1) * sizeof(FlightNode *));
+                else
+                    r->run_sorted[k] = 0;
+            }
+            r->count--;
+            return SUCCESS;
+        }
+    }
+    return ERR_NOT_FOUND;
+}
+
+/**
+ * @brief 在航线的某个有序数组上按键区间查找
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @param kind 有序数组种类
+ * @param low 区间下限（含）
+ * @param high 区间上限（含）
+ * @param count 输出：航班数
+ * @return FlightNode* const* 有序航班节点切片，无航班返回NULL
+ */
+static FlightNode *const *route_range(const char *s, const char *e, int kind, Money low, Money high, int *count)
+{
+    *count = 0;
+    if (low > high)
+        return NULL;
+    RouteEntry *r = route_lookup(s, e);
+    if (r == NULL || r->count == 0 || route_sort_run(r, kind) != SUCCESS)
+        return NULL;
+
+    int begin = run_bound(r->runs[kind], r->count, kind, low, 0);
+    int end = run_bound(r->runs[kind], r->count, kind, high, 1);
+    if (begin >= end)
+        return NULL;
+    *count = end - begin;
+    return r->runs[kind] + begin;
+}
+
+/**
+ * @brief 将节点加入全部索引（航班号、航线、航线图）
+ *
+ * 先加入航班号索引，航班号重复时其余索引不变；
+ * 后续索引加入失败时撤回已加入的部分，节点要么在全部索引中，要么都不在。
+ *
+ * @param node 主链表中的节点
+ * @return int 成功返回SUCCESS，航班号重复返回ERR_EXISTS，失败返回FAILURE
+ */
+int index_insert(FlightNode *node)
+{
+    if (node == NULL)
+        return FAILURE;
+    int ret = number_insert(node);
+    if (ret != SUCCESS)
+        return ret;
+    if (route_insert(node) != SUCCESS)
+    {
+        number_remove(node);
+        return FAILURE;
+    }
+    if (graph_add_flight(node) != SUCCESS)
+    {
+        route_remove(node);
+        number_remove(node);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 从全部索引中移除节点
+ *
+ * 修改节点的航线字段前需先移除，修改后再重新加入。
+ *
+ * @param node 待移除的节点
+ * @return int 成功返回SUCCESS，未找到返回ERR_NOT_FOUND
+ */
+int index_remove(FlightNode *node)
+{
+    if (node == NULL)
+        return ERR_NOT_FOUND;
+    route_remove(node);
+    graph_remove_flight(node);
+    return number_remove(node);
+}
+
+/**
+ * @brief 按航线查找航班
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @param count 输出：航班数
+ * @return FlightNode* const* 航班节点数组（由索引持有，主链表变化后失效），无航班返回NULL
+ */
+FlightNode *const *route_find(const char *s, const char *e, int *count)
+{
+    *count = 0;
+    RouteEntry *r = route_lookup(s, e);
+    if (r == NULL || r->count == 0)
+        return NULL;
+    *count = r->count;
+    return r->flights;
+}
+
+/**
+ * @brief 按航线和出发时段查找航班
+ *
+ * 在航线的按时间排序数组上二分定位，耗时O(log n + k)。
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @param from 时段起点（分钟，含）
+ * @param to 时段终点（分钟，含），须不小于from
+ * @param count 输出：航班数
+ * @return FlightNode* const* 按出发时间排序的航班节点（由索引持有，主链表变化后失效），无航班返回NULL
+ */
+FlightNode *const *route_time_range(const char *s, const char *e, int from, int to, int *count)
+{
+    return route_range(s, e, RUN_TIME, from, to, count);
+}
+
+/**
+ * @brief 按航线和价格区间查找航班
+ *
+ * 在航线的按价格排序数组上二分定位，耗时O(log n + k)。
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @param low 最低价格（含）
+ * @param high 最高价格（含）
+ * @param count 输出：航班数
+ * @return FlightNode* const* 按价格排序的航班节点（由索引持有，主链表变化后失效），无航班返回NULL
+ */
+FlightNode *const *route_price_range(const char *s, const char *e, Money low, Money high, int *count)
+{
+    return route_range(s, e, RUN_PRICE, low, high, count);
+}
+
+/**
+ * @brief 按航班号查找节点
+ *
+ * @param number 航班号
+ * @return FlightNode* 找到返回节点指针，未找到返回NULL
+ */
+FlightNode *index_find(const char *number)
+{
+    if (number == NULL || capacity == 0)
+        return NULL;
+
+    unsigned int h = hash_number(number);
+    size_t pos = h & (capacity - 1);
+    while (slots[pos].node != NULL)
+    {
+        if (slots[pos].node != INDEX_DELETED && slots[pos].hash == h &&
+            !strcmp(slots[pos].node->flight.number, number))
+            return slots[pos].node;
+        pos = (pos + 1) & (capacity - 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 预留至少n个航班的航班号索引空间（批量加载前调用）
+ *
+ * @param n 航班数
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+int index_reserve(int n)
+{
+    size_t new_capacity = capacity ? capacity : INDEX_MIN_CAPACITY;
+    while ((live + n) * 10 > new_capacity * 5)
+        new_capacity <<= 1;
+    if (new_capacity == capacity)
+        return SUCCESS;
+    return index_resize(new_capacity);
+}
+
+/**
+ * @brief 按链表内容重建全部索引
+ *
+ * @param h 链表头节点
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+int index_rebuild(FlightNode *h)
+{
+    index_clear();
+    if (h == NULL)
+        return FAILURE;
+
+    for (FlightNode *p = h->next; p; p = p->next)
+    {
+        if (index_insert(p) == FAILURE)
+            return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 清空全部索引并释放内存
+ */
+void index_clear()
+{
+    graph_clear();
+    free(slots);
+    slots = NULL;
+    capacity = live = deleted = 0;
+
+    for (size_t i = 0; i < route_capacity; i++)
+    {
+        free(routes[i].flights);
+        for (int k = 0; k < RUN_KINDS; k++)
+            free(routes[i].runs[k]);
+    }
+    free(routes);
+    routes = NULL;
+    route_capacity = route_used = 0;
+}
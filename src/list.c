@@ -1,5 +1,27 @@
 #include "../include/head.h"
 
+static unsigned long list_generation = 0; // 链表修改计数，任何链表增删改都会递增
+
+#define FLIGHTS_TEMP_FILE "data/flights.txt.tmp" ///< 检查点临时文件
+#define FLIGHTS_PREV_FILE "data/flights.txt.prev" ///< 上一个检查点（与日志一起可恢复出当前数据）
+#define FLIGHTS_CORRUPT_FILE "data/flights.txt.corrupt" ///< 无法加载的航班数据文件改名后的路径
+#define JOURNAL_TEMP_FILE "data/flights.journal.tmp" ///< 裁剪日志时的临时文件
+#define JOURNAL_CORRUPT_FILE "data/flights.journal.corrupt" ///< 无法识别的航班日志改名后的路径
+
+static int legacy_loaded = 0;   // 加载的是第1版航班文件，需要转换
+static int journal_fd = -1;     // 日志文件描述符（追加模式，延迟打开）
+static int journal_entries = 0; // 上次检查点之后的日志记录数
+static off_t journal_covered = 0; // 日志开头已包含在当前检查点中的长度（0为未知，下次检查点时全部保留）
+static pthread_mutex_t journal_lock = PTHREAD_MUTEX_INITIALIZER; // 订票线程并发写日志
+
+static const char *mapped_data = NULL;    // 只读映射的航班数据文件（未建立链表时有效）
+static const char *mapped_records = NULL; // 映射中第一条记录
+static size_t mapped_size = 0;            // 映射长度
+static size_t mapped_count = 0;           // 映射中的记录数
+static int mapped_version = 0;            // 映射文件的版本
+static int deferred = 0;                  // 主链表尚未建立，航班数据只在映射中
+static int load_failed = 0;               // 航班数据文件无法加载（不建立主链表，也不覆盖该文件）
+
 /**
  * @brief 从CSV文件加载航班数据到链表
  *
@@ -20,7 +42,9 @@ int load_flights_from_csv(const char *filename)
     // 跳过标题行
     fgets(line, sizeof(line), fp);
 
-    // 创建链表头节点
+    // 创建链表头节点（重建主链表时释放旧目录和索引）
+    if (List)
+        free_node(&List);
     List = createHead();
     if (!List)
         return FAILURE;
@@ -30,43 +54,53 @@ int load_flights_from_csv(const char *filename)
     {
         Flight_n flight;
         memset(&flight, 0, sizeof(Flight_n)); // 初始化航班结构体
+        flight.capacity = FLIGHT_DEFAULT_CAPACITY;
+        char *fields[8] = {NULL};             // 航班号,航空公司,出发时间,到达时间,出发机场,到达机场,状态,价格
 
         // 使用strtok解析CSV行数据
-        char *token = strtok(line, ",");
-        if (!token)
+        fields[0] = strtok(line, ",");
+        if (!fields[0])
             continue;
-        strncpy(flight.number, token, sizeof(flight.number) - 1); // 航班号
-
-        token = strtok(NULL, ",");
-        if (token)
-            strncpy(flight.airline, token, sizeof(flight.airline) - 1); // 航空公司
-
-        token = strtok(NULL, ",");
-        if (token)
-            strncpy(flight.departure_time, token, sizeof(flight.departure_time) - 1); // 出发时间
-
-        token = strtok(NULL, ",");
-        if (token)
-            strncpy(flight.arrival_time, token, sizeof(flight.arrival_time) - 1); // 到达时间
-
-        token = strtok(NULL, ",");
-        if (token)
-            strncpy(flight.departure_airport, token, sizeof(flight.departure_airport) - 1); // 出发机场
-
-        token = strtok(NULL, ",");
-        if (token)
-            strncpy(flight.arrival_airport, token, sizeof(flight.arrival_airport) - 1); // 到达机场
+        for (int i = 1; i < 8; i++)
+            fields[i] = strtok(NULL, ",\r\n");
+        strncpy(flight.number, fields[0], sizeof(flight.number) - 1); // 航班号
+        if (money_parse(fields[7], &flight.price) != SUCCESS) // 机票价格（如"980.00元"）
+        {
+            fprintf(stderr, "航班%s价格格式错误，已跳过\n", flight.number);
+            continue;
+        }
 
-        token = strtok(NULL, ",");
-        if (token)
-            strncpy(flight.status, token, sizeof(flight.status) - 1); // 航班状态
+        // 解析并规范化起降时间
+        short dep, arr;
+        char dep_text[16], arr_text[16];
+        snprintf(dep_text, sizeof(dep_text), "%s", fields[2] ? fields[2] : "");
+        snprintf(arr_text, sizeof(arr_text), "%s", fields[3] ? fields[3] : "");
+        if (parse_time(dep_text, &dep) != SUCCESS || parse_time(arr_text, &arr) != SUCCESS)
+        {
+            fprintf(stderr, "航班%s时间格式错误，已跳过\n", flight.number);
+            continue;
+        }
+        strcpy(flight.departure_time, dep_text);
+        strcpy(flight.arrival_time, arr_text);
 
-        token = strtok(NULL, ",");
-        if (token)
-            flight.price = atof(token); // 机票价格
+        // 航空公司和机场登记到字典，状态转为枚举
+        FlightStatus status = STATUS_UNKNOWN;
+        if (fields[6])
+            status_parse(fields[6], &status);
+        flight.status = status;
+        flight.airline = fields[1] ? dict_intern(DICT_AIRLINE, fields[1]) : DICT_NONE;
+        flight.departure_airport = fields[4] ? dict_intern(DICT_AIRPORT, fields[4]) : DICT_NONE;
+        flight.arrival_airport = fields[5] ? dict_intern(DICT_AIRPORT, fields[5]) : DICT_NONE;
+        if (flight.airline == DICT_NONE || flight.departure_airport == DICT_NONE ||
+            flight.arrival_airport == DICT_NONE)
+        {
+            fprintf(stderr, "航班%s缺少航空公司或机场，已跳过\n", flight.number);
+            continue;
+        }
 
         // 将航班插入链表尾部
-        tail_insert(List, &flight);
+        if (tail_insert_times(List, &flight, dep, arr) == ERR_EXISTS)
+            fprintf(stderr, "航班%s重复，已跳过\n", flight.number);
     }
 
     fclose(fp);
@@ -74,94 +108,330 @@ int load_flights_from_csv(const char *filename)
 }
 
 /**
- * @brief 从二进制文件加载航班数据到链表
+ * @brief 映射航班数据文件并识别版本（只读，不建立链表）
  *
- * @return int 成功返回0，失败返回-1
+ * 只校验文件头，记录CRC留到建立链表时校验，映射本身与航班数无关。
+ * 成功后映射保存在mapped_*中，由flights_materialize()或flights_unmap()释放。
+ *
+ * @param path 航班数据文件（flightS_FILE或FLIGHTS_PREV_FILE）
+ * @return int 成功返回SUCCESS，文件不存在返回ERR_NOT_FOUND，无法读取或无效返回FAILURE
  */
-int load_flights_from_file()
+static int flights_map(const char *path)
 {
     // 打开二进制文件
-    FILE *fp = fopen("data/flights.txt", "rb");
-    if (fp == NULL)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
     {
         // 文件不存在不算错误（可能是首次运行）
+        if (errno == ENOENT)
+            return ERR_NOT_FOUND;
+        perror("无法打开航班数据文件");
+        return FAILURE;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        perror("读取航班数据文件信息失败");
+        close(fd);
+        return FAILURE;
+    }
+
+    mapped_data = NULL;
+    mapped_size = st.st_size;
+    mapped_count = 0;
+    mapped_version = RECORD_VERSION;
+    if (mapped_size == 0)
+    {
+        close(fd);
+        return SUCCESS;
+    }
+
+    // 一次映射整个文件
+    const char *data = mmap(NULL, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        perror("映射航班数据文件失败");
         return FAILURE;
     }
 
+    // 识别文件版本：当前版本有文件头，第1版为无文件头的LegacyFlight数组
+    size_t offset = 0, record_size = sizeof(LegacyFlight);
+    const FileHeader *header = (const FileHeader *)data;
+    mapped_version = 1;
+    if (mapped_size >= sizeof(FileHeader) && !memcmp(header->magic, FLIGHTS_FILE_MAGIC, 4))
+    {
+        if (header_check(header, FLIGHTS_FILE_MAGIC, sizeof(FlightDisk)) != SUCCESS)
+        {
+            fprintf(stderr, "航班数据文件头无效（版本、字节序或校验不符），拒绝加载\n");
+            munmap((void *)data, mapped_size);
+            return FAILURE;
+        }
+        mapped_version = RECORD_VERSION;
+        offset = sizeof(FileHeader);
+        record_size = sizeof(FlightDisk);
+    }
+
+    // 由文件大小计算记录数；当前版本记录之后是座位图区，记录数以文件头为准
+    mapped_count = (mapped_size - offset) / record_size;
+    if (mapped_version == RECORD_VERSION)
+    {
+        if (header->count > mapped_count)
+        {
+            fprintf(stderr, "航班数据文件记录数与文件头不符，拒绝加载\n");
+            munmap((void *)data, mapped_size);
+            return FAILURE;
+        }
+        mapped_count = header->count;
+    }
+    else if ((mapped_size - offset) % record_size != 0)
+    {
+        fprintf(stderr, "航班数据文件大小(%zu)与记录长度不符，末尾残缺记录已忽略\n", mapped_size);
+    }
+    mapped_data = data;
+    mapped_records = data + offset;
+    return SUCCESS;
+}
+
+/**
+ * @brief 释放航班数据文件映射
+ */
+static void flights_unmap()
+{
+    if (mapped_data != NULL)
+        munmap((void *)mapped_data, mapped_size);
+    mapped_data = NULL;
+    mapped_records = NULL;
+    mapped_size = 0;
+    mapped_count = 0;
+}
+
+/**
+ * @brief 从映射的航班数据文件建立主链表，完成后释放映射
+ *
+ * 当前版本先校验全部记录和座位图的CRC；预留目录空间后直接从映射的定宽记录
+ * 以O(1)尾插逐条建立主链表，总耗时与航班数成线性关系。
+ *
+ * @return int 成功返回0，失败返回-1
+ */
+static int flights_materialize()
+{
     // 确保链表已初始化
     if (List == NULL)
     {
         List = createHead();
         if (List == NULL)
         {
-            fclose(fp);
+            flights_unmap();
             return -1;
         }
     }
 
-    // 读取文件内容
-    Flight_n flight;
-    int count = 0;
+    // CRC包括记录之后的座位图区
+    int current = mapped_version == RECORD_VERSION;
+    size_t payload = current && mapped_data != NULL ? mapped_size - sizeof(FileHeader) : 0;
+    if (payload > 0 && crc32_update(0, mapped_records, payload) != ((const FileHeader *)mapped_data)->payload_crc)
+    {
+        fprintf(stderr, "航班数据文件校验失败，拒绝加载\n");
+        flights_unmap();
+        return -1;
+    }
+    if (mapped_data != NULL)
+        madvise((void *)mapped_data, mapped_size, MADV_SEQUENTIAL);
 
-    // 逐条读取航班数据
-    while (fread(&flight, sizeof(Flight_n), 1, fp) == 1)
+    // 预留目录和索引空间，避免加载过程中反复扩容
+    catalog_reserve(mapped_count);
+    index_reserve(mapped_count);
+
+    // 逐条添加到链表尾部
+    const unsigned char *seat_data = (const unsigned char *)mapped_records + mapped_count * sizeof(FlightDisk);
+    const unsigned char *seat_end = (const unsigned char *)mapped_records + payload;
+    for (size_t i = 0; i < mapped_count; i++)
     {
-        // 将航班添加到链表尾部
-        if (tail_insert(List, &flight) != SUCCESS)
+        int ret;
+        Flight_n flight;
+        short dep, arr;
+        if (current)
+        {
+            flight_from_disk((const FlightDisk *)mapped_records + i, &flight, &dep, &arr);
+            ret = tail_insert_times(List, &flight, dep, arr);
+            // 座位图区按记录顺序存放，每个航班seatmap_bytes(座位数)字节
+            size_t bytes = seatmap_bytes(flight.capacity);
+            if ((size_t)(seat_end - seat_data) < bytes)
+            {
+                fprintf(stderr, "航班%s的座位图残缺，已忽略\n", flight.number);
+                seat_data = seat_end;
+            }
+            else
+            {
+                if (ret == SUCCESS)
+                    seatmap_load(index_find(flight.number), seat_data);
+                seat_data += bytes;
+            }
+        }
+        else
+        {
+            ret = flight_from_legacy((const LegacyFlight *)mapped_records + i, &flight);
+            if (ret == SUCCESS)
+                ret = tail_insert(List, &flight);
+        }
+        if (ret == ERR_EXISTS)
+        {
+            fprintf(stderr, "航班%s重复，已跳过\n", flight.number);
+        }
+        else if (ret != SUCCESS)
         {
             fprintf(stderr, "添加航班数据到链表失败\n");
         }
-        count++;
     }
 
-    // 检查文件结束状态
-    if (!feof(fp))
+    // 第1版文件在重放日志后转换为当前格式
+    legacy_loaded = !current;
+    flights_unmap();
+    // printf("成功加载 %zu 条航班数据\n", count);
+    return 0;
+}
+
+/**
+ * @brief 从二进制文件加载航班数据到链表
+ *
+ * 第1版（无文件头的LegacyFlight）文件照常加载，由list()在重放日志后转换为当前格式。
+ *
+ * @return int 成功返回0，失败返回-1
+ */
+int load_flights_from_file()
+{
+    if (flights_map(flightS_FILE) != SUCCESS)
+        return FAILURE;
+    return flights_materialize();
+}
+
+/**
+ * @brief 检查点之后裁剪修改日志：只保留上一个检查点之后的记录
+ *
+ * journal_covered之前的记录已包含在上一个检查点（FLIGHTS_PREV_FILE）中，可以丢弃；
+ * 之后的记录保留，上一个检查点加上日志即可恢复出当前数据（重放可重复执行）。
+ * 先写临时文件并fsync，再rename覆盖日志。调用者持有journal_lock。
+ *
+ * @return int 成功返回SUCCESS，失败返回FAILURE（日志保持不变）
+ */
+static int journal_trim()
+{
+    if (journal_fd >= 0)
+    {
+        close(journal_fd);
+        journal_fd = -1;
+    }
+    int fd = open(JOURNAL_FILE, O_RDONLY);
+    if (fd < 0)
+    {
+        journal_covered = 0;
+        if (errno == ENOENT)
+            return SUCCESS;
+        perror("无法打开航班日志");
+        return FAILURE;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        perror("读取航班日志信息失败");
+        close(fd);
+        return FAILURE;
+    }
+
+    // 不知道哪些记录已在上一个检查点中时全部保留
+    off_t keep = journal_covered > (off_t)sizeof(FileHeader) && journal_covered <= st.st_size
+                     ? journal_covered
+                     : (off_t)sizeof(FileHeader);
+    if (keep == (off_t)sizeof(FileHeader) || st.st_size <= (off_t)sizeof(FileHeader))
     {
-        perror("读取航班数据文件时出错");
-        fclose(fp);
-        return -1;
+        close(fd);
+        journal_covered = st.st_size;
+        return SUCCESS;
     }
 
-    fclose(fp);
-    // printf("成功加载 %d 条航班数据\n", count);
-    return 0;
+    int out = open(JOURNAL_TEMP_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int ok = out >= 0 && header_write(out, JOURNAL_FILE_MAGIC, sizeof(JournalDisk), 0, 0) == SUCCESS;
+    off_t pos = keep, end = sizeof(FileHeader);
+    while (ok && pos < st.st_size)
+    {
+        char buf[64 * sizeof(JournalDisk)];
+        ssize_t n = pread(fd, buf, sizeof(buf), pos);
+        ok = n > 0 && pwrite(out, buf, n, end) == n;
+        pos += n;
+        end += n;
+    }
+    close(fd);
+    if (!ok || fsync(out) != 0 || rename(JOURNAL_TEMP_FILE, JOURNAL_FILE) != 0)
+    {
+        perror("裁剪航班日志失败");
+        if (out >= 0)
+            close(out);
+        unlink(JOURNAL_TEMP_FILE);
+        return FAILURE;
+    }
+    close(out);
+    journal_covered = end;
+    return SUCCESS;
 }
 
 /**
- * @brief 将航班链表数据保存到二进制文件
+ * @brief 将航班链表数据保存到二进制文件（检查点）
+ *
+ * 先完整写入临时文件（文件头含记录数和全部记录及座位图的CRC）并fsync，
+ * 再rename覆盖正式文件，任何时刻崩溃都只会留下旧文件或新文件之一。
+ * 覆盖前把原文件硬链接为FLIGHTS_PREV_FILE，修改日志只裁掉上一个检查点之前的记录，
+ * 新检查点损坏时可由上一个检查点和日志恢复。
  *
  * @return int 成功返回0，失败返回-1
  */
 int save_flights_to_file()
 {
-    // 检查链表有效性
-    if (List == NULL)
+    // 检查链表有效性（数据文件无法加载时保留原文件）
+    if (List == NULL || load_failed)
     {
         fprintf(stderr, "错误：航班链表未初始化\n");
         return -1;
     }
 
-    // 打开二进制文件
-    FILE *fp = fopen("data/flights.txt", "wb");
+    // 写入临时文件
+    FILE *fp = fopen(FLIGHTS_TEMP_FILE, "wb");
     if (fp == NULL)
     {
         perror("无法打开航班数据文件");
         return -1;
     }
 
+    // 先占位文件头，写完记录后再填写记录数和CRC
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    if (fwrite(&header, sizeof(header), 1, fp) != 1)
+    {
+        perror("写入航班数据失败");
+        fclose(fp);
+        unlink(FLIGHTS_TEMP_FILE);
+        return -1;
+    }
+
     // 遍历链表并写入数据
     FlightNode *current = List->next; // 跳过头节点
-    int count = 0;
+    uint64_t count = 0;
+    uint32_t crc = 0;
 
     while (current != NULL)
     {
-        // 写入当前航班数据
-        size_t written = fwrite(&current->flight, sizeof(Flight_n), 1, fp);
+        // 写入当前航班数据及解析后的时间
+        FlightDisk record;
+        flight_to_disk(&current->flight, current->departure_minutes, current->arrival_minutes, &record);
+        crc = crc32_update(crc, &record, sizeof(record));
+        size_t written = fwrite(&record, sizeof(record), 1, fp);
 
         if (written != 1)
         {
             perror("写入航班数据失败");
             fclose(fp);
+            unlink(FLIGHTS_TEMP_FILE);
             return -1;
         }
 
@@ -169,174 +439,716 @@ int save_flights_to_file()
         count++;
     }
 
-    fclose(fp);
-    printf("成功保存 %d 条航班数据到文件\n", count);
+    // 记录之后按相同顺序写入各航班的座位图
+    for (current = List->next; current != NULL; current = current->next)
+    {
+        unsigned char bytes[(FLIGHT_CAPACITY_MAX + 7) / 8];
+        size_t n = seatmap_bytes(current->flight.capacity);
+        seatmap_store(current, bytes);
+        crc = crc32_update(crc, bytes, n);
+        if (fwrite(bytes, 1, n, fp) != n)
+        {
+            perror("写入航班数据失败");
+            fclose(fp);
+            unlink(FLIGHTS_TEMP_FILE);
+            return -1;
+        }
+    }
+
+    // 填写文件头，数据落盘后再替换正式文件
+    header_init(&header, FLIGHTS_FILE_MAGIC, sizeof(FlightDisk), count, crc);
+    if (fseek(fp, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, fp) != 1 ||
+        fflush(fp) != 0 || fsync(fileno(fp)) != 0)
+    {
+        perror("写入航班数据失败");
+        fclose(fp);
+        unlink(FLIGHTS_TEMP_FILE);
+        return -1;
+    }
+    if (fclose(fp) != 0)
+    {
+        perror("写入航班数据失败");
+        unlink(FLIGHTS_TEMP_FILE);
+        return -1;
+    }
+    // 保留上一个检查点（原文件不存在时保留已有的FLIGHTS_PREV_FILE）
+    if (access(flightS_FILE, F_OK) == 0 &&
+        ((unlink(FLIGHTS_PREV_FILE) != 0 && errno != ENOENT) || link(flightS_FILE, FLIGHTS_PREV_FILE) != 0))
+        perror("保留上一个检查点失败");
+    if (rename(FLIGHTS_TEMP_FILE, flightS_FILE) != 0)
+    {
+        perror("替换航班数据文件失败");
+        unlink(FLIGHTS_TEMP_FILE);
+        return -1;
+    }
+
+    // 检查点已包含日志中的全部修改，日志只需保留上一个检查点之后的部分
+    journal_trim();
+    journal_entries = 0;
+    legacy_loaded = 0;
+    // printf("成功保存 %d 条航班数据到文件\n", count);
     return 0;
 }
 
 /**
- * @brief 初始化航班链表（优先从二进制文件加载，失败则从CSV初始化）
+ * @brief 追加一条航班日志记录（调用者持有journal_lock）
  *
- * @return int 成功返回SUCCESS(0)
+ * @param op 操作
+ * @param number 航班号
+ * @param seat 座位号（seat_op为0时不使用）
+ * @param seat_op 座位操作（0为没有）
+ * @return int 同journal_flight()
  */
-int list()
+static int journal_append(int op, const char *number, int seat, int seat_op)
 {
-    // 尝试加载二进制文件
-    if (load_flights_from_file() == SUCCESS)
+    JournalDisk entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.op = op;
+    strncpy(entry.number, number, sizeof(entry.number) - 1);
+    entry.seat = (int16_t)seat;
+    entry.seat_op = (uint8_t)seat_op;
+    if (op == JOURNAL_PUT)
     {
-        return SUCCESS;
+        FlightNode *node = index_find(entry.number);
+        if (node == NULL)
+            return ERR_NOT_FOUND;
+        flight_to_disk(&node->flight, node->departure_minutes, node->arrival_minutes, &entry.flight);
     }
+    entry.crc = record_crc(&entry, sizeof(entry), offsetof(JournalDisk, crc));
 
-    // 尝试从CSV文件初始化
-    if (load_flights_from_csv("data/init_flights.csv") == SUCCESS)
+    if (journal_fd < 0)
     {
-        // printf("从CSV文件初始化航班数据\n");
-        save_flights_to_file(); // 保存为二进制格式
-        return SUCCESS;
+        journal_fd = open(JOURNAL_FILE, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (journal_fd < 0)
+        {
+            perror("无法打开航班日志");
+            return FAILURE;
+        }
+        // 空日志先写文件头（日志记录数以各记录CRC为准，文件头记录数为0）
+        struct stat st;
+        if (fstat(journal_fd, &st) == 0 && st.st_size == 0)
+        {
+            FileHeader header;
+            header_init(&header, JOURNAL_FILE_MAGIC, sizeof(JournalDisk), 0, 0);
+            if (write(journal_fd, &header, sizeof(header)) != (ssize_t)sizeof(header))
+            {
+                perror("写入航班日志失败");
+                return FAILURE;
+            }
+        }
     }
+    if (write(journal_fd, &entry, sizeof(entry)) != (ssize_t)sizeof(entry) || fdatasync(journal_fd) != 0)
+    {
+        perror("写入航班日志失败");
+        return FAILURE;
+    }
+    journal_entries++;
     return SUCCESS;
 }
 
 /**
- * @brief 创建链表头节点
+ * @brief 记录一次航班修改到日志
  *
- * @return FlightNode* 成功返回头节点指针，失败返回NULL
+ * 只追加一条带CRC的定长记录并fdatasync，耗时与航班总数无关
+ * （新日志文件先写文件头）；记录数达到JOURNAL_CHECKPOINT_LIMIT时做一次检查点。
+ * 检查点读取全部航班的座位库存和座位图，调用者须持有航班目录独占锁。
+ *
+ * @param op 操作（JOURNAL_PUT：新增或修改，JOURNAL_DELETE：删除）
+ * @param number 航班号（JOURNAL_PUT时须已在主链表中）
+ * @return int 成功返回SUCCESS，未找到航班返回ERR_NOT_FOUND，失败返回FAILURE
  */
-FlightNode *createHead()
+int journal_flight(int op, const char *number)
 {
-    FlightNode *head = (FlightNode *)malloc(sizeof(FlightNode));
-    if (head == NULL)
-    {
-        perror("head malloc");
-        return NULL;
-    }
-    memset(head, 0, sizeof(FlightNode)); // 初始化内存
-    head->prev = head->next = NULL;      // 设置前后指针
-    return head;
+    pthread_mutex_lock(&journal_lock);
+    int ret = journal_append(op, number, SEAT_NONE, 0);
+    if (ret == SUCCESS && journal_entries >= JOURNAL_CHECKPOINT_LIMIT)
+        ret = save_flights_to_file() ? FAILURE : SUCCESS;
+    pthread_mutex_unlock(&journal_lock);
+    return ret;
 }
 
 /**
- * @brief 创建新航班节点
+ * @brief 记录一次座位分配或释放到日志
  *
- * @param fn 航班数据指针
- * @return FlightNode* 成功返回节点指针，失败返回NULL
+ * 与航班的座位库存一起写成一条JOURNAL_PUT记录，调用者持有航班目录共享锁和该航班的订票锁。
+ * 其他航班的座位图此时可能正在修改，这里不做检查点：记录数达到阈值后，
+ * 订票线程释放锁再经journal_full()判断、在独占锁内调用checkpoint_flights()。
+ *
+ * @param number 航班号（须已在主链表中）
+ * @param seat 座位号（seat_op为0时不使用）
+ * @param seat_op 座位操作（JOURNAL_SEAT_TAKE/JOURNAL_SEAT_RELEASE，0为只记录座位库存）
+ * @return int 成功返回SUCCESS，未找到航班返回ERR_NOT_FOUND，失败返回FAILURE
  */
-FlightNode *createNode(Flight_n *fn)
+int journal_seat(const char *number, int seat, int seat_op)
 {
-    FlightNode *node = (FlightNode *)malloc(sizeof(FlightNode));
-    if (node == NULL)
-    {
-        perror("node malloc");
-        return NULL;
-    }
-    memcpy(&node->flight, fn, sizeof(Flight_n)); // 复制航班数据
-    node->prev = node->next = NULL;              // 初始化指针
-    return node;
+    pthread_mutex_lock(&journal_lock);
+    int ret = journal_append(JOURNAL_PUT, number, seat, seat_op);
+    pthread_mutex_unlock(&journal_lock);
+    return ret;
 }
 
 /**
- * @brief 检查链表是否为空
+ * @brief 日志记录数是否已达到检查点阈值
  *
- * @param h 链表头节点
- * @return int 空链表返回ERR_EMPTY，无效链表返回FAILURE，成功返回SUCCESS
+ * @return int 达到JOURNAL_CHECKPOINT_LIMIT返回1，否则返回0
  */
-int isnempty(FlightNode *h)
+int journal_full()
 {
-    if (h == NULL)
-    {
-        return FAILURE;
-    }
-    if (h->next == NULL)
-    {
-        return ERR_EMPTY;
-    }
-    return SUCCESS;
+    pthread_mutex_lock(&journal_lock);
+    int full = journal_entries >= JOURNAL_CHECKPOINT_LIMIT;
+    pthread_mutex_unlock(&journal_lock);
+    return full;
 }
 
 /**
- * @brief 尾插法插入航班节点
+ * @brief 有未写入检查点的修改时做一次检查点
  *
- * @param h 链表头节点
- * @param fn 航班数据指针
  * @return int 成功返回SUCCESS，失败返回FAILURE
  */
-int tail_insert(FlightNode *h, Flight_n *fn)
+int checkpoint_flights()
 {
-    if (h == NULL)
-    {
-        return FAILURE;
-    }
-    FlightNode *p = h;
-    // 定位到链表尾部
-    while (p->next)
-    {
-        p = p->next;
-    }
-    // 创建新节点并插入
-    FlightNode *node = createNode(fn);
-    p->next = node;
-    node->prev = p;
-    node->next = NULL;
-    return SUCCESS;
+    pthread_mutex_lock(&journal_lock);
+    int ret = SUCCESS;
+    if (journal_entries > 0 || legacy_loaded)
+        ret = save_flights_to_file() ? FAILURE : SUCCESS;
+    pthread_mutex_unlock(&journal_lock);
+    return ret;
 }
 
 /**
- * @brief 显示所有航班信息
+ * @brief 按日志记录新增或覆盖航班（重放可重复执行）
  *
- * @param h 链表头节点
- * @return int 状态码（成功/失败）
+ * @param flight 航班数据
+ * @param dep 出发时间（分钟）
+ * @param arr 到达时间（分钟）
+ * @return int 成功返回SUCCESS，失败返回FAILURE
  */
-int display_all(FlightNode *h)
+static int journal_put(Flight_n *flight, short dep, short arr)
 {
-    if (isnempty(h) != SUCCESS)
-        return isnempty(h);
-    FlightNode *p = h->next;
-    // 打印表头
-    printf("航班号     航空公司      出发时间    到达时间    出发机场    到达机场    航班状态      机票价格\n");
-    // 遍历打印所有航班
-    while (p)
+    FlightNode *node = index_find(flight->number);
+    if (node == NULL)
+        return tail_insert_times(List, flight, dep, arr);
+
+    // 已存在则原地覆盖，保持链表位置和座位图
+    if (seatmap_resize(node, flight->capacity) != SUCCESS)
     {
-        printf("%-11s%-19s%-12s%-12s%-14s%-14s%-15s%-.2f\n",
-               p->flight.number,
-               p->flight.airline,
-               p->flight.departure_time,
-               p->flight.arrival_time,
-               p->flight.departure_airport,
-               p->flight.arrival_airport,
-               p->flight.status,
-               p->flight.price);
-        p = p->next;
+        fprintf(stderr, "航班%s的座位图与新座位数不符，已清空\n", flight->number);
+        seatmap_free(node);
     }
-    return SUCCESS;
+    index_remove(node);
+    node->flight = *flight;
+    node->departure_minutes = dep;
+    node->arrival_minutes = arr;
+    int ret = index_insert(node);
+    if (ret != SUCCESS)
+        fprintf(stderr, "航班%s重新加入索引失败\n", flight->number);
+    catalog_touch();
+    list_generation++;
+    return ret;
 }
 
 /**
- * @brief 根据航班号获取节点位置
+ * @brief 读取下一条日志记录
  *
- * @param h 链表头节点
- * @param number 航班号
- * @return FlightNode* 找到返回节点指针，未找到返回NULL
+ * @param fd 日志文件
+ * @param op 输出：操作
+ * @param flight 输出：航班数据（number总是有效）
+ * @param dep 输出：出发时间（分钟）
+ * @param arr 输出：到达时间（分钟）
+ * @param seat 输出：座位号
+ * @param seat_op 输出：座位操作
+ * @return int 读到有效记录返回SUCCESS，结束或记录无效返回FAILURE
  */
-FlightNode *get_pos(FlightNode *h, char *number)
+static int journal_next(int fd, int *op, Flight_n *flight, short *dep, short *arr, int *seat, int *seat_op)
 {
-    if (isnempty(h) != SUCCESS)
-        return NULL;
-    FlightNode *p = h->next;
+    JournalDisk entry;
+    if (read(fd, &entry, sizeof(entry)) != (ssize_t)sizeof(entry) ||
+        entry.crc != record_crc(&entry, sizeof(entry), offsetof(JournalDisk, crc)))
+        return FAILURE;
+    *op = entry.op;
+    flight_from_disk(&entry.flight, flight, dep, arr);
+    memcpy(flight->number, entry.number, sizeof(flight->number));
+    flight->number[sizeof(flight->number) - 1] = '\0';
+    *seat = entry.seat;
+    *seat_op = entry.seat_op;
+    return (*op == JOURNAL_PUT || *op == JOURNAL_DELETE) ? SUCCESS : FAILURE;
+}
 
-    // 遍历查找航班号
-    while (p)
+/**
+ * @brief 将修改日志重放到主链表
+ *
+ * 新增/修改按航班号覆盖，删除不存在的航班直接跳过，
+ * 因此检查点之后、清空日志之前崩溃也能正确重放。
+ * 末尾写了一半或校验失败的记录被截掉。
+ *
+ * @return int 重放的记录数，失败返回FAILURE
+ */
+static int replay_journal()
+{
+    int fd = open(JOURNAL_FILE, O_RDWR);
+    if (fd < 0)
+        return 0; // 没有日志
+
+    // 校验文件头；文件头不完整说明创建日志时崩溃，还没有记录，下面截为空文件
+    FileHeader header;
+    off_t valid = 0;
+    if (read(fd, &header, sizeof(header)) == (ssize_t)sizeof(header))
     {
-        if (!strcmp(p->flight.number, number))
+        if (header_check(&header, JOURNAL_FILE_MAGIC, sizeof(JournalDisk)) != SUCCESS)
         {
-            break;
+            // 不认识的日志不重放也不覆盖，改名保留后从空日志开始
+            fprintf(stderr, "航班日志文件头无效（版本、字节序或校验不符），已改名为%s\n", JOURNAL_CORRUPT_FILE);
+            close(fd);
+            if (rename(JOURNAL_FILE, JOURNAL_CORRUPT_FILE) != 0)
+                perror("保留航班日志失败");
+            return FAILURE;
         }
-        p = p->next;
+        valid = sizeof(header);
     }
-    return p;
+    lseek(fd, valid, SEEK_SET);
+
+    int op, seat, seat_op, applied = 0;
+    Flight_n flight;
+    short dep, arr;
+    while (journal_next(fd, &op, &flight, &dep, &arr, &seat, &seat_op) == SUCCESS)
+    {
+        if (op == JOURNAL_PUT)
+        {
+            journal_put(&flight, dep, arr);
+            FlightNode *node = seat_op ? index_find(flight.number) : NULL;
+            if (node != NULL && seat_op == JOURNAL_SEAT_TAKE)
+                seat_take(node, seat);
+            else if (node != NULL && seat_op == JOURNAL_SEAT_RELEASE)
+                seat_release(node, seat);
+        }
+        else if (index_find(flight.number))
+            delete_flight(List, flight.number);
+        applied++;
+        valid += sizeof(JournalDisk);
+    }
+
+    // 丢弃残缺的末尾，保证后续追加对齐
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size != valid)
+    {
+        fprintf(stderr, "航班日志末尾有残缺记录，已忽略\n");
+        if (ftruncate(fd, valid) != 0)
+            perror("截断航班日志失败");
+    }
+    close(fd);
+    journal_entries = applied;
+    return applied;
 }
 
 /**
- * @brief 删除指定航班
+ * @brief 从CSV初始化航班数据，然后重放修改日志并保存
+ *
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int list_from_csv()
+{
+    if (load_flights_from_csv("data/init_flights.csv") != SUCCESS)
+        return FAILURE;
+    // printf("从CSV文件初始化航班数据\n");
+    replay_journal();
+    order_count_seats();    // CSV没有已售座位数，按现有订单统计
+    save_flights_to_file(); // 保存为二进制格式
+    return SUCCESS;
+}
+
+/**
+ * @brief 航班数据文件不存在或无法加载时恢复航班数据
+ *
+ * 无法加载的数据文件先改名为FLIGHTS_CORRUPT_FILE保留，不在原处覆盖；
+ * 然后由上一个检查点重放修改日志并重新做检查点。没有可用的上一个检查点时，
+ * 数据文件不存在则从CSV初始化，否则加载失败。
+ *
+ * @param missing 数据文件不存在（1）或无法加载（0）
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int list_recover(int missing)
+{
+    if (!missing)
+    {
+        if (rename(flightS_FILE, FLIGHTS_CORRUPT_FILE) != 0)
+        {
+            perror("保留航班数据文件失败");
+            load_failed = 1;
+            return FAILURE;
+        }
+        fprintf(stderr, "航班数据文件无法加载，已改名为%s\n", FLIGHTS_CORRUPT_FILE);
+    }
+
+    if (flights_map(FLIGHTS_PREV_FILE) == SUCCESS && flights_materialize() == SUCCESS)
+    {
+        int legacy = legacy_loaded;
+        fprintf(stderr, "由上一个检查点%s和航班日志恢复航班数据\n", FLIGHTS_PREV_FILE);
+        replay_journal();
+        if (legacy)
+            order_count_seats(); // 第1版数据没有已售座位数，按现有订单统计
+        save_flights_to_file();
+        return SUCCESS;
+    }
+    if (missing)
+    {
+        // 尝试从CSV文件初始化
+        list_from_csv();
+        return SUCCESS;
+    }
+    load_failed = 1;
+    fprintf(stderr, "没有可用的上一个检查点，航班数据未加载；请从%s或备份恢复后重新启动\n", FLIGHTS_CORRUPT_FILE);
+    return FAILURE;
+}
+
+/**
+ * @brief 初始化航班链表（优先从二进制文件加载，然后重放修改日志）
+ *
+ * 当前版本的数据文件只做只读映射并校验文件头，主链表和索引推迟到
+ * 第一次查询、修改航班或显示订单时由list_ensure()建立，只查看余额或订单报表时
+ * 启动耗时和内存与航班数无关。第1版文件需要转换，仍立即加载。
+ * 数据文件不存在或无法加载时由list_recover()恢复，只有数据文件不存在时才从CSV初始化。
+ *
+ * @return int 成功返回SUCCESS(0)，航班数据无法加载返回FAILURE
+ */
+int list()
+{
+    int ret = flights_map(flightS_FILE);
+    if (ret == SUCCESS && mapped_version == RECORD_VERSION)
+    {
+        deferred = 1;
+        return SUCCESS;
+    }
+    // 第1版文件：加载并重放修改日志，再转换为当前格式
+    if (ret == SUCCESS && flights_materialize() == SUCCESS)
+    {
+        replay_journal();
+        order_count_seats(); // 第1版数据没有已售座位数，按现有订单统计
+        save_flights_to_file();
+        return SUCCESS;
+    }
+    return list_recover(ret == ERR_NOT_FOUND);
+}
+
+/**
+ * @brief 确保主链表已建立（从映射的数据文件建立并重放修改日志）
+ *
+ * 所有访问List、航班索引或航线图的操作之前调用；已建立时直接返回。
+ * 数据文件的记录校验失败时由list_recover()恢复，恢复失败后的调用都返回FAILURE。
+ *
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+int list_ensure()
+{
+    if (load_failed)
+        return FAILURE;
+    if (!deferred)
+        return SUCCESS;
+    deferred = 0;
+    if (flights_materialize() != SUCCESS)
+        return list_recover(0);
+    replay_journal();
+    return SUCCESS;
+}
+
+/**
+ * @brief 航班数（主链表尚未建立时为映射文件中的记录数）
+ *
+ * @return int 航班数
+ */
+int flight_count()
+{
+    return deferred ? (int)mapped_count : catalog_count();
+}
+
+/**
+ * @brief 遍历全部航班（主链表尚未建立时先建立）
+ *
+ * 按目录槽位顺序遍历，调用者不能在回调中修改航班目录。
+ *
+ * @param visit 回调，返回非SUCCESS时停止遍历
+ * @param arg 回调参数
+ * @return int 遍历完成返回SUCCESS，否则返回回调的返回值
+ */
+int flights_scan(FlightVisitor visit, void *arg)
+{
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
+    int ret = SUCCESS;
+    for (FlightHandle h = catalog_first(); h != INVALID_HANDLE && ret == SUCCESS; h = catalog_next(h))
+        ret = visit(catalog_node(h), arg);
+    return ret;
+}
+
+/**
+ * @brief 按航班号复制航班及其座位图（只读查询）
+ *
+ * 主链表尚未建立时先建立；副本用完后调用seatmap_free()释放座位图。
+ *
+ * @param number 航班号
+ * @param copy 输出：航班副本
+ * @return int 成功返回SUCCESS，航班不存在返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+int flight_snapshot(const char *number, FlightNode *copy)
+{
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
+    catalog_lock_shared();
+    FlightNode *node = index_find(number);
+    int ret = ERR_NOT_FOUND;
+    if (node != NULL)
+    {
+        unsigned char bytes[(FLIGHT_CAPACITY_MAX + 7) / 8];
+        *copy = *node;
+        copy->seats = NULL;
+        copy->prev = copy->next = NULL;
+        copy->handle = INVALID_HANDLE;
+        seatmap_store(node, bytes);
+        ret = seatmap_load(copy, bytes);
+    }
+    catalog_unlock();
+    return ret;
+}
+
+/**
+ * @brief 创建链表头节点（从节点池分配）
+ *
+ * @return FlightNode* 成功返回头节点指针，失败返回NULL
+ */
+FlightNode *createHead()
+{
+    FlightNode *head = node_pool_alloc();
+    if (head == NULL)
+        return NULL;
+    memset(head, 0, sizeof(FlightNode)); // 初始化内存
+    head->prev = head->next = NULL;      // 设置前后指针
+    head->handle = INVALID_HANDLE;       // 头节点不在目录中
+    return head;
+}
+
+/**
+ * @brief 创建新航班节点（从节点池分配）
+ *
+ * @param fn 航班数据指针
+ * @return FlightNode* 成功返回节点指针，失败返回NULL
+ */
+FlightNode *createNode(Flight_n *fn)
+{
+    FlightNode *node = node_pool_alloc();
+    if (node == NULL)
+        return NULL;
+    memcpy(&node->flight, fn, sizeof(Flight_n)); // 复制航班数据
+    node->departure_minutes = TIME_INVALID;      // 时间由调用者设置
+    node->arrival_minutes = TIME_INVALID;
+    node->prev = node->next = NULL;              // 初始化指针
+    node->seats = NULL;                          // 座位图只属于主链表节点
+    node->handle = INVALID_HANDLE;               // 不属于航班目录的节点
+    return node;
+}
+
+/**
+ * @brief 检查链表是否为空
+ *
+ * @param h 链表头节点
+ * @return int 空链表返回ERR_EMPTY，无效链表返回FAILURE，成功返回SUCCESS
+ */
+int isnempty(FlightNode *h)
+{
+    if (h == NULL)
+    {
+        return FAILURE;
+    }
+    if (h->next == NULL)
+    {
+        return ERR_EMPTY;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 尾插法插入航班节点
+ *
+ * 从航班数据的时间字符串解析出发/到达分钟数（无法解析时记为TIME_INVALID）。
+ *
+ * @param h 链表头节点
+ * @param fn 航班数据指针
+ * @return int 成功返回SUCCESS，主链表中航班号重复返回ERR_EXISTS，失败返回FAILURE
+ */
+int tail_insert(FlightNode *h, Flight_n *fn)
+{
+    short dep, arr;
+    if (parse_time(fn->departure_time, &dep) != SUCCESS)
+        dep = TIME_INVALID;
+    if (parse_time(fn->arrival_time, &arr) != SUCCESS)
+        arr = TIME_INVALID;
+    return tail_insert_times(h, fn, dep, arr);
+}
+
+/**
+ * @brief 尾插法插入已解析时间的航班节点
+ *
+ * 头节点的prev指针记录尾节点（空链表为NULL），插入为O(1)。
+ *
+ * @param h 链表头节点
+ * @param fn 航班数据指针
+ * @param dep 出发时间（分钟）
+ * @param arr 到达时间（分钟）
+ * @return int 成功返回SUCCESS，主链表中航班号重复返回ERR_EXISTS，失败返回FAILURE
+ */
+int tail_insert_times(FlightNode *h, Flight_n *fn, short dep, short arr)
+{
+    if (h == NULL)
+    {
+        return FAILURE;
+    }
+    // 从记录的尾节点定位到链表尾部
+    FlightNode *p = h->prev ? h->prev : h;
+    while (p->next)
+    {
+        p = p->next;
+    }
+    // 创建新节点并插入（主链表节点分配在航班目录中）
+    FlightNode *node = (h == List) ? catalog_alloc(fn) : createNode(fn);
+    if (node == NULL)
+        return FAILURE;
+    node->departure_minutes = dep;
+    node->arrival_minutes = arr;
+
+    // 主链表同步维护索引，航班号重复或索引失败时不插入
+    if (h == List)
+    {
+        int ret = index_insert(node);
+        if (ret != SUCCESS)
+        {
+            catalog_release(node);
+            return ret;
+        }
+    }
+    p->next = node;
+    node->prev = p;
+    node->next = NULL;
+    h->prev = node; // 更新尾节点
+    list_generation++;
+    return SUCCESS;
+}
+
+/**
+ * @brief 打印航班信息表头
+ *
+ * @param orders 是否为订单（最后一列为座位号）
+ */
+static void print_flight_header(int orders)
+{
+    printf("航班号     航空公司      出发时间    到达时间    出发机场    到达机场    航班状态      机票价格      %s\n",
+           orders ? "座位号" : "余座/座位");
+}
+
+/**
+ * @brief 打印一条航班信息
+ *
+ * @param f 航班数据指针
+ * @param orders 是否为订单（最后一列为座位号）
+ */
+static void print_flight(const Flight_n *f, int orders)
+{
+    char price[MONEY_TEXT_MAX];
+    if (orders)
+    {
+        char seat[SEAT_LABEL_MAX];
+        printf("%-11s%-19s%-12s%-12s%-14s%-14s%-15s%-14s%s\n",
+               f->number,
+               dict_name(DICT_AIRLINE, f->airline),
+               f->departure_time,
+               f->arrival_time,
+               dict_name(DICT_AIRPORT, f->departure_airport),
+               dict_name(DICT_AIRPORT, f->arrival_airport),
+               status_name(f->status),
+               money_format(f->price, price),
+               seat_label(f, f->seat, seat));
+        return;
+    }
+    printf("%-11s%-19s%-12s%-12s%-14s%-14s%-15s%-14s%d/%d\n",
+           f->number,
+           dict_name(DICT_AIRLINE, f->airline),
+           f->departure_time,
+           f->arrival_time,
+           dict_name(DICT_AIRPORT, f->departure_airport),
+           dict_name(DICT_AIRPORT, f->arrival_airport),
+           status_name(f->status),
+           money_format(f->price, price),
+           seats_available(f),
+           f->capacity);
+}
+
+/**
+ * @brief 显示所有航班信息
+ *
+ * @param h 链表头节点
+ * @return int 状态码（成功/失败）
+ */
+int display_all(FlightNode *h)
+{
+    if (isnempty(h) != SUCCESS)
+        return isnempty(h);
+    FlightNode *p = h->next;
+    // 打印表头
+    print_flight_header(0);
+    // 遍历打印所有航班
+    while (p)
+    {
+        print_flight(&p->flight, 0);
+        p = p->next;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 显示订单链表（最后一列为座位号）
+ *
+ * @param h 订单链表头节点
+ * @return int 状态码（成功/失败）
+ */
+int display_orders(FlightNode *h)
+{
+    if (isnempty(h) != SUCCESS)
+        return isnempty(h);
+    print_flight_header(1);
+    for (FlightNode *p = h->next; p; p = p->next)
+        print_flight(&p->flight, 1);
+    return SUCCESS;
+}
+
+/**
+ * @brief 根据航班号获取节点位置
+ *
+ * @param h 链表头节点
+ * @param number 航班号
+ * @return FlightNode* 找到返回节点指针，未找到返回NULL
+ */
+FlightNode *get_pos(FlightNode *h, char *number)
+{
+    if (isnempty(h) != SUCCESS)
+        return NULL;
+
+    // 主链表走哈希索引
+    if (h == List)
+        return index_find(number);
+
+    FlightNode *p = h->next;
+
+    // 遍历查找航班号
+    while (p)
+    {
+        if (!strcmp(p->flight.number, number))
+        {
+            break;
+        }
+        p = p->next;
+    }
+    return p;
+}
+
+/**
+ * @brief 删除指定航班
  *
  * @param h 链表头节点
  * @param number 航班号
@@ -346,94 +1158,908 @@ int delete_flight(FlightNode *h, char *number)
 {
     if (isnempty(h) != SUCCESS)
         return FAILURE;
-    FlightNode *p = get_pos(h, number);
-    if (p == NULL)
+    FlightNode *p = get_pos(h, number);
+    if (p == NULL)
+        return FAILURE;
+    if (h == List)
+        index_remove(p);
+    // 调整链表指针
+    p->prev->next = p->next;
+    if (p->next != NULL)
+        p->next->prev = p->prev;
+    else
+        h->prev = (p->prev == h) ? NULL : p->prev; // 删除的是尾节点
+    list_generation++;
+    // 释放节点内存（目录节点归还槽位，其余归还节点池）
+    if (p->handle != INVALID_HANDLE)
+        catalog_release(p);
+    else
+        node_pool_free(p);
+    p = NULL;
+    return SUCCESS;
+}
+
+/**
+ * @brief 修改航班信息
+ *
+ * @param h 链表头节点
+ * @param number 航班号
+ * @param change_n 修改项编号
+ * @param change_message 修改内容
+ * @return int 状态码
+ */
+int change_node(FlightNode *h, char *number, char change_n, char *change_message)
+{
+    if (isnempty(h) != SUCCESS)
+        return FAILURE;
+
+    FlightNode *p = get_pos(h, number);
+    if (p == NULL)
+        return ERR_NOT_FOUND;
+
+    // 主链表节点的航线可能改变，修改期间先移出索引
+    if (h == List)
+    {
+        index_remove(p);
+        catalog_touch();
+    }
+    list_generation++;
+    int ret = SUCCESS;
+    // 根据选项修改不同字段
+    DictId id;
+    FlightStatus status;
+    switch (change_n)
+    {
+    case '1': // 航空公司
+        if ((id = dict_intern(DICT_AIRLINE, change_message)) == DICT_NONE)
+        {
+            ret = ERR_INVALID_INPUT;
+            break;
+        }
+        p->flight.airline = id;
+        break;
+    case '2': // 出发时间
+        if (parse_time(change_message, &p->departure_minutes) != SUCCESS)
+        {
+            fprintf(stderr, "时间格式错误！\n");
+            ret = ERR_INVALID_INPUT;
+            break;
+        }
+        strcpy(p->flight.departure_time, change_message);
+        break;
+    case '3': // 到达时间
+        if (parse_time(change_message, &p->arrival_minutes) != SUCCESS)
+        {
+            fprintf(stderr, "时间格式错误！\n");
+            ret = ERR_INVALID_INPUT;
+            break;
+        }
+        strcpy(p->flight.arrival_time, change_message);
+        break;
+    case '4': // 出发机场
+    case '5': // 到达机场
+        if ((id = dict_intern(DICT_AIRPORT, change_message)) == DICT_NONE)
+        {
+            ret = ERR_INVALID_INPUT;
+            break;
+        }
+        if (change_n == '4')
+            p->flight.departure_airport = id;
+        else
+            p->flight.arrival_airport = id;
+        break;
+    case '6': // 航班状态
+        if (status_parse(change_message, &status) != SUCCESS)
+        {
+            fprintf(stderr, "航班状态须为准点、延误或取消！\n");
+            ret = ERR_INVALID_INPUT;
+            break;
+        }
+        p->flight.status = status;
+        break;
+    case '7': // 机票价格
+        if (money_parse(change_message, &p->flight.price) != SUCCESS)
+        {
+            fprintf(stderr, "价格格式错误！\n");
+            ret = ERR_INVALID_INPUT;
+        }
+        break;
+    case '8': // 座位数（不能少于已售和暂占的座位，已分配的座位须仍在座位数以内）
+    {
+        char *end;
+        long capacity = strtol(change_message, &end, 10);
+        if (end == change_message || *end != '\0' || capacity < 1 || capacity > FLIGHT_CAPACITY_MAX ||
+            capacity < p->flight.sold + p->flight.held || capacity <= seat_last_taken(p))
+        {
+            fprintf(stderr, "座位数须为%d至%d之间且不少于已售座位数！\n", 1, FLIGHT_CAPACITY_MAX);
+            ret = ERR_INVALID_INPUT;
+            break;
+        }
+        if ((ret = seatmap_resize(p, (int)capacity)) != SUCCESS)
+            break;
+        p->flight.capacity = (int)capacity;
+        break;
+    }
+    case '9': // 每排座位数（已分配座位的航班不能修改布局）
+    {
+        char *end;
+        long per_row = strtol(change_message, &end, 10);
+        if (end == change_message || *end != '\0' || per_row < 1 || per_row > SEAT_ROW_MAX)
+        {
+            fprintf(stderr, "每排座位数须为%d至%d之间！\n", 1, SEAT_ROW_MAX);
+            ret = ERR_INVALID_INPUT;
+            break;
+        }
+        if (seat_taken_count(p) > 0)
+        {
+            fprintf(stderr, "航班已有分配的座位，不能修改每排座位数！\n");
+            ret = ERR_INVALID_INPUT;
+            break;
+        }
+        p->flight.seats_per_row = (unsigned char)per_row;
+        break;
+    }
+    default:
+        fprintf(stderr, "输入错误，请重新输入！\n");
+    }
+
+    if (h == List && index_insert(p) != SUCCESS)
+    {
+        fprintf(stderr, "航班%s重新加入索引失败\n", p->flight.number);
+        ret = FAILURE;
+    }
+    return ret;
+}
+
+/**
+ * @brief 根据起降机场搜索航班
+ *
+ * 结果复制到Searchlist链表；主链表走航线索引，新代码应使用search_route()。
+ *
+ * @param h 链表头节点
+ * @param s 出发机场
+ * @param e 到达机场
+ * @return int 状态码
+ */
+int search_info(FlightNode *h, char *s, char *e)
+{
+    if (isnempty(h) != SUCCESS)
+        return isnempty(h);
+
+    // 释放上一次的搜索结果并创建新的结果链表
+    if (Searchlist)
+        free_node(&Searchlist);
+    Searchlist = createHead();
+    if (Searchlist == NULL)
+        return FAILURE;
+
+    // 主链表直接取航线索引中的航班
+    if (h == List)
+    {
+        int count;
+        FlightNode *const *flights = route_find(s, e, &count);
+        for (int i = 0; i < count; i++)
+            tail_insert_times(Searchlist, &flights[i]->flight,
+                              flights[i]->departure_minutes, flights[i]->arrival_minutes);
+        return SUCCESS;
+    }
+
+    // 机场未登记时不会有匹配的航班，否则按字典id比较
+    DictId from = dict_lookup(DICT_AIRPORT, s), to = dict_lookup(DICT_AIRPORT, e);
+    if (from == DICT_NONE || to == DICT_NONE)
+        return SUCCESS;
+    FlightNode *p = h->next;
+    while (p)
+    {
+        // 匹配起降机场
+        if (p->flight.departure_airport == from && p->flight.arrival_airport == to)
+            tail_insert_times(Searchlist, &p->flight, p->departure_minutes, p->arrival_minutes); // 添加到结果链表
+        p = p->next;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 按航线索引搜索航班
+ *
+ * 结果为指向主链表节点的视图，耗时与匹配航班数成正比。
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @param v 输出视图（原有内容被覆盖，使用后调用free_view释放）
+ * @return int 有匹配返回SUCCESS，无匹配返回ERR_EMPTY，失败返回FAILURE
+ */
+int search_route(const char *s, const char *e, FlightView *v)
+{
+    int count;
+    FlightNode *const *flights = route_find(s, e, &count);
+
+    v->items = NULL;
+    v->count = v->capacity = 0;
+    if (count == 0)
+        return ERR_EMPTY;
+
+    v->items = (FlightNode **)malloc(count * sizeof(FlightNode *));
+    if (v->items == NULL)
+    {
+        perror("view malloc");
+        return FAILURE;
+    }
+    memcpy(v->items, flights, count * sizeof(FlightNode *));
+    v->count = v->capacity = count;
+    return SUCCESS;
+}
+
+/**
+ * @brief 按航线和出发时段搜索航班
+ *
+ * 结果为按出发时间排序的主链表视图，耗时O(log n + k)。
+ * from大于to时视为跨越午夜的时段（如22:00-02:00）。
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @param from 时段起点（分钟，含）
+ * @param to 时段终点（分钟，含）
+ * @param v 输出视图（原有内容被覆盖，使用后调用free_view释放）
+ * @return int 有匹配返回SUCCESS，无匹配返回ERR_EMPTY，失败返回FAILURE
+ */
+int search_route_by_time(const char *s, const char *e, short from, short to, FlightView *v)
+{
+    int n1, n2 = 0;
+    FlightNode *const *part1, *const *part2 = NULL;
+
+    // 跨午夜的时段拆成[from, 23:59]和[00:00, to]两段
+    if (from <= to)
+    {
+        part1 = route_time_range(s, e, from, to, &n1);
+    }
+    else
+    {
+        part1 = route_time_range(s, e, from, 24 * 60 - 1, &n1);
+        part2 = route_time_range(s, e, 0, to, &n2);
+    }
+
+    v->items = NULL;
+    v->count = v->capacity = 0;
+    if (n1 + n2 == 0)
+        return ERR_EMPTY;
+
+    v->items = (FlightNode **)malloc((n1 + n2) * sizeof(FlightNode *));
+    if (v->items == NULL)
+    {
+        perror("view malloc");
+        return FAILURE;
+    }
+    if (n1)
+        memcpy(v->items, part1, n1 * sizeof(FlightNode *));
+    if (n2)
+        memcpy(v->items + n1, part2, n2 * sizeof(FlightNode *));
+    v->count = v->capacity = n1 + n2;
+    return SUCCESS;
+}
+
+/**
+ * @brief 按航线和价格区间搜索航班
+ *
+ * 结果为按价格排序的主链表视图，耗时O(log n + k)。
+ *
+ * @param s 出发机场
+ * @param e 到达机场
+ * @param low 最低价格（含）
+ * @param high 最高价格（含）
+ * @param v 输出视图（原有内容被覆盖，使用后调用free_view释放）
+ * @return int 有匹配返回SUCCESS，无匹配返回ERR_EMPTY，失败返回FAILURE
+ */
+int search_route_by_price(const char *s, const char *e, Money low, Money high, FlightView *v)
+{
+    int count;
+    FlightNode *const *flights = route_price_range(s, e, low, high, &count);
+
+    v->items = NULL;
+    v->count = v->capacity = 0;
+    if (count == 0)
+        return ERR_EMPTY;
+
+    v->items = (FlightNode **)malloc(count * sizeof(FlightNode *));
+    if (v->items == NULL)
+    {
+        perror("view malloc");
+        return FAILURE;
+    }
+    memcpy(v->items, flights, count * sizeof(FlightNode *));
+    v->count = v->capacity = count;
+    return SUCCESS;
+}
+
+/**
+ * @brief 大顶堆下沉（堆顶为价格最高的航班）
+ *
+ * @param heap 堆数组
+ * @param n 堆大小
+ * @param i 下沉的位置
+ */
+static void heap_sift_down(FlightNode **heap, int n, int i)
+{
+    while (1)
+    {
+        int largest = i, l = 2 * i + 1, r = 2 * i + 2;
+        if (l < n && compare_by_price_then_time(heap[l], heap[largest]))
+            largest = l;
+        if (r < n && compare_by_price_then_time(heap[r], heap[largest]))
+            largest = r;
+        if (largest == i)
+            return;
+        FlightNode *t = heap[i];
+        heap[i] = heap[largest];
+        heap[largest] = t;
+        i = largest;
+    }
+}
+
+/**
+ * @brief 搜索票价最低的K个航班
+ *
+ * 指定航线时直接取航线按价格排序数组的前K个；出发、到达机场为NULL时
+ * 遍历整个目录，用大小为K的大顶堆筛选，不保存也不排序全部航班。
+ * 主链表尚未建立时先建立。
+ *
+ * @param s 出发机场（NULL表示全部航线）
+ * @param e 到达机场（NULL表示全部航线）
+ * @param k 航班数上限
+ * @param v 输出视图，按价格升序（原有内容被覆盖，使用后调用free_view释放）
+ * @return int 有结果返回SUCCESS，无结果返回ERR_EMPTY，失败返回FAILURE
+ */
+int search_cheapest(const char *s, const char *e, int k, FlightView *v)
+{
+    v->items = NULL;
+    v->count = v->capacity = 0;
+    if (k <= 0)
+        return ERR_EMPTY;
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
+
+    // 指定航线：价格有序数组的前K个
+    if (s != NULL && e != NULL)
+    {
+        int count;
+        FlightNode *const *flights = route_price_range(s, e, MONEY_MIN, MONEY_MAX, &count);
+        if (count == 0)
+            return ERR_EMPTY;
+        if (count > k)
+            count = k;
+        v->items = (FlightNode **)malloc(count * sizeof(FlightNode *));
+        if (v->items == NULL)
+        {
+            perror("view malloc");
+            return FAILURE;
+        }
+        memcpy(v->items, flights, count * sizeof(FlightNode *));
+        v->count = v->capacity = count;
+        return SUCCESS;
+    }
+
+    // 全部航线：有界大顶堆
+    FlightNode **heap = (FlightNode **)malloc(k * sizeof(FlightNode *));
+    if (heap == NULL)
+    {
+        perror("view malloc");
         return FAILURE;
-    // 调整链表指针
-    p->prev->next = p->next;
-    if (p->next != NULL)
-        p->next->prev = p->prev;
-    free(p); // 释放节点内存
-    p = NULL;
+    }
+    int n = 0;
+    for (FlightHandle h = catalog_first(); h != INVALID_HANDLE; h = catalog_next(h))
+    {
+        FlightNode *node = catalog_node(h);
+        if (n < k)
+        {
+            // 堆未满：上浮插入
+            int i = n++;
+            heap[i] = node;
+            while (i > 0 && compare_by_price_then_time(heap[i], heap[(i - 1) / 2]))
+            {
+                FlightNode *t = heap[i];
+                heap[i] = heap[(i - 1) / 2];
+                heap[(i - 1) / 2] = t;
+                i = (i - 1) / 2;
+            }
+        }
+        else if (compare_by_price_then_time(heap[0], node))
+        {
+            // 比堆顶便宜：替换堆顶
+            heap[0] = node;
+            heap_sift_down(heap, n, 0);
+        }
+    }
+    if (n == 0)
+    {
+        free(heap);
+        return ERR_EMPTY;
+    }
+
+    // 依次弹出堆顶放到末尾，得到升序结果
+    for (int i = n - 1; i > 0; i--)
+    {
+        FlightNode *t = heap[0];
+        heap[0] = heap[i];
+        heap[i] = t;
+        heap_sift_down(heap, i, 0);
+    }
+    v->items = heap;
+    v->count = n;
+    v->capacity = k;
     return SUCCESS;
 }
 
 /**
- * @brief 修改航班信息
+ * @brief 显示视图中的航班信息
  *
- * @param h 链表头节点
+ * @param v 航班视图
+ * @return int 空视图返回ERR_EMPTY，成功返回SUCCESS
+ */
+int display_view(const FlightView *v)
+{
+    if (v == NULL || v->count == 0)
+        return ERR_EMPTY;
+    print_flight_header(0);
+    for (int i = 0; i < v->count; i++)
+        print_flight(&v->items[i]->flight, 0);
+    return SUCCESS;
+}
+
+/**
+ * @brief 在视图中按航班号查找
+ *
+ * @param v 航班视图
  * @param number 航班号
- * @param change_n 修改项编号
- * @param change_message 修改内容
- * @return int 状态码
+ * @return FlightNode* 找到返回主链表节点，未找到返回NULL
  */
-int change_node(FlightNode *h, char *number, char change_n, char *change_message)
+FlightNode *view_find(const FlightView *v, const char *number)
 {
-    if (isnempty(h) != SUCCESS)
-        return FAILURE;
+    if (v == NULL)
+        return NULL;
+    for (int i = 0; i < v->count; i++)
+    {
+        if (!strcmp(v->items[i]->flight.number, number))
+            return v->items[i];
+    }
+    return NULL;
+}
 
-    FlightNode *p = get_pos(h, number);
-    if (p == NULL)
-        return ERR_NOT_FOUND;
-    // 根据选项修改不同字段
-    switch (change_n)
+/**
+ * @struct sort_cache
+ * @brief 排序结果缓存：记录某条航线的一组节点按某种比较函数排好的顺序
+ *
+ * 按(出发机场, 到达机场, 比较函数, 目录修改计数)查找，节点数和节点集合指纹
+ * 用于区分同一航线的不同筛选结果；节点不属于同一航线时航线为DICT_NONE。
+ */
+typedef struct sort_cache
+{
+    DictId departure_airport;  ///< 出发机场（混合航线为DICT_NONE）
+    DictId arrival_airport;    ///< 到达机场（混合航线为DICT_NONE）
+    CompareFunc compare;       ///< 比较函数
+    unsigned long generation;  ///< 缓存时的目录修改计数
+    unsigned long list_generation; ///< 缓存时的链表修改计数（订单等非目录链表）
+    uint64_t fingerprint;      ///< 节点集合指纹（与顺序无关）
+    unsigned long last_used;   ///< 最近使用时刻（用于淘汰）
+    FlightNode **order;        ///< 排好序的节点指针
+    int count;                 ///< 节点数
+} SortCache;
+
+#define SORT_CACHE_SIZE 8 ///< 排序缓存条目数
+
+static SortCache sort_cache[SORT_CACHE_SIZE]; // 排序缓存
+static unsigned long sort_tick = 0;           // 缓存使用计时
+
+/**
+ * @struct sort_key
+ * @brief 排序缓存键
+ */
+typedef struct sort_key
+{
+    DictId departure_airport;  ///< 出发机场（混合航线为DICT_NONE）
+    DictId arrival_airport;    ///< 到达机场（混合航线为DICT_NONE）
+    CompareFunc compare;       ///< 比较函数
+    unsigned long generation;  ///< 目录修改计数
+    uint64_t fingerprint;      ///< 节点集合指纹
+    int count;                 ///< 节点数
+} SortKey;
+
+/**
+ * @brief 计算一组节点的排序缓存键
+ *
+ * @param items 节点指针数组
+ * @param n 元素个数（大于0）
+ * @param compare 比较函数
+ * @return SortKey 缓存键
+ */
+static SortKey sort_key(FlightNode *const *items, int n, CompareFunc compare)
+{
+    SortKey key = {items[0]->flight.departure_airport, items[0]->flight.arrival_airport,
+                   compare, catalog_generation(), 0, n};
+    for (int i = 0; i < n; i++)
     {
-    case '1': // 航空公司
-        strcpy(p->flight.airline, change_message);
-        break;
-    case '2': // 出发时间
-        strcpy(p->flight.departure_time, change_message);
-        break;
-    case '3': // 到达时间
-        strcpy(p->flight.arrival_time, change_message);
-        break;
-    case '4': // 出发机场
-        strcpy(p->flight.departure_airport, change_message);
-        break;
-    case '5': // 到达机场
-        strcpy(p->flight.arrival_airport, change_message);
-        break;
-    case '6': // 航班状态
-        strcpy(p->flight.status, change_message);
-        break;
-    case '7': // 机票价格
-        if (sscanf(change_message, "%lf", &p->flight.price) != 1)
+        if (items[i]->flight.departure_airport != key.departure_airport ||
+            items[i]->flight.arrival_airport != key.arrival_airport)
+            key.departure_airport = key.arrival_airport = DICT_NONE;
+        // 各节点地址混合后相加，与顺序无关
+        uint64_t x = (uint64_t)(uintptr_t)items[i] * 0x9E3779B97F4A7C15ULL;
+        key.fingerprint += x ^ (x >> 29);
+    }
+    return key;
+}
+
+/**
+ * @brief 缓存条目是否与键匹配
+ *
+ * @param c 缓存条目
+ * @param key 缓存键
+ * @return int 匹配返回1，否则返回0
+ */
+static int sort_cache_match(const SortCache *c, const SortKey *key)
+{
+    return c->departure_airport == key->departure_airport && c->arrival_airport == key->arrival_airport &&
+           c->compare == key->compare && c->fingerprint == key->fingerprint && c->count == key->count;
+}
+
+/**
+ * @brief 缓存条目是否仍有效（目录和链表都未被修改）
+ *
+ * @param c 缓存条目
+ * @param key 缓存键
+ * @return int 有效返回1，否则返回0
+ */
+static int sort_cache_fresh(const SortCache *c, const SortKey *key)
+{
+    return c->order && c->generation == key->generation && c->list_generation == list_generation;
+}
+
+/**
+ * @brief 查找排序缓存
+ *
+ * @param key 缓存键
+ * @return SortCache* 有效缓存返回条目指针，否则返回NULL
+ */
+static SortCache *sort_cache_find(const SortKey *key)
+{
+    for (int i = 0; i < SORT_CACHE_SIZE; i++)
+    {
+        SortCache *c = &sort_cache[i];
+        if (sort_cache_fresh(c, key) && sort_cache_match(c, key))
         {
-            printf("价格格式错误！\n");
-            return ERR_INVALID_INPUT;
+            c->last_used = ++sort_tick;
+            return c;
         }
-        break;
-    default:
-        printf("输入错误，请重新输入！\n");
     }
+    return NULL;
+}
+
+/**
+ * @brief 保存排序结果到缓存（淘汰过期或最久未用的条目）
+ *
+ * @param key 缓存键
+ * @param order 排好序的节点指针
+ */
+static void sort_cache_store(const SortKey *key, FlightNode **order)
+{
+    SortCache *victim = &sort_cache[0];
+    for (int i = 0; i < SORT_CACHE_SIZE; i++)
+    {
+        SortCache *c = &sort_cache[i];
+        if (!sort_cache_fresh(c, key) || sort_cache_match(c, key))
+        {
+            victim = c;
+            break;
+        }
+        if (c->last_used < victim->last_used)
+            victim = c;
+    }
+
+    FlightNode **copy = (FlightNode **)malloc(key->count * sizeof(FlightNode *));
+    if (copy == NULL)
+        return; // 缓存失败不影响排序结果
+    memcpy(copy, order, key->count * sizeof(FlightNode *));
+
+    free(victim->order);
+    victim->departure_airport = key->departure_airport;
+    victim->arrival_airport = key->arrival_airport;
+    victim->compare = key->compare;
+    victim->generation = key->generation;
+    victim->list_generation = list_generation;
+    victim->fingerprint = key->fingerprint;
+    victim->last_used = ++sort_tick;
+    victim->order = copy;
+    victim->count = key->count;
+}
+
+/**
+ * @brief 节点指针数组归并排序（稳定）
+ *
+ * @param a 节点指针数组
+ * @param tmp 同样大小的辅助数组
+ * @param n 元素个数
+ * @param compare 比较函数（a>b返回真）
+ */
+static void merge_sort_nodes(FlightNode **a, FlightNode **tmp, int n, CompareFunc compare)
+{
+    // 小区间使用插入排序
+    if (n <= 16)
+    {
+        for (int i = 1; i < n; i++)
+        {
+            FlightNode *x = a[i];
+            int j = i;
+            while (j > 0 && compare(a[j - 1], x))
+            {
+                a[j] = a[j - 1];
+                j--;
+            }
+            a[j] = x;
+        }
+        return;
+    }
+
+    int mid = n / 2;
+    merge_sort_nodes(a, tmp, mid, compare);
+    merge_sort_nodes(a + mid, tmp, n - mid, compare);
+
+    // 两半已有序时无需合并
+    if (!compare(a[mid - 1], a[mid]))
+        return;
+
+    // 合并：只有右侧严格小于左侧时才取右侧元素，保证稳定
+    memcpy(tmp, a, mid * sizeof(FlightNode *));
+    int i = 0, j = mid, k = 0;
+    while (i < mid && j < n)
+    {
+        if (compare(tmp[i], a[j]))
+            a[k++] = a[j++];
+        else
+            a[k++] = tmp[i++];
+    }
+    while (i < mid)
+        a[k++] = tmp[i++];
+}
+
+/**
+ * @brief 排序节点指针数组，优先使用缓存的顺序
+ *
+ * @param items 节点指针数组，排序结果写回
+ * @param n 元素个数
+ * @param compare 比较函数
+ * @return int 成功返回SUCCESS，内存不足返回FAILURE
+ */
+static int sort_nodes(FlightNode **items, int n, CompareFunc compare)
+{
+    SortKey key = sort_key(items, n, compare);
+    SortCache *c = sort_cache_find(&key);
+    if (c)
+    {
+        memcpy(items, c->order, n * sizeof(FlightNode *));
+        return SUCCESS;
+    }
+
+    ArenaMark mark = arena_mark();
+    FlightNode **tmp = (FlightNode **)arena_alloc((n / 2 + 1) * sizeof(FlightNode *));
+    if (tmp == NULL)
+        return FAILURE;
+    merge_sort_nodes(items, tmp, n, compare);
+    arena_release(mark);
+    sort_cache_store(&key, items);
     return SUCCESS;
 }
 
 /**
- * @brief 根据起降机场搜索航班
+ * @brief 视图排序（只重排指针，不改变主链表）
+ *
+ * 稳定排序；同一组航班按同一比较函数再次排序时直接使用缓存的顺序（与视图本身无关）。
+ *
+ * @param v 航班视图
+ * @param compare 比较函数指针
+ */
+void sort_view(FlightView *v, CompareFunc compare)
+{
+    if (v == NULL || v->count < 2)
+        return;
+    sort_nodes(v->items, v->count, compare);
+}
+
+/**
+ * @brief 释放视图内存（不释放主链表节点，释放视图持有的副本）
+ *
+ * @param v 航班视图
+ */
+void free_view(FlightView *v)
+{
+    if (v == NULL)
+        return;
+    free(v->items);
+    v->items = NULL;
+    v->count = v->capacity = 0;
+}
+
+/**
+ * @struct route_cache
+ * @brief 航线搜索结果缓存：某条航线按某种顺序排好的主链表节点
+ */
+typedef struct route_cache
+{
+    DictId departure_airport;    ///< 出发机场
+    DictId arrival_airport;      ///< 到达机场
+    CompareFunc compare;         ///< 比较函数（NULL为索引顺序）
+    unsigned long generation;    ///< 缓存时的目录修改计数
+    unsigned long last_used;     ///< 最近使用时刻（用于淘汰）
+    FlightNode **items;          ///< 排好序的节点指针
+    int count;                   ///< 节点数
+    int valid;                   ///< 条目是否有效（无匹配航班的结果也缓存）
+} RouteCache;
+
+#define ROUTE_CACHE_SIZE 32 ///< 航线搜索缓存条目数
+
+static RouteCache route_cache[ROUTE_CACHE_SIZE]; // 航线搜索缓存
+static unsigned long route_tick = 0;             // 缓存使用计时
+static unsigned long route_hits = 0;             // 缓存命中次数
+static unsigned long route_misses = 0;           // 缓存未命中次数
+
+/**
+ * @brief 丢弃航线缓存条目
+ *
+ * @param c 缓存条目
+ */
+static void route_cache_drop(RouteCache *c)
+{
+    free(c->items);
+    memset(c, 0, sizeof(RouteCache));
+}
+
+/**
+ * @brief 按航线和顺序搜索航班（带LRU缓存）
+ *
+ * 结果按(出发机场, 到达机场, 比较函数)缓存；主链表任何增删改都会使缓存过期，
+ * 过期条目在查询时丢弃。返回的视图是缓存的副本，可自由排序。
+ * 主链表尚未建立时先建立。
  *
- * @param h 链表头节点
  * @param s 出发机场
  * @param e 到达机场
- * @return int 状态码
+ * @param compare 比较函数，NULL为索引顺序
+ * @param v 输出视图（原有内容被覆盖，使用后调用free_view释放）
+ * @return int 有匹配返回SUCCESS，无匹配返回ERR_EMPTY，失败返回FAILURE
  */
-int search_info(FlightNode *h, char *s, char *e)
+int search_route_sorted(const char *s, const char *e, CompareFunc compare, FlightView *v)
 {
-    if (isnempty(h) != SUCCESS)
-        return isnempty(h);
-    FlightNode *p = h->next;
-    // 创建搜索结果链表
-    Searchlist = createHead();
-    while (p)
+    v->items = NULL;
+    v->count = v->capacity = 0;
+    if (s == NULL || e == NULL)
+        return ERR_EMPTY;
+
+    // 未登记的机场不可能有匹配的航班，不查询也不缓存
+    DictId from = dict_lookup(DICT_AIRPORT, s), to = dict_lookup(DICT_AIRPORT, e);
+    if (from == DICT_NONE || to == DICT_NONE)
+        return ERR_EMPTY;
+
+    // 主链表尚未建立：先建立
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
+    unsigned long generation = catalog_generation();
+    RouteCache *victim = &route_cache[0];
+    for (int i = 0; i < ROUTE_CACHE_SIZE; i++)
     {
-        // 匹配起降机场
-        if (!strcmp(p->flight.departure_airport, s) && !strcmp(p->flight.arrival_airport, e))
-            tail_insert(Searchlist, &p->flight); // 添加到结果链表
-        p = p->next;
+        RouteCache *c = &route_cache[i];
+        if (c->valid && c->generation != generation)
+            route_cache_drop(c);
+        if (!c->valid)
+        {
+            if (victim->valid)
+                victim = c;
+            continue;
+        }
+        if (c->compare == compare && c->departure_airport == from && c->arrival_airport == to)
+        {
+            route_hits++;
+            c->last_used = ++route_tick;
+            if (c->count == 0)
+                return ERR_EMPTY;
+            v->items = (FlightNode **)malloc(c->count * sizeof(FlightNode *));
+            if (v->items == NULL)
+            {
+                perror("view malloc");
+                return FAILURE;
+            }
+            memcpy(v->items, c->items, c->count * sizeof(FlightNode *));
+            v->count = v->capacity = c->count;
+            return SUCCESS;
+        }
+        if (victim->valid && c->last_used < victim->last_used)
+            victim = c;
+    }
+    route_misses++;
+
+    int ret = search_route(s, e, v);
+    if (ret == FAILURE)
+        return FAILURE;
+    if (compare != NULL && v->count > 1)
+    {
+        ArenaMark mark = arena_mark();
+        FlightNode **tmp = (FlightNode **)arena_alloc((v->count / 2 + 1) * sizeof(FlightNode *));
+        if (tmp == NULL)
+        {
+            free_view(v);
+            return FAILURE;
+        }
+        merge_sort_nodes(v->items, tmp, v->count, compare);
+        arena_release(mark);
     }
+
+    // 保存到空闲或最久未用的条目（缓存失败不影响结果）
+    FlightNode **copy = NULL;
+    if (v->count > 0)
+    {
+        copy = (FlightNode **)malloc(v->count * sizeof(FlightNode *));
+        if (copy == NULL)
+            return ret;
+        memcpy(copy, v->items, v->count * sizeof(FlightNode *));
+    }
+    route_cache_drop(victim);
+    victim->departure_airport = from;
+    victim->arrival_airport = to;
+    victim->compare = compare;
+    victim->generation = generation;
+    victim->last_used = ++route_tick;
+    victim->items = copy;
+    victim->count = v->count;
+    victim->valid = 1;
+    return ret;
+}
+
+/**
+ * @brief 查询航线搜索缓存的命中统计
+ *
+ * @param hits 输出：命中次数（可为NULL）
+ * @param misses 输出：未命中次数（可为NULL）
+ */
+void route_cache_stats(unsigned long *hits, unsigned long *misses)
+{
+    if (hits)
+        *hits = route_hits;
+    if (misses)
+        *misses = route_misses;
+}
+
+/**
+ * @brief 解析并规范化时间字符串
+ *
+ * 接受"H:MM"或"HH:MM"，成功时把字符串改写为"HH:MM"，
+ * 使"8:00"和"08:00"显示和排序一致。
+ *
+ * @param text 时间字符串（成功时被规范化，缓冲区至少6字节）
+ * @param minutes 输出：当天分钟数(0~1439)
+ * @return int 成功返回SUCCESS，格式错误返回ERR_INVALID_INPUT
+ */
+int parse_time(char *text, short *minutes)
+{
+    int h, m, len;
+    if (text == NULL || sscanf(text, "%2d:%2d%n", &h, &m, &len) != 2 || text[len] != '\0')
+        return ERR_INVALID_INPUT;
+    if (h < 0 || h > 23 || m < 0 || m > 59 || len < 4 || text[len - 3] != ':')
+        return ERR_INVALID_INPUT;
+
+    *minutes = (short)(h * 60 + m);
+    sprintf(text, "%02d:%02d", h, m);
     return SUCCESS;
 }
 
+/**
+ * @brief 航班飞行时长（到达早于出发视为次日到达）
+ *
+ * @param node 航班节点
+ * @return int 时长（分钟），时间无效返回TIME_INVALID
+ */
+int flight_duration(const FlightNode *node)
+{
+    if (node->departure_minutes == TIME_INVALID || node->arrival_minutes == TIME_INVALID)
+        return TIME_INVALID;
+    int d = node->arrival_minutes - node->departure_minutes;
+    return d < 0 ? d + 24 * 60 : d;
+}
+
 /**
  * @brief 比较函数：按出发时间排序
  *
@@ -441,9 +2067,9 @@ int search_info(FlightNode *h, char *s, char *e)
  * @param b 航班B
  * @return int a>b返回真
  */
-int compare_by_departure_time(const Flight_n *a, const Flight_n *b)
+int compare_by_departure_time(const FlightNode *a, const FlightNode *b)
 {
-    return strcmp(a->departure_time, b->departure_time) > 0;
+    return a->departure_minutes > b->departure_minutes;
 }
 
 /**
@@ -453,13 +2079,44 @@ int compare_by_departure_time(const Flight_n *a, const Flight_n *b)
  * @param b 航班B
  * @return int a>b返回真
  */
-int compare_by_price(const Flight_n *a, const Flight_n *b)
+int compare_by_price(const FlightNode *a, const FlightNode *b)
+{
+    return a->flight.price > b->flight.price;
+}
+
+/**
+ * @brief 比较函数：按价格排序，价格相同按出发时间
+ *
+ * @param a 航班A
+ * @param b 航班B
+ * @return int a>b返回真
+ */
+int compare_by_price_then_time(const FlightNode *a, const FlightNode *b)
+{
+    if (a->flight.price != b->flight.price)
+        return a->flight.price > b->flight.price;
+    return a->departure_minutes > b->departure_minutes;
+}
+
+/**
+ * @brief 比较函数：按出发时间排序，时间相同按价格
+ *
+ * @param a 航班A
+ * @param b 航班B
+ * @return int a>b返回真
+ */
+int compare_by_time_then_price(const FlightNode *a, const FlightNode *b)
 {
-    return a->price > b->price;
+    if (a->departure_minutes != b->departure_minutes)
+        return a->departure_minutes > b->departure_minutes;
+    return a->flight.price > b->flight.price;
 }
 
 /**
- * @brief 链表排序（冒泡排序）
+ * @brief 链表排序（稳定归并排序）
+ *
+ * 对节点指针数组排序后重新链接节点，不复制航班数据；
+ * 链表未被修改时，按同一比较函数再次排序直接使用缓存的顺序。
  *
  * @param h 链表头节点指针的指针
  * @param compare 比较函数指针
@@ -469,30 +2126,32 @@ void sort_list(FlightNode **h, CompareFunc compare)
     if (!*h || !(*h)->next || !(*h)->next->next)
         return; // 空链表或单节点链表
 
-    int swapped;
-    FlightNode *p1, *p2, *end = NULL;
-    do
-    {
-        swapped = 0;
-        p1 = (*h)->next;
+    // 收集节点指针
+    int n = 0;
+    for (FlightNode *p = (*h)->next; p; p = p->next)
+        n++;
+    ArenaMark mark = arena_mark();
+    FlightNode **items = (FlightNode **)arena_alloc(n * sizeof(FlightNode *));
+    if (items == NULL)
+        return;
+    int i = 0;
+    for (FlightNode *p = (*h)->next; p; p = p->next)
+        items[i++] = p;
 
-        while (p1->next != end)
+    if (sort_nodes(items, n, compare) == SUCCESS)
+    {
+        // 按排序结果重新链接（头节点prev记录尾节点）
+        FlightNode *prev = *h;
+        for (i = 0; i < n; i++)
         {
-            p2 = p1->next;
-
-            // 根据比较函数决定是否交换
-            if (compare(&p1->flight, &p2->flight))
-            {
-                // 交换航班数据
-                Flight_n temp = p1->flight;
-                p1->flight = p2->flight;
-                p2->flight = temp;
-                swapped = 1;
-            }
-            p1 = p1->next;
+            prev->next = items[i];
+            items[i]->prev = prev;
+            prev = items[i];
         }
-        end = p1; // 缩小排序范围
-    } while (swapped);
+        prev->next = NULL;
+        (*h)->prev = prev;
+    }
+    arena_release(mark);
 }
 
 /**
@@ -503,13 +2162,19 @@ void sort_list(FlightNode **h, CompareFunc compare)
  */
 int free_node(FlightNode **h)
 {
-    FlightNode *p = (*h);
-    while (p)
+    list_generation++;
+
+    // 主链表节点整体归还目录，只需单独释放头节点
+    if (*h != NULL && *h == List)
     {
-        FlightNode *temp = p;
-        p = p->next;
-        free(temp); // 释放当前节点
+        index_clear();
+        catalog_clear();
+        node_pool_free(*h);
+        *h = NULL;
+        return SUCCESS;
     }
+    // 其余链表整条归还节点池
+    node_pool_free_list(*h);
     *h = NULL; // 头指针置空
     return SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "../include/head.h"
+
+/**
+ * @brief 跳过开头的空白和人民币符号（¥或￥）
+ *
+ * @param p 文本
+ * @return const char* 金额数字的起始位置
+ */
+static const char *skip_prefix(const char *p)
+{
+    while (*p == ' ' || *p == '\t')
+        p++;
+    if (!strncmp(p, "¥", strlen("¥")))
+        p += strlen("¥");
+    else if (!strncmp(p, "￥", strlen("￥")))
+        p += strlen("￥");
+    return p;
+}
+
+/**
+ * @brief 精确解析金额文本
+ *
+ * 接受"980"、"980.5"、"980.00元"、"¥980.00"等形式，小数最多两位；
+ * 按十进制逐位转换为分，不经过浮点数。
+ *
+ * @param text 金额文本
+ * @param value 输出：金额（分）
+ * @return int 成功返回SUCCESS，格式错误、负数或超出范围返回ERR_INVALID_INPUT
+ */
+int money_parse(const char *text, Money *value)
+{
+    if (text == NULL)
+        return ERR_INVALID_INPUT;
+    const char *p = skip_prefix(text);
+    if (*p < '0' || *p > '9')
+        return ERR_INVALID_INPUT;
+
+    // 整数部分（元）
+    Money yuan = 0;
+    for (; *p >= '0' && *p <= '9'; p++)
+    {
+        if (yuan > (MONEY_MAX / MONEY_SCALE - 9) / 10)
+            return ERR_INVALID_INPUT;
+        yuan = yuan * 10 + (*p - '0');
+    }
+
+    // 小数部分（分），不足两位补0
+    Money cents = 0;
+    int digits = 0;
+    if (*p == '.')
+    {
+        for (p++; *p >= '0' && *p <= '9'; p++)
+        {
+            if (++digits > 2)
+                return ERR_INVALID_INPUT;
+            cents = cents * 10 + (*p - '0');
+        }
+    }
+    for (; digits < 2; digits++)
+        cents *= 10;
+
+    // 可选的单位"元"和结尾空白
+    if (!strncmp(p, "元", strlen("元")))
+        p += strlen("元");
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+        p++;
+    if (*p != '\0')
+        return ERR_INVALID_INPUT;
+
+    *value = yuan * MONEY_SCALE + cents;
+    return SUCCESS;
+}
+
+/**
+ * @brief 把金额格式化为"元.分"
+ *
+ * @param value 金额（分）
+ * @param buf 输出缓冲区（至少MONEY_TEXT_MAX字节）
+ * @return char* buf
+ */
+char *money_format(Money value, char *buf)
+{
+    uint64_t abs = value < 0 ? -(uint64_t)value : (uint64_t)value;
+    snprintf(buf, MONEY_TEXT_MAX, "%s%llu.%02u", value < 0 ? "-" : "",
+             (unsigned long long)(abs / MONEY_SCALE), (unsigned)(abs % MONEY_SCALE));
+    return buf;
+}
+
+/**
+ * @brief 浮点元转为金额（第1版数据中的票价、余额）
+ *
+ * 两位小数的金额写成double再读回时四舍五入即可还原为原来的分数。
+ *
+ * @param yuan 金额（元）
+ * @return Money 金额（分）
+ */
+Money money_from_double(double yuan)
+{
+    double cents = yuan * MONEY_SCALE;
+    // 损坏的旧记录可能超出范围，取边界值（NaN为0），避免未定义的转换
+    if (!(cents == cents))
+        return 0;
+    if (cents >= (double)MONEY_MAX)
+        return MONEY_MAX;
+    if (cents <= (double)MONEY_MIN)
+        return MONEY_MIN;
+    return (Money)(cents < 0 ? cents - 0.5 : cents + 0.5);
+}
+
+/**
+ * @brief 金额求和
+ *
+ * 连续数组上的无分支循环，编译器可展开为SIMD加法；整数求和与顺序无关，结果精确。
+ *
+ * @param values 金额数组
+ * @param n 元素数
+ * @return Money 总额
+ */
+Money money_sum(const Money *values, size_t n)
+{
+    Money sum = 0;
+    for (size_t i = 0; i < n; i++)
+        sum += values[i];
+    return sum;
+}
+
+/**
+ * @brief 最小和最大金额
+ *
+ * 用条件选择代替分支，编译器可转换为SIMD比较和混合指令。
+ *
+ * @param values 金额数组
+ * @param n 元素数
+ * @param min 输出：最小金额（n为0时为0）
+ * @param max 输出：最大金额（n为0时为0）
+ */
+void money_minmax(const Money *values, size_t n, Money *min, Money *max)
+{
+    if (n == 0)
+    {
+        *min = *max = 0;
+        return;
+    }
+    Money lo = values[0], hi = values[0];
+    for (size_t i = 1; i < n; i++)
+    {
+        lo = values[i] < lo ? values[i] : lo;
+        hi = values[i] > hi ? values[i] : hi;
+    }
+    *min = lo;
+    *max = hi;
+}
@@ -1,98 +1,966 @@
 #include "../include/head.h"
+
+#define ORDER_PATH_MAX 64 ///< 订单文件路径缓冲区长度（"data/order/"、用户名和".txt.tmp"）
+
+/**
+ * @struct order_reader
+ * @brief 订单文件读取状态（只读映射整个文件，兼容第1版格式）
+ */
+typedef struct order_reader
+{
+    const char* data; ///< 映射的订单文件（空文件为NULL）
+    size_t size;      ///< 文件长度
+    size_t pos;       ///< 下一条记录的偏移
+    int version;      ///< 文件版本（1或RECORD_VERSION）
+} OrderReader;
+
+/**
+ * @struct order_set
+ * @brief 有效订单记录数组（折叠事件后的结果，按购票顺序）
+ */
+typedef struct order_set
+{
+    OrderDisk* items; ///< 订单记录
+    int count;        ///< 订单数
+    int capacity;     ///< 数组容量
+} OrderSet;
+
 /**
- * @brief 更新用户订单信息到文件
- * 
- * 将用户订单链表中的航班数据写入到对应用户名的订单文件中。
+ * @struct order_session
+ * @brief 会话订单缓存：一个登录用户的有效订单和尚未写入的事件
+ */
+struct order_session
+{
+    OrderSet orders;  ///< 当前用户的有效订单
+    OrderSet pending; ///< 尚未写入订单文件的事件
+    int events;       ///< 订单文件中的事件数（决定是否压缩）
+    uint32_t seq;     ///< 已用的最大事件序号（提交时从其后编号）
+    uint32_t settled; ///< 已计入余额的最后一个事件序号（之后的事件未结算时不压缩文件）
+    char file[ORDER_PATH_MAX]; ///< 当前用户的订单文件（未登录为空串）
+};
+
+static OrderSession default_session;          // 交互模式使用的会话
+static OrderSession* current = &default_session; // 订单函数操作的会话
+
+/**
+ * @brief 构建用户订单文件名
+ *
+ * @param filename 输出缓冲区（ORDER_PATH_MAX字节）
+ * @param username 用户名
+ */
+static void order_filename(char* filename, const char* username)
+{
+    snprintf(filename,ORDER_PATH_MAX,"data/order/%.*s.txt",U - 1,username);
+}
+
+/**
+ * @brief 只读映射订单文件并识别版本
+ *
+ * @param filename 订单文件路径
+ * @param r 输出：读取状态
+ * @return int 成功返回SUCCESS，文件不存在返回ERR_NOT_FOUND，
+ *             文件头无效返回ERR_INVALID_INPUT，失败返回FAILURE
+ */
+static int order_open(const char* filename, OrderReader* r)
+{
+    memset(r,0,sizeof(OrderReader));
+    r->version = 1;
+
+    int fd = open(filename,O_RDONLY);
+    if(fd < 0) {
+        // 文件不存在视为空订单
+        if(errno == ENOENT) return ERR_NOT_FOUND;
+        perror("open");
+        return FAILURE;
+    }
+    struct stat st;
+    if(fstat(fd,&st) != 0) {
+        perror("fstat");
+        close(fd);
+        return FAILURE;
+    }
+    r->size = st.st_size;
+    if(r->size > 0) {
+        void* p = mmap(NULL,r->size,PROT_READ,MAP_PRIVATE,fd,0);
+        if(p == MAP_FAILED) {
+            perror("mmap");
+            close(fd);
+            return FAILURE;
+        }
+        r->data = p;
+    }
+    close(fd);
+
+    // 没有当前文件头的是第1版文件（无文件头的LegacyFlight数组）
+    const FileHeader* header = (const FileHeader*)r->data;
+    if(r->size >= sizeof(FileHeader)) {
+        int ret = header_check(header,ORDERS_FILE_MAGIC,sizeof(OrderDisk));
+        if(ret == SUCCESS) {
+            r->version = RECORD_VERSION;
+            r->pos = sizeof(FileHeader);
+            return SUCCESS;
+        }
+        if(ret == ERR_INVALID_INPUT) {
+            fprintf(stderr,"订单文件%s的文件头无效（版本、字节序或校验不符）\n",filename);
+            munmap((void*)r->data,r->size);
+            return ERR_INVALID_INPUT;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 释放订单文件映射
+ *
+ * @param r 读取状态
+ */
+static void order_close(OrderReader* r)
+{
+    if(r->data)
+        munmap((void*)r->data,r->size);
+    r->data = NULL;
+}
+
+/**
+ * @brief 生成订单事件记录（含记录CRC）
+ *
+ * @param type 事件类型（ORDER_BOOK/ORDER_REFUND）
+ * @param number 航班号（旧版记录中可能没有结束符，最多取9字节）
+ * @param price 实付票价（分）
+ * @param time 事件时间（Unix时间，未知为0）
+ * @param seat 座位号（未分配为SEAT_NONE）
+ * @param ev 输出：事件记录
+ */
+static void order_record(int type, const char* number, Money price, int64_t time, int seat, OrderDisk* ev)
+{
+    memset(ev,0,sizeof(OrderDisk));
+    ev->type = type;
+    snprintf(ev->number,sizeof(ev->number),"%.*s",(int)sizeof(ev->number) - 1,number);
+    ev->time = time;
+    ev->price = price;
+    ev->seat = (int16_t)seat;
+    ev->crc = record_crc(ev,sizeof(OrderDisk),offsetof(OrderDisk,crc));
+}
+
+/**
+ * @brief 读取下一个订单事件（第1版文件中的每条航班都视为一次购票）
+ *
+ * 直接在映射中校验记录。第1版的航班只取航班号和票价转换为当前格式。
+ *
+ * @param r 读取状态
+ * @param ev 输出：事件记录（当前格式）
+ * @return int 读到有效事件返回SUCCESS，文件结束返回ERR_EMPTY，事件损坏返回FAILURE
+ */
+static int order_next(OrderReader* r, OrderDisk* ev)
+{
+    const char* p = r->data + r->pos;
+    if(r->version == RECORD_VERSION) {
+        if(r->pos + sizeof(OrderDisk) > r->size)
+            return ERR_EMPTY;
+        memcpy(ev,p,sizeof(OrderDisk));
+        if(ev->crc != record_crc(ev,sizeof(OrderDisk),offsetof(OrderDisk,crc)))
+            return FAILURE;
+        r->pos += sizeof(OrderDisk);
+        return SUCCESS;
+    }
+    if(r->pos + sizeof(LegacyFlight) > r->size)
+        return ERR_EMPTY;
+    const LegacyFlight* legacy = (const LegacyFlight*)p;
+    r->pos += sizeof(LegacyFlight);
+    order_record(ORDER_BOOK,legacy->number,money_from_double(legacy->price),0,SEAT_NONE,ev);
+    return SUCCESS;
+}
+
+/**
+ * @brief 在订单数组末尾添加一条记录
+ *
+ * @param set 订单数组
+ * @param ev 订单记录
+ * @return int 成功返回SUCCESS，内存不足返回FAILURE
+ */
+static int order_set_add(OrderSet* set, const OrderDisk* ev)
+{
+    if(set->count == set->capacity) {
+        int new_capacity = set->capacity ? set->capacity * 2 : 16;
+        OrderDisk* grown = realloc(set->items,(size_t)new_capacity * sizeof(OrderDisk));
+        if(grown == NULL) {
+            perror("realloc");
+            return FAILURE;
+        }
+        set->items = grown;
+        set->capacity = new_capacity;
+    }
+    set->items[set->count++] = *ev;
+    return SUCCESS;
+}
+
+/**
+ * @brief 删除第一条航班号相同的订单（与退票界面一致）
+ *
+ * @param set 订单数组
+ * @param number 航班号
+ * @param removed 输出：被删除的订单（可为NULL）
+ * @return int 成功返回SUCCESS，没有该航班的订单返回ERR_NOT_FOUND
+ */
+static int order_set_remove(OrderSet* set, const char* number, OrderDisk* removed)
+{
+    for(int i = 0; i < set->count; i++) {
+        if(!strcmp(set->items[i].number,number)) {
+            if(removed) *removed = set->items[i];
+            memmove(&set->items[i],&set->items[i + 1],(size_t)(set->count - i - 1) * sizeof(OrderDisk));
+            set->count--;
+            return SUCCESS;
+        }
+    }
+    return ERR_NOT_FOUND;
+}
+
+/**
+ * @brief 读取订单文件并折叠为有效订单数组
+ *
+ * 逐条重放购票/退票事件，遇到残缺或校验失败的事件即停止。
+ * 购票追加到末尾；退票删除第一个航班号相同的订单。
+ *
+ * @param filename 订单文件路径
+ * @param set 订单数组（结果追加到末尾）
+ * @param events 输出：文件中的有效事件数（可为NULL）
+ * @param legacy 输出：是否为旧版文件（可为NULL）
+ * @param seq 输出：有效事件的最大序号（可为NULL）
+ * @param valid 输出：最后一个有效事件之后的偏移，其后是残缺或损坏的内容（可为NULL）
+ * @return int 成功返回SUCCESS，文件不存在返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+static int fold_order_file(const char* filename, OrderSet* set, int* events, int* legacy, uint32_t* seq,
+                           size_t* valid)
+{
+    if(events) *events = 0;
+    if(legacy) *legacy = 0;
+    if(seq) *seq = 0;
+    if(valid) *valid = 0;
+
+    OrderReader r;
+    int ret = order_open(filename,&r);
+    if(ret == ERR_NOT_FOUND)
+        return ERR_NOT_FOUND;
+    if(ret != SUCCESS)
+        return FAILURE;
+    if(legacy) *legacy = r.version != RECORD_VERSION;
+
+    int n = 0;
+    OrderDisk ev;
+    while((ret = order_next(&r,&ev)) == SUCCESS) {
+        if(ev.type == ORDER_BOOK) {
+            if(order_set_add(set,&ev) != SUCCESS)
+                break;
+        } else if(ev.type == ORDER_REFUND) {
+            order_set_remove(set,ev.number,NULL);
+        }
+        if(seq && ev.seq > *seq) *seq = ev.seq;
+        n++;
+    }
+    if(ret == FAILURE)
+        fprintf(stderr,"订单文件%s有损坏的记录，已忽略其后内容\n",filename);
+    if(events) *events = n;
+    if(valid) *valid = ret == SUCCESS ? r.size : r.pos;
+    order_close(&r);
+    return SUCCESS;
+}
+
+/**
+ * @brief 以当前格式重写订单文件（每个订单一条购票事件，保留原购票时间）
+ *
+ * 先写临时文件并fsync，再rename覆盖，崩溃时保留旧文件或新文件之一。
+ *
+ * @param filename 订单文件路径
+ * @param set 有效订单数组
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int write_order_file(const char* filename, const OrderSet* set)
+{
+    char tmpname[ORDER_PATH_MAX];
+    if(snprintf(tmpname,sizeof(tmpname),"%s.tmp",filename) >= (int)sizeof(tmpname)) {
+        fprintf(stderr,"订单文件名过长：%s\n",filename);
+        return FAILURE;
+    }
+
+    FILE* fp = fopen(tmpname,"wb");
+    if(fp == NULL) {
+        perror("fopen");
+        return FAILURE;
+    }
+
+    FileHeader header;
+    header_init(&header,ORDERS_FILE_MAGIC,sizeof(OrderDisk),set->count,0);
+    int ok = 1 == fwrite(&header,sizeof(header),1,fp);
+    if(ok && set->count > 0)
+        ok = (size_t)set->count == fwrite(set->items,sizeof(OrderDisk),set->count,fp);
+
+    if(!ok || fflush(fp) != 0 || fsync(fileno(fp)) != 0) {
+        perror("fwrite");
+        fclose(fp);
+        unlink(tmpname);
+        return FAILURE;
+    }
+    if(fclose(fp) != 0) {
+        perror("fclose");
+        unlink(tmpname);
+        return FAILURE;
+    }
+    if(rename(tmpname,filename) != 0) {
+        perror("rename");
+        unlink(tmpname);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 把订单记录与航班目录关联，建立订单链表
+ *
+ * 航班数据取自当前航班目录，票价为实付票价；
+ * 航班已被删除或航班数据无法加载时只显示航班号和票价。
+ *
+ * @param set 有效订单数组
+ * @param h 订单链表头节点（结果追加到尾部）
+ */
+static void join_orders(const OrderSet* set, FlightNode* h)
+{
+    int ready = list_ensure() == SUCCESS;
+    for(int i = 0; i < set->count; i++) {
+        const OrderDisk* ev = &set->items[i];
+        Flight_n flight;
+        short dep = TIME_INVALID, arr = TIME_INVALID;
+        FlightNode* node = ready ? index_find(ev->number) : NULL;
+        if(node) {
+            flight = node->flight;
+            dep = node->departure_minutes;
+            arr = node->arrival_minutes;
+        } else {
+            memset(&flight,0,sizeof(flight));
+            strcpy(flight.number,ev->number);
+        }
+        flight.price = ev->price;
+        flight.seat = ev->seat;
+        tail_insert_times(h,&flight,dep,arr);
+    }
+}
+
+/**
+ * @brief 确保订单文件为当前格式（不存在则创建，旧版则转换）
+ *
+ * @param filename 订单文件路径
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int prepare_order_file(const char* filename)
+{
+    OrderReader r;
+    int ret = order_open(filename,&r);
+    if(ret == SUCCESS) {
+        int version = r.version;
+        order_close(&r);
+        if(version == RECORD_VERSION)
+            return SUCCESS;
+    } else if(ret != ERR_NOT_FOUND) {
+        return FAILURE;
+    }
+
+    // 新文件、空文件或旧版文件：读出全部订单后以当前格式重写
+    return compact_order_file(filename);
+}
+
+/**
+ * @brief 把待写入的事件追加到订单文件
+ *
+ * 所有事件一次写到文件末尾，再更新文件头中的事件数并fdatasync，
+ * 耗时与已有订单数无关。
+ *
+ * @param filename 订单文件路径
+ * @param events 事件数组
+ * @param n 事件数
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int append_order_events(const char* filename, const OrderDisk* events, int n)
+{
+    if(prepare_order_file(filename) != SUCCESS)
+        return FAILURE;
+
+    int fd = open(filename,O_RDWR);
+    if(fd < 0) {
+        perror("open");
+        return FAILURE;
+    }
+    // 事件数按文件长度计算（文件头中的事件数可能落后于崩溃前追加的事件）
+    struct stat st;
+    if(fstat(fd,&st) != 0) {
+        perror("fstat");
+        close(fd);
+        return FAILURE;
+    }
+    uint64_t count = (st.st_size - sizeof(FileHeader)) / sizeof(OrderDisk);
+    off_t end = sizeof(FileHeader) + count * sizeof(OrderDisk);
+    ssize_t size = (ssize_t)n * sizeof(OrderDisk);
+    if(pwrite(fd,events,size,end) != size ||
+       header_write(fd,ORDERS_FILE_MAGIC,sizeof(OrderDisk),count + n,0) != SUCCESS ||
+       fdatasync(fd) != 0) {
+        // 提交失败：截掉可能已写入的事件，避免之后读出未提交的订单
+        perror("pwrite");
+        if(ftruncate(fd,end) != 0)
+            perror("ftruncate");
+        close(fd);
+        return FAILURE;
+    }
+    close(fd);
+    return SUCCESS;
+}
+
+/**
+ * @brief 把订单文件截断到最后一个有效事件之后（与航班日志重放时一样）
+ *
+ * 读取订单文件时遇到残缺或校验失败的事件即停止，其后追加的事件永远读不到，
+ * 因此追加之前先截掉损坏的记录及其后内容，并更新文件头中的事件数。
+ *
+ * @param filename 订单文件路径
+ * @param valid 最后一个有效事件之后的偏移
+ * @return int 成功返回SUCCESS（文件没有损坏时不做修改），失败返回FAILURE
+ */
+static int truncate_order_file(const char* filename, size_t valid)
+{
+    int fd = open(filename,O_RDWR);
+    if(fd < 0) {
+        perror("open");
+        return FAILURE;
+    }
+    struct stat st;
+    int ret = SUCCESS;
+    if(fstat(fd,&st) != 0) {
+        perror("fstat");
+        ret = FAILURE;
+    } else if(valid >= sizeof(FileHeader) && (size_t)st.st_size > valid) {
+        fprintf(stderr,"订单文件%s末尾有残缺或损坏的记录，已截掉\n",filename);
+        if(ftruncate(fd,valid) != 0 ||
+           header_write(fd,ORDERS_FILE_MAGIC,sizeof(OrderDisk),(valid - sizeof(FileHeader)) / sizeof(OrderDisk),0) != SUCCESS ||
+           fdatasync(fd) != 0) {
+            perror("ftruncate");
+            ret = FAILURE;
+        }
+    }
+    close(fd);
+    return ret;
+}
+
+/**
+ * @brief 登录时加载用户订单（每次登录只读一次订单文件）
+ *
+ * 折叠订单文件中的购票/退票事件，结果保存在会话订单缓存中，
+ * 之后的查看、购票和退票都在内存中进行。旧版文件顺带转换为当前格式。
  * 文件路径格式：data/order/{用户名}.txt
- * 
+ *
  * @return int 执行结果：
- *             SUCCESS(0) - 更新成功 
+ *             SUCCESS(0) - 加载成功（没有订单文件视为没有订单）
  *             FAILURE(-1) - 文件操作失败
  */
-int update_user_order()
-{
-    // 构建订单文件名
-    char filename[50];
-    sprintf(filename,"data/order/%s.txt",user->username);
-    
-    FILE* fp;
-    fp=fopen(filename,"w");  // 以写入模式打开文件
-    if(fp==NULL)
-    {    
-        perror("fopen");    // 输出文件打开错误信息
-        printf("错误代码：%d\n",errno);
-        fclose(fp);
+int order_session_open()
+{
+    order_session_close();
+    order_filename(current->file,user->username);
+
+    int legacy;
+    size_t valid;
+    int ret = fold_order_file(current->file,&current->orders,&current->events,&legacy,&current->seq,&valid);
+    if(ret == ERR_NOT_FOUND)
+        return SUCCESS;
+    if(ret != SUCCESS)
         return FAILURE;
+    // 第1版文件没有事件序号，直接转换为当前格式
+    if(legacy) {
+        if(write_order_file(current->file,&current->orders) == SUCCESS)
+            current->events = current->orders.count;
+        return SUCCESS;
     }
-    
-    // 遍历用户订单链表
-    FlightNode* p=user->userorders->next;
-    while(p)
-    {
-        // 将航班数据写入文件
-        if(1!=fwrite(&p->flight,sizeof(Flight_n),1,fp)){
-            printf("fwrite error\n");
-            fclose(fp);
-            return FAILURE;
+    // 截掉损坏的记录及其后内容，之后追加的事件才能被读到
+    return truncate_order_file(current->file,valid);
+}
+
+/**
+ * @brief 购票：把订单加入指定会话并登记待写入的事件
+ *
+ * 调用order_session_commit()后事件才写入文件。会话不加锁，多线程时由调用方串行化。
+ *
+ * @param s 会话
+ * @param number 航班号
+ * @param price 实付票价（分）
+ * @param seat 座位号（未分配为SEAT_NONE）
+ * @return int 成功返回SUCCESS，内存不足返回FAILURE
+ */
+int order_session_book(OrderSession* s, const char* number, Money price, int seat)
+{
+    OrderDisk ev;
+    order_record(ORDER_BOOK,number,price,(int64_t)time(NULL),seat,&ev);
+    if(order_set_add(&s->pending,&ev) != SUCCESS)
+        return FAILURE;
+    if(order_set_add(&s->orders,&ev) != SUCCESS) {
+        s->pending.count--;
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 退票：从指定会话删除第一个航班号相同的订单并登记待写入的事件
+ *
+ * 退票事件记录被退订单的实付票价和座位号。调用order_session_commit()后事件才写入文件。
+ *
+ * @param s 会话
+ * @param number 航班号
+ * @param price 输出：被退订单的实付票价（可为NULL）
+ * @param seat 输出：被退订单的座位号（可为NULL）
+ * @return int 成功返回SUCCESS，没有该航班的订单返回ERR_NOT_FOUND，内存不足返回FAILURE
+ */
+int order_session_refund(OrderSession* s, const char* number, Money* price, int* seat)
+{
+    OrderDisk booked, ev;
+    int i = 0;
+    while(i < s->orders.count && strcmp(s->orders.items[i].number,number))
+        i++;
+    if(i == s->orders.count)
+        return ERR_NOT_FOUND;
+    booked = s->orders.items[i];
+    order_record(ORDER_REFUND,booked.number,booked.price,(int64_t)time(NULL),booked.seat,&ev);
+    if(order_set_add(&s->pending,&ev) != SUCCESS)
+        return FAILURE;
+    if(price)
+        *price = booked.price;
+    if(seat)
+        *seat = booked.seat;
+    return order_set_remove(&s->orders,number,NULL);
+}
+
+/**
+ * @brief 提交点：把指定会话中待写入的事件一次追加到订单文件
+ *
+ * 事件按顺序编号（接在已用的最大序号之后）。一次操作的全部事件（如中转方案的各航段）
+ * 只做一次fdatasync。
+ *
+ * @param s 会话
+ * @return int 执行结果：
+ *             SUCCESS(0) - 写入成功（没有待写入的事件也视为成功）
+ *             FAILURE(-1) - 文件操作失败（事件保留，下次提交时重试）
+ */
+int order_session_commit(OrderSession* s)
+{
+    if(s->pending.count == 0)
+        return SUCCESS;
+    for(int i = 0; i < s->pending.count; i++) {
+        OrderDisk* ev = &s->pending.items[i];
+        ev->seq = s->seq + 1 + i;
+        ev->crc = record_crc(ev,sizeof(OrderDisk),offsetof(OrderDisk,crc));
+    }
+    if(append_order_events(s->file,s->pending.items,s->pending.count) != SUCCESS)
+        return FAILURE;
+    s->seq += s->pending.count;
+    s->events += s->pending.count;
+    s->pending.count = 0;
+    return SUCCESS;
+}
+
+/**
+ * @brief 统计订单文件末尾尚未计入余额的事件
+ *
+ * 从文件末尾向前读取序号大于settled的事件，耗时与未结算的事件数成正比。
+ * 购票事件扣款、退票事件退款；校验失败的事件及其后的事件读取时不可见，也不计入。
+ *
+ * @param s 会话
+ * @param settled 用户记录中已计入余额的最后一个事件序号
+ * @param delta 输出：未计入的余额变化（分）
+ * @param last 输出：计入后的最后一个事件序号（没有未结算的事件时为settled）
+ * @return int 成功返回SUCCESS，没有订单文件返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+int order_session_unsettled(OrderSession* s, uint32_t settled, Money* delta, uint32_t* last)
+{
+    *delta = 0;
+    *last = settled;
+
+    OrderReader r;
+    int ret = order_open(s->file,&r);
+    if(ret != SUCCESS)
+        return ret == ERR_NOT_FOUND ? ERR_NOT_FOUND : FAILURE;
+    // 第1版文件没有事件序号，全部已计入余额
+    if(r.version == RECORD_VERSION) {
+        size_t count = (r.size - sizeof(FileHeader)) / sizeof(OrderDisk);
+        for(size_t i = count; i-- > 0;) {
+            OrderDisk ev;
+            r.pos = sizeof(FileHeader) + i * sizeof(OrderDisk);
+            if(order_next(&r,&ev) != SUCCESS) {
+                *delta = 0;
+                *last = settled;
+                continue;
+            }
+            if(ev.seq <= settled)
+                break;
+            if(*last == settled)
+                *last = ev.seq;
+            if(ev.type == ORDER_BOOK)
+                *delta -= ev.price;
+            else if(ev.type == ORDER_REFUND)
+                *delta += ev.price;
         }
-        p=p->next;
-    }
-    
-    fclose(fp);  // 关闭文件
-    
-    // 释放用户订单链表内存（注意：后续操作不可再访问该链表）
-    //free(user->userorders);
-    
+    }
+    order_close(&r);
     return SUCCESS;
 }
 
 /**
- * @brief 从文件读取用户订单信息
- * 
- * 从用户订单文件中读取航班数据，构建用户订单链表。
- * 文件路径格式：data/order/{用户名}.txt
- * 
+ * @brief 记录用户余额已计入的最后一个事件序号
+ *
+ * 之后提交的事件从不小于该序号处编号；已提交的事件全部结算后，退出登录时才会压缩订单文件。
+ *
+ * @param s 会话
+ * @param seq 用户记录中的order_seq
+ */
+void order_session_settled(OrderSession* s, uint32_t seq)
+{
+    s->settled = seq;
+    if(s->seq < seq)
+        s->seq = seq;
+}
+
+/**
+ * @brief 会话已用的最大事件序号（提交后即最后一个事件的序号）
+ *
+ * @param s 会话
+ * @return uint32_t 事件序号
+ */
+uint32_t order_session_seq(const OrderSession* s)
+{
+    return s->seq;
+}
+
+/**
+ * @brief 撤销指定会话中尚未写入的事件（提交失败且扣款已撤回时调用）
+ *
+ * 购票事件的订单从会话删除，退票事件的订单重新加入会话。
+ *
+ * @param s 会话
+ */
+void order_session_discard(OrderSession* s)
+{
+    for(int i = s->pending.count - 1; i >= 0; i--) {
+        OrderDisk ev = s->pending.items[i];
+        if(ev.type == ORDER_BOOK) {
+            // 删除最后一条同航班号的订单（即本次加入的订单）
+            for(int j = s->orders.count - 1; j >= 0; j--) {
+                if(!strcmp(s->orders.items[j].number,ev.number)) {
+                    memmove(&s->orders.items[j],&s->orders.items[j + 1],
+                            (size_t)(s->orders.count - j - 1) * sizeof(OrderDisk));
+                    s->orders.count--;
+                    break;
+                }
+            }
+        } else {
+            OrderDisk booked;
+            order_record(ORDER_BOOK,ev.number,ev.price,ev.time,ev.seat,&booked);
+            order_set_add(&s->orders,&booked);
+        }
+    }
+    s->pending.count = 0;
+}
+
+/**
+ * @brief 购票：把订单加入当前会话缓存并登记待写入的事件
+ *
+ * 调用order_commit()后事件才写入文件。
+ *
+ * @param order 购买的航班（价格为实付票价）
+ * @return int 成功返回SUCCESS，内存不足返回FAILURE
+ */
+int order_book(const FlightNode* order)
+{
+    return order_session_book(current,order->flight.number,order->flight.price,SEAT_NONE);
+}
+
+/**
+ * @brief 退票：从当前会话缓存删除第一个航班号相同的订单并登记待写入的事件
+ *
+ * @param number 航班号
+ * @return int 成功返回SUCCESS，没有该航班的订单返回ERR_NOT_FOUND，内存不足返回FAILURE
+ */
+int order_refund(const char* number)
+{
+    return order_session_refund(current,number,NULL,NULL);
+}
+
+/**
+ * @brief 提交点：把当前会话中待写入的事件一次追加到订单文件
+ *
+ * @return int 执行结果：SUCCESS(0) - 写入成功；FAILURE(-1) - 文件操作失败（事件保留）
+ */
+int order_commit()
+{
+    return order_session_commit(current);
+}
+
+/**
+ * @brief 退出登录时关闭会话订单缓存
+ *
+ * 写入尚未提交的事件；已失效的事件数达到ORDER_COMPACT_MIN且多于有效订单数、
+ * 且全部事件都已计入余额时顺带压缩文件（压缩会丢弃退票事件和序号）。
+ *
+ * @return int 执行结果：
+ *             SUCCESS(0) - 关闭成功
+ *             FAILURE(-1) - 待写入的事件写入失败（已丢弃）
+ */
+int order_session_close()
+{
+    int ret = SUCCESS;
+    if(current->file[0] != '\0') {
+        ret = order_commit();
+        int dead = current->events - current->orders.count;
+        if(ret == SUCCESS && dead >= ORDER_COMPACT_MIN && dead > current->orders.count &&
+           current->settled >= current->seq)
+            write_order_file(current->file,&current->orders);
+    }
+    free(current->orders.items);
+    free(current->pending.items);
+    memset(&current->orders,0,sizeof(current->orders));
+    memset(&current->pending,0,sizeof(current->pending));
+    current->events = 0;
+    current->seq = current->settled = 0;
+    current->file[0] = '\0';
+    return ret;
+}
+
+/**
+ * @brief 创建一个空的会话订单缓存（服务器模式每个登录用户一个）
+ *
+ * @return OrderSession* 成功返回会话，内存不足返回NULL
+ */
+OrderSession* order_session_create()
+{
+    OrderSession* s = (OrderSession*)calloc(1,sizeof(OrderSession));
+    if(s == NULL)
+        perror("order session calloc");
+    return s;
+}
+
+/**
+ * @brief 释放会话订单缓存（先调用order_session_close()写入未提交的事件）
+ *
+ * @param s 会话（不能是当前会话）
+ */
+void order_session_destroy(OrderSession* s)
+{
+    if(s == NULL || s == &default_session)
+        return;
+    free(s->orders.items);
+    free(s->pending.items);
+    free(s);
+}
+
+/**
+ * @brief 切换订单函数操作的会话
+ *
+ * 之后的order_session_open()、order_book()、order_refund()、order_commit()、
+ * order_session_close()和read_from_order()都作用于该会话。
+ *
+ * @param s 会话（NULL表示交互模式使用的默认会话）
+ * @return OrderSession* 之前的会话
+ */
+OrderSession* order_session_bind(OrderSession* s)
+{
+    OrderSession* prev = current;
+    current = s ? s : &default_session;
+    return prev;
+}
+
+/**
+ * @brief 订单函数当前操作的会话
+ *
+ * @return OrderSession* 当前会话
+ */
+OrderSession* order_session_current()
+{
+    return current;
+}
+
+/**
+ * @brief 压缩用户订单文件
+ *
+ * 把购票/退票事件折叠后重写为每个有效订单一条购票事件。
+ *
  * @return int 执行结果：
- *             SUCCESS(0) - 读取成功
+ *             SUCCESS(0) - 压缩成功
  *             FAILURE(-1) - 文件操作失败
  */
+int compact_user_order()
+{
+    char filename[ORDER_PATH_MAX];
+    order_filename(filename,user->username);
+    return compact_order_file(filename);
+}
+
+/**
+ * @brief 压缩指定订单文件（旧版文件同时转换为当前格式）
+ *
+ * @param filename 订单文件路径
+ * @return int 执行结果：
+ *             SUCCESS(0) - 压缩成功（文件不存在时创建空订单文件）
+ *             FAILURE(-1) - 文件操作失败
+ */
+int compact_order_file(const char* filename)
+{
+    OrderSet set = {NULL,0,0};
+    int ret = fold_order_file(filename,&set,NULL,NULL,NULL,NULL);
+    if(ret == SUCCESS || ret == ERR_NOT_FOUND)
+        ret = write_order_file(filename,&set);
+    free(set.items);
+    return ret;
+}
+
+/**
+ * @brief 由会话订单缓存建立用户订单链表（不读文件）
+ *
+ * 订单与航班目录关联，显示当前的航班信息和实付票价。
+ *
+ * @return int 执行结果：
+ *             SUCCESS(0) - 建立成功
+ *             FAILURE(-1) - 内存不足
+ */
 int read_from_order()
 {
-    // 创建空的订单链表头节点
+    // 重建订单链表（释放之前建立的订单链表）
+    if(user->userorders)
+        free_node(&user->userorders);
     user->userorders=createHead();
-    
-    // 构建订单文件名
-    char filename[50];
-    sprintf(filename,"data/order/%s.txt",user->username);
-    
-    FILE* fp;
-    fp=fopen(filename,"r");  // 以读取模式打开文件
-    if(fp==NULL)
-    {    
-        // 处理文件不存在的情况（错误码2表示文件不存在）
-        if(errno==2) return SUCCESS;  // 文件不存在视为空订单
-        fclose(fp);
+    if(user->userorders == NULL)
         return FAILURE;
-    }
-    
-    Flight_n flight;  // 临时存储读取的航班数据
-    
-    // 循环读取文件中的航班数据
-    while(1==fread(&flight,sizeof(Flight_n),1,fp))
-    {
-        // 将读取的航班插入链表尾部
-        tail_insert(user->userorders,&flight);
-    }
-    
-    // 检查是否正常到达文件末尾
-    if(feof(fp)!=1)
-    {
-        perror("fread");  // 输出文件读取错误
-        fclose(fp);
+    join_orders(&current->orders,user->userorders);
+    return SUCCESS;
+}
+
+/**
+ * @brief 统计订单文件中的有效订单
+ *
+ * 在只读映射中直接累加购票/退票事件的金额，不关联航班目录也不建立订单链表。
+ *
+ * @param filename 订单文件路径
+ * @param orders 输出：有效订单数
+ * @param spent 输出：有效订单总金额（分）
+ * @return int 执行结果：
+ *             SUCCESS(0) - 统计成功
+ *             FAILURE(-1) - 文件操作失败
+ */
+int read_order_summary(const char* filename, int* orders, Money* spent)
+{
+    *orders = 0;
+    *spent = 0;
+
+    OrderReader r;
+    if(order_open(filename,&r) != SUCCESS)
         return FAILURE;
+
+    OrderDisk ev;
+    while(order_next(&r,&ev) == SUCCESS) {
+        // 退票事件记录被退订单的实付票价，金额可直接抵扣
+        if(ev.type == ORDER_BOOK) {
+            (*orders)++;
+            *spent += ev.price;
+        } else if(ev.type == ORDER_REFUND) {
+            (*orders)--;
+            *spent -= ev.price;
+        }
     }
-    
-    fclose(fp);  // 关闭文件
-    
+    order_close(&r);
     return SUCCESS;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 把data/order下所有订单文件转换为当前格式
+ *
+ * 已是当前格式的文件保持不变。
+ *
+ * @return int 转换的文件数，失败返回FAILURE
+ */
+int migrate_order_files()
+{
+    DIR* dir = opendir("data/order");
+    if(dir == NULL) {
+        if(errno == ENOENT) return 0;
+        perror("opendir");
+        return FAILURE;
+    }
+
+    int converted = 0;
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if(len < 5 || len - 4 >= U || strcmp(entry->d_name + len - 4,".txt"))
+            continue;
+        char filename[ORDER_PATH_MAX];
+        if(snprintf(filename,sizeof(filename),"data/order/%s",entry->d_name) >= (int)sizeof(filename))
+            continue;
+
+        OrderReader r;
+        if(order_open(filename,&r) != SUCCESS)
+            continue;
+        int legacy = r.version != RECORD_VERSION;
+        order_close(&r);
+        if(!legacy)
+            continue;
+        if(compact_order_file(filename) != SUCCESS) {
+            closedir(dir);
+            return FAILURE;
+        }
+        converted++;
+    }
+    closedir(dir);
+    return converted;
+}
+
+/**
+ * @brief 按data/order下全部订单文件重新统计各航班的已售座位数和座位图
+ *
+ * 旧版航班数据没有座位库存或座位图，转换为当前格式时调用一次；
+ * 已删除航班的订单不计入，旧版订单没有座位号，只计入已售座位数。
+ *
+ * @return int 计入的订单数，失败返回FAILURE
+ */
+int order_count_seats()
+{
+    for(FlightHandle h = catalog_first(); h != INVALID_HANDLE; h = catalog_next(h)) {
+        catalog_node(h)->flight.sold = 0;
+        seatmap_free(catalog_node(h));
+    }
+
+    DIR* dir = opendir("data/order");
+    if(dir == NULL) {
+        if(errno == ENOENT) return 0;
+        perror("opendir");
+        return FAILURE;
+    }
+
+    int counted = 0;
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if(len < 5 || len - 4 >= U || strcmp(entry->d_name + len - 4,".txt"))
+            continue;
+        char filename[ORDER_PATH_MAX];
+        if(snprintf(filename,sizeof(filename),"data/order/%s",entry->d_name) >= (int)sizeof(filename))
+            continue;
+
+        OrderSet set = {0};
+        if(fold_order_file(filename,&set,NULL,NULL,NULL,NULL) == SUCCESS) {
+            for(int i = 0; i < set.count; i++) {
+                FlightNode* node = index_find(set.items[i].number);
+                if(node) {
+                    node->flight.sold++;
+                    if(set.items[i].seat != SEAT_NONE)
+                        seat_take(node,set.items[i].seat);
+                    counted++;
+                }
+            }
+        }
+        free(set.items);
+    }
+    closedir(dir);
+    return counted;
+}
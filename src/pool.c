@@ -0,0 +1,193 @@
+#include "../include/head.h"
+
+/**
+ * @struct node_slab
+ * @brief 节点池块：连续存放的一组节点
+ */
+typedef struct node_slab
+{
+    struct node_slab *next;            ///< 下一块
+    FlightNode nodes[NODE_POOL_SLAB];  ///< 节点数组
+} NodeSlab;
+
+/**
+ * @struct arena_chunk
+ * @brief 临时内存区块
+ */
+typedef struct arena_chunk
+{
+    struct arena_chunk *prev; ///< 前一块（按分配顺序成栈）
+    size_t size;              ///< 数据区字节数
+    size_t used;              ///< 已用字节数
+    max_align_t data[];       ///< 数据区
+} ArenaChunk;
+
+static NodeSlab *slabs = NULL;         // 已分配的节点块
+static FlightNode *free_nodes = NULL;  // 空闲节点链表（经next链接）
+static ArenaChunk *arena_top = NULL;   // 临时内存区当前块
+static ArenaChunk *arena_spare = NULL; // 已释放待复用的块（经prev链接）
+
+/**
+ * @brief 从节点池取一个节点
+ *
+ * 空闲链表为空时整块分配NODE_POOL_SLAB个节点，之后分配和归还都只是指针操作。
+ *
+ * @return FlightNode* 成功返回节点指针（内容未初始化），失败返回NULL
+ */
+FlightNode *node_pool_alloc()
+{
+    if (free_nodes == NULL)
+    {
+        NodeSlab *slab = (NodeSlab *)malloc(sizeof(NodeSlab));
+        if (slab == NULL)
+        {
+            perror("node pool malloc");
+            return NULL;
+        }
+        slab->next = slabs;
+        slabs = slab;
+        for (int i = NODE_POOL_SLAB - 1; i >= 0; i--)
+        {
+            slab->nodes[i].next = free_nodes;
+            free_nodes = &slab->nodes[i];
+        }
+    }
+    FlightNode *node = free_nodes;
+    free_nodes = node->next;
+    return node;
+}
+
+/**
+ * @brief 归还一个节点
+ *
+ * @param node 节点指针（由node_pool_alloc()取得）
+ */
+void node_pool_free(FlightNode *node)
+{
+    if (node == NULL)
+        return;
+    node->next = free_nodes;
+    free_nodes = node;
+}
+
+/**
+ * @brief 归还整条链表（含头节点）
+ *
+ * 链表节点已经经next链接，找到尾节点后整体接到空闲链表前面，不逐个释放。
+ * 头节点prev记录的尾节点作为查找起点。
+ *
+ * @param head 链表头节点
+ */
+void node_pool_free_list(FlightNode *head)
+{
+    if (head == NULL)
+        return;
+    FlightNode *tail = head->prev ? head->prev : head;
+    while (tail->next)
+        tail = tail->next;
+    tail->next = free_nodes;
+    free_nodes = head;
+}
+
+/**
+ * @brief 释放节点池全部内存（退出系统时调用，之后不得再使用池中节点）
+ */
+void node_pool_clear()
+{
+    while (slabs)
+    {
+        NodeSlab *next = slabs->next;
+        free(slabs);
+        slabs = next;
+    }
+    free_nodes = NULL;
+}
+
+/**
+ * @brief 分配临时内存
+ *
+ * 在当前块中顺序分配；空间不足时复用已释放的块或新分配一块，
+ * 超过ARENA_CHUNK_SIZE的请求单独成块。
+ *
+ * @param size 字节数
+ * @return void* 成功返回按max_align_t对齐的内存，失败返回NULL
+ */
+void *arena_alloc(size_t size)
+{
+    size = (size + sizeof(max_align_t) - 1) / sizeof(max_align_t) * sizeof(max_align_t);
+    if (arena_top == NULL || arena_top->size - arena_top->used < size)
+    {
+        // 在待复用的块中找足够大的一块
+        ArenaChunk **link = &arena_spare;
+        while (*link && (*link)->size < size)
+            link = &(*link)->prev;
+        ArenaChunk *chunk = *link;
+        if (chunk)
+        {
+            *link = chunk->prev;
+        }
+        else
+        {
+            size_t chunk_size = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+            chunk = (ArenaChunk *)malloc(sizeof(ArenaChunk) + chunk_size);
+            if (chunk == NULL)
+            {
+                perror("arena malloc");
+                return NULL;
+            }
+            chunk->size = chunk_size;
+        }
+        chunk->used = 0;
+        chunk->prev = arena_top;
+        arena_top = chunk;
+    }
+    void *p = (char *)arena_top->data + arena_top->used;
+    arena_top->used += size;
+    return p;
+}
+
+/**
+ * @brief 记录临时内存区当前位置
+ *
+ * @return ArenaMark 位置标记
+ */
+ArenaMark arena_mark()
+{
+    ArenaMark mark = {arena_top, arena_top ? arena_top->used : 0};
+    return mark;
+}
+
+/**
+ * @brief 释放标记之后分配的全部临时内存
+ *
+ * 标记之后新用的块移到待复用列表，不归还给系统。
+ *
+ * @param mark arena_mark()返回的位置标记
+ */
+void arena_release(ArenaMark mark)
+{
+    while (arena_top && arena_top != mark.chunk)
+    {
+        ArenaChunk *chunk = arena_top;
+        arena_top = chunk->prev;
+        chunk->prev = arena_spare;
+        arena_spare = chunk;
+    }
+    if (arena_top)
+        arena_top->used = mark.used;
+}
+
+/**
+ * @brief 释放临时内存区全部内存（退出系统时调用）
+ */
+void arena_clear()
+{
+    ArenaMark start = {NULL, 0};
+    arena_release(start);
+    while (arena_spare)
+    {
+        ArenaChunk *prev = arena_spare->prev;
+        free(arena_spare);
+        arena_spare = prev;
+    }
+}
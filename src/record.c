@@ -0,0 +1,332 @@
+#include "../include/head.h"
+
+static uint32_t crc_table[8][256];                 // CRC32查表（按8字节并行计算）
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT; // 查表只生成一次（多线程安全）
+
+/**
+ * @brief 生成CRC32查表（IEEE 802.3多项式）
+ */
+static void crc_init()
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        for (int t = 1; t < 8; t++)
+            crc_table[t][i] = (crc_table[t - 1][i] >> 8) ^ crc_table[0][crc_table[t - 1][i] & 0xFF];
+    }
+}
+
+/**
+ * @brief 累加计算CRC32
+ *
+ * 每次处理8字节，分段调用与一次计算结果相同（初值传0）。
+ *
+ * @param crc 之前数据的CRC（首段为0）
+ * @param data 数据
+ * @param len 字节数
+ * @return uint32_t 累加后的CRC
+ */
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len)
+{
+    pthread_once(&crc_once, crc_init);
+
+    const unsigned char *p = (const unsigned char *)data;
+    crc = ~crc;
+    while (len >= 8)
+    {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = crc_table[7][lo & 0xFF] ^ crc_table[6][(lo >> 8) & 0xFF] ^
+              crc_table[5][(lo >> 16) & 0xFF] ^ crc_table[4][lo >> 24] ^
+              crc_table[3][hi & 0xFF] ^ crc_table[2][(hi >> 8) & 0xFF] ^
+              crc_table[1][(hi >> 16) & 0xFF] ^ crc_table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--)
+        crc = crc_table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+/**
+ * @brief 计算自带CRC字段的记录CRC（CRC字段按0计算）
+ *
+ * @param record 记录
+ * @param size 记录长度
+ * @param crc_offset CRC字段在记录中的偏移
+ * @return uint32_t 记录CRC
+ */
+uint32_t record_crc(const void *record, size_t size, size_t crc_offset)
+{
+    static const uint32_t zero = 0;
+    uint32_t crc = crc32_update(0, record, crc_offset);
+    crc = crc32_update(crc, &zero, sizeof(zero));
+    return crc32_update(crc, (const char *)record + crc_offset + sizeof(zero), size - crc_offset - sizeof(zero));
+}
+
+/**
+ * @brief 填写文件头（含文件头CRC）
+ *
+ * @param h 文件头
+ * @param magic 文件标识（4字节）
+ * @param record_size 记录长度
+ * @param count 记录数
+ * @param payload_crc 全部记录的CRC（不校验时为0）
+ */
+void header_init(FileHeader *h, const char *magic, uint32_t record_size, uint64_t count, uint32_t payload_crc)
+{
+    memset(h, 0, sizeof(FileHeader));
+    memcpy(h->magic, magic, 4);
+    h->version = RECORD_VERSION;
+    h->header_size = sizeof(FileHeader);
+    h->endian = RECORD_ENDIAN;
+    h->record_size = record_size;
+    h->count = count;
+    h->payload_crc = payload_crc;
+    h->header_crc = record_crc(h, sizeof(FileHeader), offsetof(FileHeader, header_crc));
+}
+
+/**
+ * @brief 校验当前版本的文件头
+ *
+ * @param h 文件头
+ * @param magic 期望的文件标识
+ * @param record_size 期望的记录长度
+ * @return int 有效返回SUCCESS，不是该类文件返回ERR_NOT_FOUND，
+ *             标识相同但版本/字节序/长度/CRC不符返回ERR_INVALID_INPUT
+ */
+int header_check(const FileHeader *h, const char *magic, uint32_t record_size)
+{
+    if (memcmp(h->magic, magic, 4))
+        return ERR_NOT_FOUND;
+    if (h->version != RECORD_VERSION || h->header_size != sizeof(FileHeader) ||
+        h->endian != RECORD_ENDIAN || h->record_size != record_size ||
+        h->header_crc != record_crc(h, sizeof(FileHeader), offsetof(FileHeader, header_crc)))
+        return ERR_INVALID_INPUT;
+    return SUCCESS;
+}
+
+/**
+ * @brief 在文件开头写入文件头
+ *
+ * @param fd 文件描述符
+ * @param magic 文件标识
+ * @param record_size 记录长度
+ * @param count 记录数
+ * @param payload_crc 全部记录的CRC（不校验时为0）
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+int header_write(int fd, const char *magic, uint32_t record_size, uint64_t count, uint32_t payload_crc)
+{
+    FileHeader h;
+    header_init(&h, magic, record_size, count, payload_crc);
+    if (pwrite(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h))
+    {
+        perror("写入文件头失败");
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 航班转为磁盘记录
+ *
+ * @param f 航班数据
+ * @param dep 出发时间（分钟）
+ * @param arr 到达时间（分钟）
+ * @param d 输出：磁盘记录
+ */
+void flight_to_disk(const Flight_n *f, short dep, short arr, FlightDisk *d)
+{
+    memset(d, 0, sizeof(FlightDisk));
+    memcpy(d->number, f->number, sizeof(d->number));
+    d->airline = f->airline;
+    d->departure_airport = f->departure_airport;
+    d->arrival_airport = f->arrival_airport;
+    d->status = f->status;
+    d->seats_per_row = f->seats_per_row;
+    d->departure_minutes = dep;
+    d->arrival_minutes = arr;
+    d->price = f->price;
+    d->capacity = (uint16_t)f->capacity;
+    d->sold = (uint16_t)__atomic_load_n(&f->sold, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 分钟数转为"HH:MM"（无效时间为空串）
+ *
+ * @param minutes 当天分钟数
+ * @param text 输出缓冲区（至少6字节）
+ */
+static void format_minutes(short minutes, char *text)
+{
+    if (minutes >= 0 && minutes < 24 * 60)
+        sprintf(text, "%02d:%02d", minutes / 60, minutes % 60);
+    else
+        text[0] = '\0';
+}
+
+/**
+ * @brief 磁盘记录转为航班
+ *
+ * @param d 磁盘记录
+ * @param f 输出：航班数据
+ * @param dep 输出：出发时间（分钟，可为NULL）
+ * @param arr 输出：到达时间（分钟，可为NULL）
+ */
+void flight_from_disk(const FlightDisk *d, Flight_n *f, short *dep, short *arr)
+{
+    memset(f, 0, sizeof(Flight_n));
+    memcpy(f->number, d->number, sizeof(f->number));
+    f->number[sizeof(f->number) - 1] = '\0';
+    format_minutes(d->departure_minutes, f->departure_time);
+    format_minutes(d->arrival_minutes, f->arrival_time);
+    f->airline = d->airline;
+    f->departure_airport = d->departure_airport;
+    f->arrival_airport = d->arrival_airport;
+    f->status = d->status < STATUS_KINDS ? d->status : STATUS_UNKNOWN;
+    f->seats_per_row = d->seats_per_row <= SEAT_ROW_MAX ? d->seats_per_row : 0;
+    f->price = d->price;
+    f->capacity = d->capacity > 0 && d->capacity <= FLIGHT_CAPACITY_MAX ? d->capacity : FLIGHT_DEFAULT_CAPACITY;
+    f->sold = d->sold;
+    if (dep)
+        *dep = d->departure_minutes;
+    if (arr)
+        *arr = d->arrival_minutes;
+}
+
+/**
+ * @brief 定宽字段转为名称字符串（字段可能没有结束符）
+ *
+ * @param name 输出缓冲区（DICT_NAME_MAX字节）
+ * @param field 定宽字段
+ * @param size 字段长度
+ */
+static void field_name(char *name, const char *field, size_t size)
+{
+    size_t n = strnlen(field, size);
+    if (n >= DICT_NAME_MAX)
+        n = DICT_NAME_MAX - 1;
+    memcpy(name, field, n);
+    name[n] = '\0';
+}
+
+/**
+ * @brief 把字符串形式的航空公司、机场和状态登记到字典
+ *
+ * @param airline 航空公司名（定宽字段）
+ * @param airline_size 航空公司字段长度
+ * @param dep 出发机场名（10字节定宽字段）
+ * @param arr 到达机场名（10字节定宽字段）
+ * @param status 状态名（10字节定宽字段，无法识别时为STATUS_UNKNOWN）
+ * @param f 输出：航班数据
+ * @return int 成功返回SUCCESS，登记失败返回FAILURE
+ */
+static int intern_fields(const char *airline, size_t airline_size, const char *dep, const char *arr,
+                         const char *status, Flight_n *f)
+{
+    char name[DICT_NAME_MAX];
+    FlightStatus st = STATUS_UNKNOWN;
+
+    field_name(name, airline, airline_size);
+    f->airline = dict_intern(DICT_AIRLINE, name);
+    field_name(name, dep, 10);
+    f->departure_airport = dict_intern(DICT_AIRPORT, name);
+    field_name(name, arr, 10);
+    f->arrival_airport = dict_intern(DICT_AIRPORT, name);
+    field_name(name, status, 10);
+    status_parse(name, &st);
+    f->status = st;
+    if (f->airline == DICT_NONE || f->departure_airport == DICT_NONE || f->arrival_airport == DICT_NONE)
+        return FAILURE;
+    return SUCCESS;
+}
+
+/**
+ * @brief 第1版航班数据转为航班（时间规范化为"HH:MM"，名称登记到字典）
+ *
+ * @param l 旧版航班数据
+ * @param f 输出：航班数据（时间无效时为空串）
+ * @return int 成功返回SUCCESS，登记失败返回FAILURE
+ */
+int flight_from_legacy(const LegacyFlight *l, Flight_n *f)
+{
+    char text[DICT_NAME_MAX];
+    short minutes;
+
+    memset(f, 0, sizeof(Flight_n));
+    memcpy(f->number, l->number, sizeof(f->number));
+    f->number[sizeof(f->number) - 1] = '\0';
+    field_name(text, l->departure_time, sizeof(l->departure_time));
+    if (parse_time(text, &minutes) == SUCCESS)
+        strcpy(f->departure_time, text);
+    field_name(text, l->arrival_time, sizeof(l->arrival_time));
+    if (parse_time(text, &minutes) == SUCCESS)
+        strcpy(f->arrival_time, text);
+    f->price = money_from_double(l->price);
+    f->capacity = FLIGHT_DEFAULT_CAPACITY;
+    return intern_fields(l->airline, sizeof(l->airline), l->departure_airport, l->arrival_airport, l->status, f);
+}
+
+/**
+ * @brief 用户转为磁盘记录（含记录CRC，不含订单链表指针）
+ *
+ * @param u 用户
+ * @param d 输出：磁盘记录
+ */
+void user_to_disk(const User *u, UserDisk *d)
+{
+    memset(d, 0, sizeof(UserDisk));
+    memcpy(d->username, u->username, sizeof(d->username));
+    memcpy(d->password, u->password, sizeof(d->password));
+    d->username[U - 1] = '\0';
+    d->password[P - 1] = '\0';
+    d->type = u->type;
+    d->balance = u->balance;
+    d->order_seq = u->order_seq;
+    d->crc = record_crc(d, sizeof(UserDisk), offsetof(UserDisk, crc));
+}
+
+/**
+ * @brief 磁盘记录转为用户（订单链表指针置空）
+ *
+ * @param d 磁盘记录
+ * @param u 输出：用户
+ */
+void user_from_disk(const UserDisk *d, User *u)
+{
+    memset(u, 0, sizeof(User));
+    memcpy(u->username, d->username, sizeof(u->username));
+    memcpy(u->password, d->password, sizeof(u->password));
+    u->username[U - 1] = '\0';
+    u->password[P - 1] = '\0';
+    u->type = (Permission)d->type;
+    u->balance = d->balance;
+    u->order_seq = d->order_seq;
+    u->userorders = NULL;
+}
+
+/**
+ * @brief 第1版用户数据转为用户（余额四舍五入到分）
+ *
+ * @param l 旧版用户数据
+ * @param u 输出：用户
+ */
+void user_from_legacy(const LegacyUser *l, User *u)
+{
+    memset(u, 0, sizeof(User));
+    memcpy(u->username, l->username, sizeof(u->username));
+    memcpy(u->password, l->password, sizeof(u->password));
+    u->username[U - 1] = '\0';
+    u->password[P - 1] = '\0';
+    u->type = (Permission)l->type;
+    u->balance = money_from_double(l->balance);
+}
@@ -0,0 +1,411 @@
+#include "../include/head.h"
+
+#define SEAT_WINDOW_STEP (64 - SEAT_ROW_MAX) // 每个64位窗口中作为座位块起点的位数（余下的位留给跨窗口的座位块）
+
+/**
+ * 各布局中后面是过道的列：第c位为1表示第c列与第c+1列之间是过道
+ */
+static const unsigned short aisle_after[SEAT_ROW_MAX + 1] = {
+    0,               // 未使用
+    0,               // 1
+    1 << 0,          // 2：1-1
+    1 << 0,          // 3：1-2
+    1 << 1,          // 4：2-2
+    1 << 1,          // 5：2-3
+    1 << 2,          // 6：3-3
+    1 << 1 | 1 << 4, // 7：2-3-2
+    1 << 1 | 1 << 5, // 8：2-4-2
+    1 << 2 | 1 << 5, // 9：3-3-3
+    1 << 2 | 1 << 6, // 10：3-4-3
+};
+
+/**
+ * @brief 航班每排座位数（未指定或无效时为默认值）
+ *
+ * @param f 航班
+ * @return int 每排座位数
+ */
+int seat_row_size(const Flight_n *f)
+{
+    return f->seats_per_row >= 1 && f->seats_per_row <= SEAT_ROW_MAX ? f->seats_per_row : SEAT_DEFAULT_PER_ROW;
+}
+
+/**
+ * @brief 座位图的64位字数
+ *
+ * @param capacity 座位数
+ * @return int 字数
+ */
+static int seatmap_words(int capacity)
+{
+    return (capacity + 63) / 64;
+}
+
+/**
+ * @brief 选座偏好对应的列集合
+ *
+ * @param per 每排座位数
+ * @param pref 选座偏好
+ * @return unsigned int 第c位为1表示第c列满足偏好
+ */
+static unsigned int pref_columns(int per, SeatPref pref)
+{
+    unsigned int all = (1u << per) - 1;
+    switch (pref)
+    {
+    case SEAT_WINDOW:
+        return 1u | 1u << (per - 1);
+    case SEAT_AISLE:
+        return (aisle_after[per] | aisle_after[per] << 1) & all;
+    default:
+        return all;
+    }
+}
+
+/**
+ * @brief 可作为count个相邻座位起点的列集合
+ *
+ * 座位块不跨排、不跨过道，并且至少有一个座位在prefer列中。
+ *
+ * @param per 每排座位数
+ * @param count 座位数
+ * @param prefer 偏好的列集合
+ * @return unsigned int 第c位为1表示可以从第c列开始
+ */
+static unsigned int block_columns(int per, int count, unsigned int prefer)
+{
+    unsigned int span = (1u << count) - 1;
+    unsigned int starts = 0;
+    for (int c = 0; c + count <= per; c++)
+    {
+        // 块内除最后一列外，其后都不能是过道
+        if ((aisle_after[per] & (span >> 1) << c) == 0 && (span << c & prefer))
+            starts |= 1u << c;
+    }
+    return starts;
+}
+
+/**
+ * @brief 把列集合展开为64位窗口的掩码
+ *
+ * @param columns 列集合
+ * @param per 每排座位数
+ * @param phase 窗口第0位所在的列
+ * @return uint64_t 第j位为1表示窗口第j位（第 (phase + j) % per 列）在集合中
+ */
+static uint64_t column_mask(unsigned int columns, int per, int phase)
+{
+    uint64_t mask = (uint64_t)columns >> phase;
+    for (int j = per - phase; j < 64; j += per)
+        mask |= (uint64_t)columns << j;
+    return mask;
+}
+
+/**
+ * @brief 取座位图从第bit位开始的64位（座位图以外为0）
+ *
+ * @param words 座位图（可为NULL）
+ * @param nwords 座位图字数
+ * @param bit 起始位
+ * @return uint64_t 第j位为座位bit + j的占用位
+ */
+static uint64_t window_at(const uint64_t *words, int nwords, int bit)
+{
+    int w = bit / 64, s = bit % 64;
+    uint64_t lo = w < nwords ? words[w] : 0;
+    if (s == 0)
+        return lo;
+    uint64_t hi = w + 1 < nwords ? words[w + 1] : 0;
+    return lo >> s | hi << (64 - s);
+}
+
+/**
+ * @brief 分配指定座位（第一次分配时建立座位图）
+ *
+ * @param node 主链表航班节点
+ * @param seat 座位号
+ * @return int 成功返回SUCCESS，座位号无效返回ERR_INVALID_INPUT，
+ *             已分配返回ERR_EXISTS，内存不足返回FAILURE
+ */
+int seat_take(FlightNode *node, int seat)
+{
+    if (seat < 0 || seat >= node->flight.capacity)
+        return ERR_INVALID_INPUT;
+    if (node->seats == NULL)
+    {
+        node->seats = (uint64_t *)calloc(seatmap_words(node->flight.capacity), sizeof(uint64_t));
+        if (node->seats == NULL)
+        {
+            perror("seatmap calloc");
+            return FAILURE;
+        }
+    }
+    uint64_t bit = UINT64_C(1) << seat % 64;
+    if (node->seats[seat / 64] & bit)
+        return ERR_EXISTS;
+    node->seats[seat / 64] |= bit;
+    return SUCCESS;
+}
+
+/**
+ * @brief 释放座位（座位号无效或未分配时忽略）
+ *
+ * @param node 主链表航班节点
+ * @param seat 座位号
+ */
+void seat_release(FlightNode *node, int seat)
+{
+    if (node->seats != NULL && seat >= 0 && seat < node->flight.capacity)
+        node->seats[seat / 64] &= ~(UINT64_C(1) << seat % 64);
+}
+
+/**
+ * @brief 座位是否已分配
+ *
+ * @param node 航班节点
+ * @param seat 座位号
+ * @return int 已分配返回1，否则返回0
+ */
+int seat_is_taken(const FlightNode *node, int seat)
+{
+    if (node->seats == NULL || seat < 0 || seat >= node->flight.capacity)
+        return 0;
+    return (node->seats[seat / 64] >> seat % 64) & 1;
+}
+
+/**
+ * @brief 查找同一排中相邻的count个空座位（首次适配）
+ *
+ * 按64位窗口扫描座位图：取反得到空位，空位与自身右移1至count-1位相与，
+ * 第j位为1即座位j起count个座位都空；再与可作起点的列掩码相与，ctz取第一个。
+ * 窗口每次前进SEAT_WINDOW_STEP位，座位块跨两个字时也能找到。
+ *
+ * @param node 航班节点
+ * @param count 座位数（1至每排座位数）
+ * @param pref 选座偏好（座位块中至少一个座位满足）
+ * @return int 第一个座位的座位号，没有满足条件的座位返回SEAT_NONE
+ */
+int seat_find(const FlightNode *node, int count, SeatPref pref)
+{
+    const Flight_n *f = &node->flight;
+    int per = seat_row_size(f);
+    if (count < 1 || count > per)
+        return SEAT_NONE;
+    unsigned int starts = block_columns(per, count, pref_columns(per, pref));
+    if (starts == 0)
+        return SEAT_NONE;
+
+    int nwords = node->seats ? seatmap_words(f->capacity) : 0;
+    for (int bit = 0; bit < f->capacity; bit += SEAT_WINDOW_STEP)
+    {
+        uint64_t vacant = ~window_at(node->seats, nwords, bit);
+        if (f->capacity - bit < 64)
+            vacant &= (UINT64_C(1) << (f->capacity - bit)) - 1; // 座位数以外不是空位
+        uint64_t run = vacant;
+        for (int j = 1; j < count; j++)
+            run &= vacant >> j;
+        run &= column_mask(starts, per, bit % per) & ((UINT64_C(1) << SEAT_WINDOW_STEP) - 1);
+        if (run)
+            return bit + __builtin_ctzll(run);
+    }
+    return SEAT_NONE;
+}
+
+/**
+ * @brief 已分配座位数
+ *
+ * @param node 航班节点
+ * @return int 座位图中为1的位数
+ */
+int seat_taken_count(const FlightNode *node)
+{
+    if (node->seats == NULL)
+        return 0;
+    int n = 0;
+    for (int w = seatmap_words(node->flight.capacity) - 1; w >= 0; w--)
+        n += __builtin_popcountll(node->seats[w]);
+    return n;
+}
+
+/**
+ * @brief 最大的已分配座位号
+ *
+ * @param node 航班节点
+ * @return int 座位号，没有已分配座位返回SEAT_NONE
+ */
+int seat_last_taken(const FlightNode *node)
+{
+    if (node->seats == NULL)
+        return SEAT_NONE;
+    for (int w = seatmap_words(node->flight.capacity) - 1; w >= 0; w--)
+    {
+        if (node->seats[w])
+            return w * 64 + 63 - __builtin_clzll(node->seats[w]);
+    }
+    return SEAT_NONE;
+}
+
+/**
+ * @brief 按新座位数调整座位图（修改座位数前调用）
+ *
+ * @param node 主链表航班节点
+ * @param capacity 新座位数
+ * @return int 成功返回SUCCESS，有已分配座位不在新座位数以内返回ERR_INVALID_INPUT，
+ *             内存不足返回FAILURE
+ */
+int seatmap_resize(FlightNode *node, int capacity)
+{
+    if (node->seats == NULL)
+        return SUCCESS;
+    if (seat_last_taken(node) >= capacity)
+        return ERR_INVALID_INPUT;
+    int old_words = seatmap_words(node->flight.capacity);
+    int new_words = seatmap_words(capacity);
+    if (new_words == old_words)
+        return SUCCESS;
+    uint64_t *grown = (uint64_t *)realloc(node->seats, new_words * sizeof(uint64_t));
+    if (grown == NULL)
+    {
+        perror("seatmap realloc");
+        return FAILURE;
+    }
+    if (new_words > old_words)
+        memset(grown + old_words, 0, (new_words - old_words) * sizeof(uint64_t));
+    node->seats = grown;
+    return SUCCESS;
+}
+
+/**
+ * @brief 释放座位图
+ *
+ * @param node 航班节点
+ */
+void seatmap_free(FlightNode *node)
+{
+    free(node->seats);
+    node->seats = NULL;
+}
+
+/**
+ * @brief 座位图保存所需字节数（每个座位1位）
+ *
+ * @param capacity 座位数
+ * @return size_t 字节数
+ */
+size_t seatmap_bytes(int capacity)
+{
+    return capacity > 0 ? (size_t)(capacity + 7) / 8 : 0;
+}
+
+/**
+ * @brief 座位图写为字节序列（座位i在第i / 8字节的第i % 8位，与本机字节序无关）
+ *
+ * @param node 航班节点
+ * @param bytes 输出缓冲区（seatmap_bytes(capacity)字节，没有座位图时全为0）
+ */
+void seatmap_store(const FlightNode *node, unsigned char *bytes)
+{
+    size_t n = seatmap_bytes(node->flight.capacity);
+    for (size_t i = 0; i < n; i++)
+        bytes[i] = node->seats ? (unsigned char)(node->seats[i / 8] >> (i % 8 * 8)) : 0;
+}
+
+/**
+ * @brief 由字节序列恢复座位图（替换原有座位图，全为0时不建立座位图）
+ *
+ * @param node 主链表航班节点
+ * @param bytes seatmap_store()写出的字节序列
+ * @return int 成功返回SUCCESS，内存不足返回FAILURE
+ */
+int seatmap_load(FlightNode *node, const unsigned char *bytes)
+{
+    seatmap_free(node);
+    size_t n = seatmap_bytes(node->flight.capacity);
+    size_t i = 0;
+    while (i < n && bytes[i] == 0)
+        i++;
+    if (i == n)
+        return SUCCESS;
+
+    node->seats = (uint64_t *)calloc(seatmap_words(node->flight.capacity), sizeof(uint64_t));
+    if (node->seats == NULL)
+    {
+        perror("seatmap calloc");
+        return FAILURE;
+    }
+    for (; i < n; i++)
+        node->seats[i / 8] |= (uint64_t)bytes[i] << (i % 8 * 8);
+    // 座位数以外的位不属于座位图
+    if (node->flight.capacity % 64)
+        node->seats[node->flight.capacity / 64] &= (UINT64_C(1) << node->flight.capacity % 64) - 1;
+    return SUCCESS;
+}
+
+/**
+ * @brief 解析座位名（排号加列字母，如"12A"，字母不分大小写）
+ *
+ * @param f 航班
+ * @param text 座位名
+ * @param seat 输出：座位号
+ * @return int 成功返回SUCCESS，格式错误或超出座位数返回ERR_INVALID_INPUT
+ */
+int seat_parse(const Flight_n *f, const char *text, int *seat)
+{
+    int row, n;
+    char letter;
+    if (sscanf(text, "%d%c%n", &row, &letter, &n) != 2 || text[n] != '\0' || row < 1)
+        return ERR_INVALID_INPUT;
+    if (letter >= 'a' && letter <= 'z')
+        letter -= 'a' - 'A';
+    int per = seat_row_size(f), col = letter - 'A';
+    if (col < 0 || col >= per || row > (f->capacity + per - 1) / per)
+        return ERR_INVALID_INPUT;
+    int s = (row - 1) * per + col;
+    if (s >= f->capacity)
+        return ERR_INVALID_INPUT;
+    *seat = s;
+    return SUCCESS;
+}
+
+/**
+ * @brief 座位号转为座位名
+ *
+ * @param f 航班
+ * @param seat 座位号（SEAT_NONE为"-"）
+ * @param text 输出缓冲区（至少SEAT_LABEL_MAX字节）
+ * @return char* text
+ */
+char *seat_label(const Flight_n *f, int seat, char *text)
+{
+    int per = seat_row_size(f);
+    if (seat < 0)
+        snprintf(text, SEAT_LABEL_MAX, "-");
+    else
+        snprintf(text, SEAT_LABEL_MAX, "%d%c", seat / per + 1, 'A' + seat % per);
+    return text;
+}
+
+/**
+ * @brief 显示座位图（空座位显示列字母，已分配显示x）
+ *
+ * @param node 航班节点
+ */
+void seatmap_display(const FlightNode *node)
+{
+    const Flight_n *f = &node->flight;
+    int per = seat_row_size(f);
+    printf("航班%s座位图（x为已售）：\n     ", f->number);
+    for (int c = 0; c < per; c++)
+        printf("%c %s", 'A' + c, aisle_after[per] >> c & 1 ? "  " : "");
+    printf("\n");
+    for (int row = 0; row * per < f->capacity; row++)
+    {
+        printf("%3d  ", row + 1);
+        for (int c = 0; c < per && row * per + c < f->capacity; c++)
+        {
+            int seat = row * per + c;
+            printf("%c %s", seat_is_taken(node, seat) ? 'x' : 'A' + c, aisle_after[per] >> c & 1 ? "  " : "");
+        }
+        printf("\n");
+    }
+}
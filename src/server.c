@@ -0,0 +1,616 @@
+#define _GNU_SOURCE // accept4()
+#include "../include/head.h"
+
+/**
+ * @struct session
+ * @brief 登录会话：一个用户的用户记录和订单缓存，由该用户的所有连接共用
+ */
+typedef struct session
+{
+    struct session *next;  ///< 同一哈希桶的下一个会话
+    User *user;            ///< 用户记录（余额等）
+    OrderSession *orders;  ///< 会话订单缓存
+    int refs;              ///< 使用该会话的连接数
+} Session;
+
+/**
+ * @struct connection
+ * @brief 客户端连接
+ */
+typedef struct connection
+{
+    struct connection *prev, *next; ///< 全部连接的双向链表
+    int fd;                         ///< 套接字
+    uint32_t events;                ///< 当前注册的epoll事件
+    Session *session;               ///< 登录会话（未登录为NULL）
+    char in[COMMAND_LINE_MAX];      ///< 尚未处理的请求数据
+    size_t in_len;                  ///< in中的字节数
+    char *out;                      ///< 待发送的应答
+    size_t out_len;                 ///< out中的字节数
+    size_t out_sent;                ///< 已发送的字节数
+    size_t out_cap;                 ///< out容量
+    int closing;                    ///< 不再读取请求，应答发完后关闭（quit、对端关闭写或请求过长）
+} Connection;
+
+static Session *sessions[SERVER_SESSION_BUCKETS]; // 会话哈希表（按用户名）
+static Connection *connections = NULL;            // 全部连接
+static int connection_count = 0;                  // 连接数
+static int epoll_fd = -1;                         // epoll实例
+static int listen_fd = -1;                        // 监听套接字
+static int accept_paused = 0;                     // 文件描述符用尽，暂停接受连接
+static FILE *reply = NULL;                        // 命令输出的内存流（每条请求复用）
+static char *reply_buf = NULL;                    // 内存流的缓冲区
+static size_t reply_size = 0;                     // 内存流的长度
+static volatile sig_atomic_t stopping = 0;        // 收到退出信号
+
+/**
+ * @brief 计算用户名哈希值（FNV-1a）
+ *
+ * @param username 用户名
+ * @return unsigned int 哈希值
+ */
+static unsigned int hash_username(const char *username)
+{
+    unsigned int h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)username; *p; p++)
+    {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief 退出信号处理：结束事件循环
+ */
+static void on_signal(int sig)
+{
+    (void)sig;
+    stopping = 1;
+}
+
+/**
+ * @brief 把打开文件数上限提高到硬上限（每个连接占一个文件描述符）
+ */
+static void raise_fd_limit()
+{
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max)
+    {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+/**
+ * @brief 切换到会话：设置全局当前用户和订单缓存
+ *
+ * 命令函数通过全局user和订单会话工作；事件循环是单线程的，
+ * 执行一条请求期间切换到该连接的会话，执行完切回。
+ *
+ * @param s 会话（NULL为未登录）
+ * @return OrderSession* 之前的订单会话
+ */
+static OrderSession *session_enter(Session *s)
+{
+    user = s ? s->user : NULL;
+    return order_session_bind(s ? s->orders : NULL);
+}
+
+/**
+ * @brief 离开会话：恢复全局状态
+ *
+ * @param prev session_enter()返回的订单会话
+ */
+static void session_leave(OrderSession *prev)
+{
+    user = NULL;
+    order_session_bind(prev);
+}
+
+/**
+ * @brief 连接退出登录：最后一个连接退出时写入订单并释放会话
+ *
+ * @param c 连接
+ * @return int 订单写入失败返回FAILURE，否则返回SUCCESS
+ */
+static int session_detach(Connection *c)
+{
+    Session *s = c->session;
+    c->session = NULL;
+    if (s == NULL || --s->refs > 0)
+        return SUCCESS;
+
+    // 从哈希表移除
+    Session **link = &sessions[hash_username(s->user->username) % SERVER_SESSION_BUCKETS];
+    while (*link != s)
+        link = &(*link)->next;
+    *link = s->next;
+
+    OrderSession *prev = session_enter(s);
+    int ret = log_off(); // 写入订单、关闭订单缓存并释放用户记录
+    session_leave(prev);
+    order_session_destroy(s->orders);
+    free(s);
+    return ret;
+}
+
+/**
+ * @brief 处理login请求
+ *
+ * 在新的订单缓存上执行登录命令；该用户已有会话时改用已有会话，
+ * 使同一用户的多个连接看到同一份余额和订单。
+ *
+ * @param c 连接
+ * @param line 请求
+ */
+static void session_login(Connection *c, char *line)
+{
+    session_detach(c);
+
+    Session tmp = {NULL, NULL, order_session_create(), 1};
+    if (tmp.orders == NULL)
+    {
+        command_reply(reply, FAILURE, NULL);
+        return;
+    }
+    OrderSession *prev = session_enter(&tmp);
+    int ret = command_execute(line, reply);
+    tmp.user = user;
+    session_leave(prev);
+    if (ret != SUCCESS)
+    {
+        order_session_destroy(tmp.orders);
+        return;
+    }
+
+    unsigned int bucket = hash_username(tmp.user->username) % SERVER_SESSION_BUCKETS;
+    Session *s = sessions[bucket];
+    while (s && strcmp(s->user->username, tmp.user->username))
+        s = s->next;
+    if (s)
+    {
+        // 已有会话：订单都已提交到文件，新读出的副本直接丢弃
+        order_session_destroy(tmp.orders);
+        free(tmp.user);
+        s->refs++;
+    }
+    else
+    {
+        s = (Session *)malloc(sizeof(Session));
+        if (s == NULL)
+        {
+            perror("session malloc");
+            prev = session_enter(&tmp);
+            log_off();
+            session_leave(prev);
+            order_session_destroy(tmp.orders);
+            return;
+        }
+        *s = tmp;
+        s->next = sessions[bucket];
+        sessions[bucket] = s;
+    }
+    c->session = s;
+}
+
+/**
+ * @brief 执行一条请求，应答写入reply
+ *
+ * @param c 连接
+ * @param line 请求（不含换行）
+ * @return int quit请求返回EXIT_SYSTEM，否则返回SUCCESS
+ */
+static int serve_request(Connection *c, char *line)
+{
+    char word[16] = "";
+    sscanf(line, "%15s", word);
+    if (!strcmp(word, "login"))
+    {
+        session_login(c, line);
+    }
+    else if (!strcmp(word, "logout"))
+    {
+        if (c->session == NULL)
+            command_reply(reply, FAILURE, "未登录");
+        else
+            command_reply(reply, session_detach(c), NULL);
+    }
+    else
+    {
+        OrderSession *prev = session_enter(c->session);
+        int ret = command_execute(line, reply);
+        session_leave(prev);
+        if (ret == EXIT_SYSTEM)
+            return EXIT_SYSTEM;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 把应答追加到连接的发送缓冲区
+ *
+ * @param c 连接
+ * @param data 数据
+ * @param n 字节数
+ * @return int 成功返回SUCCESS，内存不足返回FAILURE
+ */
+static int connection_queue(Connection *c, const char *data, size_t n)
+{
+    if (c->out_sent == c->out_len)
+        c->out_sent = c->out_len = 0;
+    if (c->out_len + n > c->out_cap)
+    {
+        // 先把已发送的部分移走，仍不够再扩容
+        if (c->out_sent > 0)
+        {
+            memmove(c->out, c->out + c->out_sent, c->out_len - c->out_sent);
+            c->out_len -= c->out_sent;
+            c->out_sent = 0;
+        }
+        if (c->out_len + n > c->out_cap)
+        {
+            size_t cap = c->out_cap ? c->out_cap : 1024;
+            while (cap < c->out_len + n)
+                cap *= 2;
+            char *out = (char *)realloc(c->out, cap);
+            if (out == NULL)
+            {
+                perror("connection realloc");
+                return FAILURE;
+            }
+            c->out = out;
+            c->out_cap = cap;
+        }
+    }
+    memcpy(c->out + c->out_len, data, n);
+    c->out_len += n;
+    return SUCCESS;
+}
+
+/**
+ * @brief 执行缓冲区中完整的请求行
+ *
+ * 待发送数据超过SERVER_OUTPUT_LIMIT时暂停，等应答发出后继续。
+ *
+ * @param c 连接
+ * @return int 成功返回SUCCESS，内存不足返回FAILURE
+ */
+static int connection_pump(Connection *c)
+{
+    size_t start = 0;
+    while (1)
+    {
+        if (c->out_len - c->out_sent > SERVER_OUTPUT_LIMIT)
+            break;
+        char *nl = memchr(c->in + start, '\n', c->in_len - start);
+        if (nl == NULL)
+            break;
+        *nl = '\0';
+
+        rewind(reply);
+        int quit = serve_request(c, c->in + start) == EXIT_SYSTEM;
+        fflush(reply);
+        long n = ftell(reply);
+        start = nl + 1 - c->in;
+        if (connection_queue(c, reply_buf, n) != SUCCESS)
+            return FAILURE;
+        if (quit)
+        {
+            c->closing = 1;
+            start = c->in_len; // quit之后的请求不再处理
+            break;
+        }
+    }
+    memmove(c->in, c->in + start, c->in_len - start);
+    c->in_len -= start;
+
+    // 缓冲区已满仍没有完整的一行：请求过长，应答后关闭
+    if (c->in_len == sizeof(c->in) && memchr(c->in, '\n', c->in_len) == NULL)
+    {
+        rewind(reply);
+        command_reply(reply, ERR_INVALID_INPUT, "请求过长");
+        c->in_len = 0;
+        c->closing = 1;
+        return connection_queue(c, reply_buf, ftell(reply));
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 读取请求数据
+ *
+ * @param c 连接
+ * @return int 成功返回SUCCESS，连接出错返回FAILURE
+ */
+static int connection_read(Connection *c)
+{
+    while (!c->closing && c->in_len < sizeof(c->in) &&
+           c->out_len - c->out_sent <= SERVER_OUTPUT_LIMIT)
+    {
+        ssize_t n = read(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len);
+        if (n > 0)
+        {
+            c->in_len += n;
+            if (connection_pump(c) != SUCCESS)
+                return FAILURE;
+        }
+        else if (n == 0)
+        {
+            // 对端关闭写方向：处理完已收到的请求（最后一行可以没有换行），应答发完后关闭
+            if (c->in_len > 0 && c->in_len < sizeof(c->in) && c->in[c->in_len - 1] != '\n')
+                c->in[c->in_len++] = '\n';
+            c->closing = 1;
+            return connection_pump(c);
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return SUCCESS;
+        }
+        else if (errno != EINTR)
+        {
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 发送应答数据
+ *
+ * @param c 连接
+ * @return int 成功返回SUCCESS（可能还有未发完的数据），连接出错返回FAILURE
+ */
+static int connection_flush(Connection *c)
+{
+    while (c->out_sent < c->out_len)
+    {
+        ssize_t n = write(c->fd, c->out + c->out_sent, c->out_len - c->out_sent);
+        if (n > 0)
+            c->out_sent += n;
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return SUCCESS;
+        else if (n < 0 && errno == EINTR)
+            continue;
+        else
+            return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 关闭连接并释放其会话引用
+ *
+ * @param c 连接
+ */
+static void connection_close(Connection *c)
+{
+    session_detach(c);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    if (c->prev)
+        c->prev->next = c->next;
+    else
+        connections = c->next;
+    if (c->next)
+        c->next->prev = c->prev;
+    free(c->out);
+    free(c);
+    connection_count--;
+
+    // 有空闲的文件描述符了，恢复接受连接
+    if (accept_paused)
+    {
+        struct epoll_event ev = {.events = EPOLLIN, .data.ptr = NULL};
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) == 0)
+            accept_paused = 0;
+    }
+}
+
+/**
+ * @brief 按连接状态更新关注的epoll事件
+ *
+ * 有待发送数据时关注可写；未关闭且待发送数据不多时关注可读。
+ *
+ * @param c 连接
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int connection_update(Connection *c)
+{
+    size_t backlog = c->out_len - c->out_sent;
+    uint32_t events = 0;
+    if (!c->closing && backlog <= SERVER_OUTPUT_LIMIT)
+        events |= EPOLLIN;
+    if (backlog > 0)
+        events |= EPOLLOUT;
+    if (events == c->events)
+        return SUCCESS;
+    struct epoll_event ev = {.events = events, .data.ptr = c};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c->fd, &ev) != 0)
+        return FAILURE;
+    c->events = events;
+    return SUCCESS;
+}
+
+/**
+ * @brief 处理连接上的epoll事件
+ *
+ * @param c 连接
+ * @param events 就绪的事件
+ */
+static void connection_event(Connection *c, uint32_t events)
+{
+    int ok = !(events & EPOLLERR);
+    if (ok && (events & EPOLLOUT))
+    {
+        ok = connection_flush(c) == SUCCESS;
+        // 发出一部分后可以继续执行暂停的请求
+        if (ok && c->in_len)
+            ok = connection_pump(c) == SUCCESS;
+    }
+    if (ok && (events & (EPOLLIN | EPOLLHUP)))
+        ok = connection_read(c) == SUCCESS;
+    if (ok)
+        ok = connection_flush(c) == SUCCESS;
+    if (!ok || (c->closing && c->out_sent == c->out_len) || connection_update(c) != SUCCESS)
+        connection_close(c);
+}
+
+/**
+ * @brief 接受全部等待中的连接
+ */
+static void accept_connections()
+{
+    while (1)
+    {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EMFILE || errno == ENFILE)
+            {
+                // 文件描述符用尽：暂停接受，等有连接关闭再恢复
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, listen_fd, NULL);
+                accept_paused = 1;
+            }
+            else if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            return;
+        }
+        Connection *c = (Connection *)calloc(1, sizeof(Connection));
+        struct epoll_event ev = {.events = EPOLLIN, .data.ptr = c};
+        if (c == NULL || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            perror("accept connection");
+            free(c);
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->events = EPOLLIN;
+        c->next = connections;
+        if (connections)
+            connections->prev = c;
+        connections = c;
+        connection_count++;
+    }
+}
+
+/**
+ * @brief 创建监听套接字
+ *
+ * @param path 套接字路径（已存在的同名文件会被删除）
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int server_listen(const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "套接字路径过长：%s\n", path);
+        return FAILURE;
+    }
+    strcpy(addr.sun_path, path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0)
+    {
+        perror("socket");
+        return FAILURE;
+    }
+    unlink(path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, SOMAXCONN) != 0)
+    {
+        perror(path);
+        close(listen_fd);
+        listen_fd = -1;
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 运行订票服务器
+ *
+ * 航班数据加载后常驻内存；收到SIGINT或SIGTERM后关闭全部连接（写入各会话的订单），
+ * 合并航班修改日志并删除套接字文件。
+ *
+ * @param path 套接字路径
+ * @return int 正常退出返回SUCCESS，启动失败返回FAILURE
+ */
+int run_server(const char *path)
+{
+    if (list_ensure() != SUCCESS)
+        return FAILURE;
+    raise_fd_limit();
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal; // 不设SA_RESTART，epoll_wait被信号打断后检查退出标志
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    reply = open_memstream(&reply_buf, &reply_size);
+    if (reply == NULL)
+    {
+        perror("open_memstream");
+        return FAILURE;
+    }
+    if (server_listen(path) != SUCCESS)
+    {
+        fclose(reply);
+        free(reply_buf);
+        return FAILURE;
+    }
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = NULL};
+    if (epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) != 0)
+    {
+        perror("epoll");
+        stopping = 1;
+    }
+    else
+    {
+        printf("服务器已启动：%s（航班 %d 条）\n", path, flight_count());
+        fflush(stdout);
+    }
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (!stopping)
+    {
+        int n = epoll_wait(epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            if (events[i].data.ptr == NULL)
+                accept_connections();
+            else
+                connection_event((Connection *)events[i].data.ptr, events[i].events);
+        }
+    }
+
+    // 关闭全部连接，最后一个连接关闭时写入会话的订单
+    while (connections)
+        connection_close(connections);
+    if (epoll_fd >= 0)
+        close(epoll_fd);
+    close(listen_fd);
+    unlink(path);
+    fclose(reply);
+    free(reply_buf);
+    epoll_fd = listen_fd = -1;
+    reply = NULL;
+    reply_buf = NULL;
+    printf("服务器已停止\n");
+    return checkpoint_flights() == SUCCESS ? SUCCESS : FAILURE;
+}
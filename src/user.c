@@ -1,5 +1,7 @@
 #include "../include/head.h"
 
+#define CONNECTION_TOP_K 5 ///< 中转查询列出的方案数
+
 /**
  * @brief 用户功能主菜单
  * 
@@ -11,8 +13,10 @@ int user_function()
 {
     // 显示欢迎信息
     printf("        <|欢迎您！%s用户|>\n\n",user->username);
-    // 创建用户订单链表头节点
-    user->userorders=createHead();
+    // 加载用户订单到会话缓存（本次登录内不再读订单文件），结算上次未计入余额的订单
+    user->userorders=NULL;
+    if(SUCCESS!=order_session_open() || SUCCESS!=booking_settle(user, order_session_current()))
+        printf("读取订单失败！\n");
     while(1)
     {
         // 打印用户菜单
@@ -32,8 +36,7 @@ int user_function()
                 break;
             case '2': // 查看订单
                 system("clear");
-                if(SUCCESS==read_from_order()) // 从文件加载订单数据
-                    view_my_orders();          // 显示订单界面
+                view_my_orders(); // 显示订单界面（订单来自会话缓存）
                 break;
             case '3': // 查看余额
                 system("clear");
@@ -45,7 +48,8 @@ int user_function()
                 break;
             case '5': // 退出登录
                 system("clear");
-                free(user->userorders); // 释放订单内存
+                order_session_close();        // 写入未提交的订单并关闭会话缓存
+                free_node(&user->userorders); // 释放订单链表
                 printf("退出登陆！\n");
                 break;
             default:
@@ -57,13 +61,87 @@ int user_function()
     return SUCCESS;
 }
 
+/**
+ * @brief 选择购票张数和座位
+ *
+ * 自选座位时先显示座位图，再逐张输入座位号；其余方式由订票引擎分配同排相邻的座位。
+ *
+ * @param flight 航班节点
+ * @param count 输出：张数
+ * @param pref 输出：自动分配的选座偏好
+ * @param seats 输出：每张票指定的座位号（自动分配为SEAT_NONE）
+ * @return int 成功返回SUCCESS，输入错误返回ERR_INVALID_INPUT
+ */
+static int choose_seats(const FlightNode* flight, int* count, SeatPref* pref, int* seats)
+{
+    printf("请输入购票张数（1-%d）：\n", SEAT_GROUP_MAX);
+    if(1 != scanf("%d", count) || *count < 1 || *count > SEAT_GROUP_MAX) {
+        while(getchar() != '\n');
+        printf("张数无效！\n");
+        return ERR_INVALID_INPUT;
+    }
+    while(getchar() != '\n');
+    for(int i = 0; i < *count; i++)
+        seats[i] = SEAT_NONE;
+    *pref = SEAT_ANY;
+
+    printf("请选择座位：\n>1.自动分配      >2.靠窗优先      >3.靠过道优先      >4.自选座位\n");
+    char c = getchar();
+    if(c != '\n')
+        while(getchar() != '\n');
+    switch(c) {
+        case '2': // 靠窗
+            *pref = SEAT_WINDOW;
+            break;
+        case '3': // 靠过道
+            *pref = SEAT_AISLE;
+            break;
+        case '4': // 自选
+            seatmap_display(flight);
+            for(int i = 0; i < *count; i++) {
+                char text[SEAT_LABEL_MAX];
+                printf("请输入第%d张票的座位号（如12A）：\n", i + 1);
+                if(1 != scanf("%7s", text)) {
+                    while(getchar() != '\n');
+                    printf("输入格式错误！\n");
+                    return ERR_INVALID_INPUT;
+                }
+                while(getchar() != '\n');
+                if(seat_parse(&flight->flight, text, &seats[i]) != SUCCESS) {
+                    printf("座位号无效！\n");
+                    return ERR_INVALID_INPUT;
+                }
+            }
+            break;
+        default: // 自动分配
+            break;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 显示分配的座位号
+ *
+ * @param flight 航班
+ * @param seats 座位号数组
+ * @param count 座位数
+ */
+static void print_seats(const Flight_n* flight, const int* seats, int count)
+{
+    char label[SEAT_LABEL_MAX];
+    printf("航班%s座位：", flight->number);
+    for(int i = 0; i < count; i++)
+        printf("%s%s", i ? " " : "", seat_label(flight, seats[i], label));
+    printf("\n");
+}
+
 /**
  * @brief 购买机票功能
  * 
  * 流程：
  * 1. 输入出发地和目的地
  * 2. 查询符合条件的航班
- * 3. 选择航班并检查余额
+ * 3. 选择航班、张数和座位并检查余额
  * 4. 扣款并更新订单
  * 
  * @return int 操作状态码(SUCCESS/ERR_NOT_FOUND/FAILURE)
@@ -71,6 +149,8 @@ int user_function()
 int buy_ticket()
 {
     char start_port[20],arrival_port[20], f_n[10]; // 出发地/目的地/航班号
+    if(list_ensure() != SUCCESS) // 航班数据只映射未建立链表时先建立
+        return FAILURE;
     
     // 输入出发地（带格式检查）
     while(1)
@@ -97,26 +177,33 @@ int buy_ticket()
     }
     
     system("clear");
-    // 搜索符合条件的航班
-    search_info(List,start_port,arrival_port);
+    // 按航线索引搜索符合条件的航班（结果为主链表视图，经航线缓存）
+    FlightView result;
+    search_route_sorted(start_port,arrival_port,NULL,&result);
+    int filtered = 0; // 当前结果是否经过筛选（筛选结果不走航线缓存）
     
     // 添加排序菜单循环
     while(1) {
         //read_from_order();
         // 显示搜索结果
-        if(display_all(Searchlist))
+        if(display_view(&result))
         {   
             printf("暂无符合要求的航班！\n");
-            printf("按任意键返回...");
-            getchar();
-            while (getchar() != '\n'); // 等待用户按键
+            printf("输入9查看中转方案，按其他键返回...");
+            char c = getchar();
+            if (c != '\n')
+                while (getchar() != '\n'); // 等待用户按键
             system("clear");
+            free_view(&result);
+            if (c == '9')
+                return buy_connection(start_port, arrival_port);
             return ERR_NOT_FOUND;
         }
         
         // 添加操作菜单
         printf("\n请选择操作：\n");
-        printf(">1.选择航班      >2.按时间排序      >3.按价格排序      >4.重新搜索      >5.返回\n");
+        printf(">1.选择航班      >2.按时间排序      >3.按价格排序      >4.重新搜索      >5.返回\n"
+               ">6.按出发时段筛选  >7.按价格区间筛选  >8.最便宜的航班    >9.中转方案\n");
         char operation = getchar();
         while(getchar() != '\n');
         
@@ -132,61 +219,150 @@ int buy_ticket()
                         }
                         while(getchar()!='\n');
                         // 验证航班是否存在
-                        if(!get_pos(Searchlist,f_n)){
+                        if(!view_find(&result,f_n)){
                             printf("没有查询到此航班！\n");
+                            free_view(&result);
                             return FAILURE;
                         }
                         break;
                     }
                     
-                    // 获取航班价格
-                    double price = get_pos(Searchlist, f_n)->flight.price;
-                    
-                    // 检查余额
-                    if (user->balance < price) 
+                    // 选择张数和座位，检查余额、扣款并提交订单
+                    FlightNode* selected = view_find(&result, f_n);
+                    int count, seats[SEAT_GROUP_MAX];
+                    SeatPref pref;
+                    if (choose_seats(selected, &count, &pref, seats) != SUCCESS)
+                    {
+                        free_view(&result);
+                        return FAILURE;
+                    }
+                    char text[MONEY_TEXT_MAX];
+                    int ret = purchase_flight(selected, count, pref, seats);
+                    if (ret == ERR_BALANCE) 
                     {   
                         system("clear");
-                        printf("余额不足，需要%.2f元\n", price);
-                        printf("当前余额是：%.2f\n",user->balance);
+                        printf("余额不足，需要%s元\n", money_format(selected->flight.price * count, text));
+                        printf("当前余额是：%s\n",money_format(user->balance, text));
                     } 
-                    else 
+                    else if (ret == SUCCESS)
                     {
-                        // 扣款
-                        user->balance -= price;
-                        // 更新余额到文件
-                        update_user_balance(user->balance);  
-                        // 添加订单到链表
-                        tail_insert(user->userorders,&get_pos(Searchlist,f_n)->flight);
-                        // 更新订单文件
-                        if(SUCCESS==update_user_order())
-                        {
-                            printf("购买成功！\n");
-                            // 等待用户按键返回
-                            printf("\n按任意键返回...");
-                            getchar();
-                            while(getchar()!='\n');
-                            system("clear");
-                        }
+                        printf("当前余额是：%s\n", money_format(user->balance, text));
+                        printf("购买成功！\n");
+                        print_seats(&selected->flight, seats, count);
+                        // 等待用户按键返回
+                        printf("\n按任意键返回...");
+                        getchar();
+                        while(getchar()!='\n');
+                        system("clear");
                     }
+                    else if (ret == ERR_SOLD_OUT)
+                        printf("航班%s座位已售完！\n", selected->flight.number);
+                    else if (ret == ERR_SEAT_TAKEN)
+                        printf("所选座位已被占用！\n");
+                    else if (ret == ERR_INVALID_INPUT)
+                        printf("座位号无效！\n");
+                    else
+                        printf("购买失败！\n");
+                    free_view(&result);
                     return SUCCESS;
                 
             case '2': // 按时间排序
                 system("clear");
-                sort_list(&Searchlist, compare_by_departure_time);
+                if(filtered)
+                    sort_view(&result, compare_by_time_then_price);
+                else {
+                    free_view(&result);
+                    search_route_sorted(start_port,arrival_port,compare_by_time_then_price,&result);
+                }
                 break;
                 
             case '3': // 按价格排序
                 system("clear");
-                sort_list(&Searchlist, compare_by_price);
+                if(filtered)
+                    sort_view(&result, compare_by_price_then_time);
+                else {
+                    free_view(&result);
+                    search_route_sorted(start_port,arrival_port,compare_by_price_then_time,&result);
+                }
                 break;
                 
             case '4': // 重新搜索
                 system("clear");
+                free_view(&result);
                 return buy_ticket();
                 
             case '5': // 返回
                 system("clear");
+                free_view(&result);
                 return SUCCESS;
+
+            case '6': // 按出发时段筛选
+            {
+                char from_text[10], to_text[10];
+                short from, to;
+                printf("请输入出发时段（如 08:00 12:00）：\n");
+                if(2!=scanf("%9s %9s",from_text,to_text)){
+                    while(getchar()!='\n');
+                    system("clear");
+                    printf("输入格式错误！\n");
+                    break;
+                }
+                while(getchar()!='\n');
+                system("clear");
+                if(parse_time(from_text,&from)||parse_time(to_text,&to)){
+                    printf("时间格式错误！\n");
+                    break;
+                }
+                // 用时段查询结果替换当前结果（按出发时间排序）
+                free_view(&result);
+                search_route_by_time(start_port,arrival_port,from,to,&result);
+                filtered = 1;
+                break;
+            }
+
+            case '7': // 按价格区间筛选
+            {
+                char low_text[MONEY_TEXT_MAX], high_text[MONEY_TEXT_MAX];
+                Money low, high;
+                printf("请输入价格区间（如 500 900）：\n");
+                if(2!=scanf("%31s %31s",low_text,high_text)||SUCCESS!=money_parse(low_text,&low)||
+                   SUCCESS!=money_parse(high_text,&high)||low>high){
+                    while(getchar()!='\n');
+                    system("clear");
+                    printf("输入格式错误！\n");
+                    break;
+                }
+                while(getchar()!='\n');
+                system("clear");
+                // 用价格区间查询结果替换当前结果（按价格排序）
+                free_view(&result);
+                search_route_by_price(start_port,arrival_port,low,high,&result);
+                filtered = 1;
+                break;
+            }
+
+            case '8': // 最便宜的航班
+            {
+                int k;
+                printf("请输入要显示的航班数：\n");
+                if(1!=scanf("%d",&k)||k<=0){
+                    while(getchar()!='\n');
+                    system("clear");
+                    printf("输入格式错误！\n");
+                    break;
+                }
+                while(getchar()!='\n');
+                system("clear");
+                free_view(&result);
+                search_cheapest(start_port,arrival_port,k,&result);
+                filtered = 1;
+                break;
+            }
+
+            case '9': // 中转方案
+                system("clear");
+                free_view(&result);
+                return buy_connection(start_port,arrival_port);
                 
             default:
                 system("clear");
@@ -200,19 +376,155 @@ int buy_ticket()
     }
 }
 
+/**
+ * @brief 格式化中转方案中的时刻
+ *
+ * @param minutes 相对首段出发当日0点的分钟数
+ * @param buf 输出缓冲区（至少20字节）
+ */
+static void format_clock(long minutes, char* buf)
+{
+    long day = minutes / (24 * 60);
+    minutes %= 24 * 60;
+    if(day > 0)
+        sprintf(buf, "%02ld:%02ld(+%ld天)", minutes / 60, minutes % 60, day);
+    else
+        sprintf(buf, "%02ld:%02ld", minutes / 60, minutes % 60);
+}
+
+/**
+ * @brief 显示一个中转方案
+ *
+ * @param no 方案编号
+ * @param it 中转方案
+ */
+static void print_itinerary(int no, const Itinerary* it)
+{
+    long total = it->arrival[it->count - 1] - it->departure[0];
+    char price[MONEY_TEXT_MAX];
+    printf("方案%d：总价 %s元  共%d段  全程%ld小时%02ld分\n",
+           no, money_format(it->price, price), it->count, total / 60, total % 60);
+    for(int i = 0; i < it->count; i++) {
+        char dep[20], arr[20];
+        const Flight_n* f = &it->legs[i]->flight;
+        format_clock(it->departure[i], dep);
+        format_clock(it->arrival[i], arr);
+        printf("    %-10s %-10s %-12s -> %-10s %-12s\n",
+               f->number, dict_name(DICT_AIRPORT, f->departure_airport), dep,
+               dict_name(DICT_AIRPORT, f->arrival_airport), arr);
+    }
+}
+
+/**
+ * @brief 查询并购买中转方案
+ *
+ * 在航线图上查询最多两次中转的方案，按总价或到达时间列出，
+ * 选定方案后一次扣款并为每个航段生成订单。
+ *
+ * @param s 出发地
+ * @param e 目的地
+ * @return int 操作状态码(SUCCESS/ERR_NOT_FOUND/FAILURE)
+ */
+int buy_connection(const char* s, const char* e)
+{
+    Itinerary plans[CONNECTION_TOP_K];
+    RankOrder order = RANK_BY_PRICE;
+
+    while(1) {
+        int n = search_connections(s, e, MAX_LEGS, MIN_LAYOVER, order, plans, CONNECTION_TOP_K);
+        if(n <= 0) {
+            printf("暂无中转方案！\n");
+            printf("按任意键返回...");
+            getchar();
+            while(getchar() != '\n');
+            system("clear");
+            return ERR_NOT_FOUND;
+        }
+
+        printf("中转时间不少于%d分钟，%s：\n", MIN_LAYOVER,
+               order == RANK_BY_PRICE ? "按总价排序" : "按到达时间排序");
+        for(int i = 0; i < n; i++)
+            print_itinerary(i + 1, &plans[i]);
+
+        printf("\n请选择操作：\n");
+        printf(">1.选择方案      >2.按总价排序      >3.按到达时间排序      >4.返回\n");
+        char operation = getchar();
+        while(getchar() != '\n');
+
+        switch(operation) {
+            case '1':
+            {
+                int no;
+                printf("请输入要购买的方案编号：\n");
+                if(1 != scanf("%d", &no) || no < 1 || no > n) {
+                    while(getchar() != '\n');
+                    system("clear");
+                    printf("没有此方案！\n");
+                    break;
+                }
+                while(getchar() != '\n');
+
+                Itinerary* it = &plans[no - 1];
+                char text[MONEY_TEXT_MAX];
+                int seats[MAX_LEGS];
+                int ret = purchase_itinerary(it, seats);
+                if(ret == ERR_BALANCE) {
+                    system("clear");
+                    printf("余额不足，需要%s元\n", money_format(it->price, text));
+                    printf("当前余额是：%s\n", money_format(user->balance, text));
+                    return FAILURE;
+                }
+                if(ret == ERR_SOLD_OUT) {
+                    printf("有航段座位已售完！\n");
+                } else if(ret != SUCCESS) {
+                    printf("购买失败！\n");
+                } else {
+                    printf("当前余额是：%s\n", money_format(user->balance, text));
+                    printf("购买成功！\n");
+                    for(int i = 0; i < it->count; i++)
+                        print_seats(&it->legs[i]->flight, &seats[i], 1);
+                    printf("\n按任意键返回...");
+                    getchar();
+                    while(getchar() != '\n');
+                    system("clear");
+                }
+                return SUCCESS;
+            }
+
+            case '2':
+                system("clear");
+                order = RANK_BY_PRICE;
+                break;
+
+            case '3':
+                system("clear");
+                order = RANK_BY_ARRIVAL;
+                break;
+
+            case '4':
+                system("clear");
+                return SUCCESS;
+
+            default:
+                system("clear");
+                printf("无效选项！\n");
+        }
+    }
+}
+
 /**
  * @brief 查看用户订单
  * 
  * 显示所有订单并提供退票功能
  */
 void view_my_orders() {
-    read_from_order();//只能放在这，范进循环会覆盖排序功能
+    read_from_order();//由会话缓存建立订单链表，只能放在这，放进循环会覆盖排序功能
     while(1) {
         
         system("clear");
         
         // 显示订单
-        if(display_all(user->userorders)) {
+        if(display_orders(user->userorders)) {
             printf("没有购票信息！\n");
         }
         
@@ -233,14 +545,14 @@ void view_my_orders() {
                 scanf("%9s", n);
                 while(getchar() != '\n');
                 
-                if(delete_flight(user->userorders, n)) {
+                // 从会话缓存退票并提交，同时从显示的链表中删除
+                if(SUCCESS != refund_order(n)) {
                     printf("退票失败！\n");
                     printf("\n按任意键返回...");
                     getchar();
                     while(getchar()!='\n');
                     system("clear");
                 } else {
-                    update_user_order();
                     system("clear");
                     printf("退票成功！\n");
                     printf("\n按任意键返回...");
@@ -252,12 +564,12 @@ void view_my_orders() {
                 
             case '3': // 按时间排序
                 system("clear");
-                sort_list(&(user->userorders), compare_by_departure_time);
+                sort_list(&(user->userorders), compare_by_time_then_price);
                 break;
                 
             case '4': // 按价格排序
                 system("clear");
-                sort_list(&(user->userorders), compare_by_price);
+                sort_list(&(user->userorders), compare_by_price_then_time);
                 break;
                 
             default:
@@ -276,7 +588,8 @@ void view_my_orders() {
  */
 int view_balance()
 {
-    printf("当前余额是：%.2f\n",user->balance);
+    char text[MONEY_TEXT_MAX];
+    printf("当前余额是：%s\n",money_format(user->balance, text));
     char s;
     printf("请选择：\n>1.返回    >2.充值\n");
     s=getchar();
@@ -303,16 +616,23 @@ int view_balance()
  */
 int recharge_balance()
 {
-    double amount;
+    char text[MONEY_TEXT_MAX];
+    Money amount;
     printf("请输入要充值的金额：\n");
-    scanf("%lf", &amount);
+    int valid = scanf("%31s", text) == 1 && money_parse(text, &amount) == SUCCESS;
     while (getchar() != '\n'); // 清空缓冲区
+    if(!valid) {
+        printf("金额格式错误！\n");
+        return FAILURE;
+    }
     
-    // 更新内存余额
-    user->balance+=amount;
-    // 更新文件余额
-    if(update_user_balance(user->balance))
+    // 更新内存和文件余额
+    int ret = recharge(amount);
+    if(ret == ERR_INVALID_INPUT)
+        printf("金额格式错误！\n");
+    if(ret != SUCCESS)
         return FAILURE;
+    printf("当前余额是：%s\n", money_format(user->balance, text));
         // 等待用户按键返回
         printf("\n按任意键返回...");
         getchar();
@@ -324,44 +644,85 @@ int recharge_balance()
 /**
  * @brief 更新用户余额到文件
  * 
- * @param b 新的余额值
+ * @param b 新的余额值（分）
  * @return int 操作状态码(SUCCESS/FAILURE)
  */
-int update_user_balance(double b)
+int update_user_balance(Money b)
 {
-    // 以读写模式打开用户文件
-    FILE *fp = fopen("data/userinfo.txt", "r+b");
-    if (fp == NULL) {
-        perror("fopen");
+    // 通过用户名索引原地更新记录
+    if(userstore_update(user) != SUCCESS)
         return FAILURE;
-    }
-    
-    User tempuser;
-    // 遍历用户文件
-    while(fread(&tempuser,sizeof(User),1,fp))
-    {
-        // 匹配当前用户
-        if(!strcmp(user->username,tempuser.username))
-        {  
-            // 回退文件指针
-            fseek(fp,-sizeof(User),SEEK_CUR);
-            // 写入更新后的用户数据
-            if(1!=fwrite(user,sizeof(User),1,fp))
-            {
-                perror("fwrite");
-            }
-            fclose(fp);
-            printf("当前余额是：%.2f\n", b);
-            return SUCCESS;
-        }
-    }
-    
-    // 未找到用户
-    free(user);
-    fclose(fp);
-    return FAILURE;
+    char text[MONEY_TEXT_MAX];
+    printf("当前余额是：%s\n", money_format(b, text));
+    return SUCCESS;
 }  
 
+/**
+ * @brief 购买一个航班的一张或多张票（不交互）
+ *
+ * 由订票引擎在航班锁和用户锁内分配座位、扣款并提交订单。
+ *
+ * @param flight 航班节点
+ * @param count 张数（1至SEAT_GROUP_MAX）
+ * @param pref 自动分配的选座偏好
+ * @param seats 输入：每张票指定的座位号或SEAT_NONE；输出：分配的座位号
+ * @return int 成功返回SUCCESS，余额不足返回ERR_BALANCE，座位已售完返回ERR_SOLD_OUT，
+ *             指定座位已被占用返回ERR_SEAT_TAKEN，座位号无效返回ERR_INVALID_INPUT，失败返回FAILURE
+ */
+int purchase_flight(const FlightNode* flight, int count, SeatPref pref, int* seats)
+{
+    return booking_purchase_seats(user, order_session_current(), flight->flight.number, count, pref, seats);
+}
+
+/**
+ * @brief 购买中转方案（不交互）
+ *
+ * 一次扣款，每个航段一条订单并自动分配座位，全部航段一次提交。
+ *
+ * @param it 中转方案
+ * @param seats 输出：各航段的座位号（可为NULL）
+ * @return int 成功返回SUCCESS，余额不足返回ERR_BALANCE，
+ *             座位已售完返回ERR_SOLD_OUT，失败返回FAILURE
+ */
+int purchase_itinerary(const Itinerary* it, int* seats)
+{
+    const char* numbers[MAX_LEGS];
+    for(int i = 0; i < it->count; i++)
+        numbers[i] = it->legs[i]->flight.number;
+    return booking_purchase(user, order_session_current(), numbers, it->count, seats);
+}
+
+/**
+ * @brief 退订一个航班的订单（不交互）
+ *
+ * 由订票引擎退票并提交；已建立订单链表时同时从链表中删除。
+ *
+ * @param number 航班号
+ * @return int 成功返回SUCCESS，没有该航班的订单返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+int refund_order(const char* number)
+{
+    char n[10];
+    snprintf(n, sizeof(n), "%s", number);
+    int ret = booking_refund(user, order_session_current(), n);
+    if(ret != SUCCESS)
+        return ret;
+    if(user->userorders)
+        delete_flight(user->userorders, n);
+    return SUCCESS;
+}
+
+/**
+ * @brief 充值（不交互）
+ *
+ * @param amount 充值金额（分）
+ * @return int 成功返回SUCCESS，金额超出范围返回ERR_INVALID_INPUT，写入失败返回FAILURE
+ */
+int recharge(Money amount)
+{
+    return booking_recharge(user, amount);
+}
+
 /**
  * @brief 修改个人信息（密码）
  * 
@@ -374,44 +735,14 @@ int modify_personal_info()
     get_password(new_password, sizeof(new_password)); // 安全获取密码
     printf("\n");
     
-    // 更新内存中的密码
-    memset(user->password,0,P*sizeof(char));
-    strncpy(user->password,new_password,P-1); // 防止缓冲区溢出
-    
-    // 更新用户文件
-    FILE *fp=fopen("data/userinfo.txt", "r+b");
-    if (fp == NULL) {
-        perror("fopen");
+    // 读取最新的用户记录后只修改密码（不覆盖余额）
+    if(booking_set_password(user, new_password) != SUCCESS)
         return FAILURE;
-    }
-
-    User tempuser;
-    // 遍历用户文件
-    while(fread(&tempuser,sizeof(User),1,fp))
-    {
-        // 匹配当前用户
-        if(!strcmp(user->username,tempuser.username))
-        {
-            // 回退文件指针
-            fseek(fp,-sizeof(User),SEEK_CUR);
-            // 写入更新后的用户数据
-            if(1!=fwrite(user,sizeof(User),1,fp))
-            {
-                perror("fwrite");
-            }
-            fclose(fp);
-            printf("密码修改成功！\n");
-                // 等待用户按键返回
-        printf("\n按任意键返回...");
-        getchar();
-        while(getchar()!='\n');
-        system("clear");
-            return SUCCESS;
-        }
-    }
-    
-    // 未找到用户
-    free(user);
-    fclose(fp);
-    return FAILURE;
+    printf("密码修改成功！\n");
+    // 等待用户按键返回
+    printf("\n按任意键返回...");
+    getchar();
+    while(getchar()!='\n');
+    system("clear");
+    return SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,493 @@
+#include "../include/head.h"
+
+#define USERINDEX_MIN_CAPACITY 64 ///< 索引初始槽位数（2的幂）
+
+/**
+ * @struct user_index_header
+ * @brief 用户索引文件头
+ */
+typedef struct user_index_header
+{
+    char magic[4];         ///< 文件标识USERINDEX_MAGIC
+    int record_size;       ///< 建立索引时的用户记录长度
+    unsigned int capacity; ///< 槽位总数（2的幂）
+    unsigned int count;    ///< 已索引的记录数（应等于数据文件记录数）
+} UserIndexHeader;
+
+/**
+ * @struct user_index_slot
+ * @brief 用户索引槽位
+ */
+typedef struct user_index_slot
+{
+    unsigned int hash; ///< 用户名哈希值
+    int record;        ///< 记录号+1（0为空槽，文件扩展时自动清零）
+} UserIndexSlot;
+
+static int data_fd = -1;                  // 用户数据文件
+static int index_fd = -1;                 // 用户索引文件
+static UserIndexHeader *header = NULL;    // 映射的索引文件（文件头后紧跟槽位数组）
+static UserIndexSlot *slots = NULL;       // 槽位数组
+static size_t map_size = 0;               // 映射长度
+static pthread_rwlock_t store_lock = PTHREAD_RWLOCK_INITIALIZER; // 查找和原地更新共享，打开、追加和关闭独占
+
+/**
+ * @brief 计算用户记录在数据文件中的偏移
+ *
+ * @param record 记录号
+ * @return off_t 文件偏移
+ */
+static off_t record_offset(int record)
+{
+    return (off_t)sizeof(FileHeader) + (off_t)record * sizeof(UserDisk);
+}
+
+/**
+ * @brief 计算用户名哈希值（FNV-1a）
+ *
+ * @param username 用户名
+ * @return unsigned int 哈希值
+ */
+static unsigned int hash_username(const char *username)
+{
+    unsigned int h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)username; *p; p++)
+    {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief 按新的槽位数重新映射索引文件
+ *
+ * 文件扩展部分由系统清零，即为空槽；调用者负责重新放置槽位。
+ *
+ * @param capacity 槽位数（2的幂）
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int userindex_map(unsigned int capacity)
+{
+    if (header != NULL)
+        munmap(header, map_size);
+    header = NULL;
+    slots = NULL;
+
+    size_t size = sizeof(UserIndexHeader) + (size_t)capacity * sizeof(UserIndexSlot);
+    if (ftruncate(index_fd, size) != 0)
+    {
+        perror("用户索引扩容失败");
+        return FAILURE;
+    }
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, index_fd, 0);
+    if (p == MAP_FAILED)
+    {
+        perror("映射用户索引失败");
+        return FAILURE;
+    }
+    header = (UserIndexHeader *)p;
+    slots = (UserIndexSlot *)(header + 1);
+    map_size = size;
+    return SUCCESS;
+}
+
+/**
+ * @brief 把记录放入槽位（不检查重名）
+ *
+ * @param hash 用户名哈希值
+ * @param record 记录号
+ */
+static void slot_put(unsigned int hash, int record)
+{
+    size_t pos = hash & (header->capacity - 1);
+    while (slots[pos].record != 0)
+        pos = (pos + 1) & (header->capacity - 1);
+    slots[pos].hash = hash;
+    slots[pos].record = record + 1;
+}
+
+/**
+ * @brief 槽位数翻倍（按保存的哈希值重新放置，无需读取数据文件）
+ *
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int userindex_grow()
+{
+    unsigned int old_capacity = header->capacity;
+    unsigned int count = header->count;
+    UserIndexSlot *old = (UserIndexSlot *)malloc((size_t)old_capacity * sizeof(UserIndexSlot));
+    if (old == NULL)
+    {
+        perror("用户索引malloc");
+        return FAILURE;
+    }
+    memcpy(old, slots, (size_t)old_capacity * sizeof(UserIndexSlot));
+
+    if (userindex_map(old_capacity * 2) != SUCCESS)
+    {
+        free(old);
+        return FAILURE;
+    }
+    memset(slots, 0, (size_t)old_capacity * 2 * sizeof(UserIndexSlot));
+    memcpy(header->magic, USERINDEX_MAGIC, 4);
+    header->record_size = sizeof(UserDisk);
+    header->capacity = old_capacity * 2;
+    header->count = count;
+    for (unsigned int i = 0; i < old_capacity; i++)
+    {
+        if (old[i].record != 0)
+            slot_put(old[i].hash, old[i].record - 1);
+    }
+    free(old);
+    return SUCCESS;
+}
+
+/**
+ * @brief 扫描数据文件重建索引
+ *
+ * @param records 数据文件中的记录数
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int userindex_rebuild(size_t records)
+{
+    unsigned int capacity = USERINDEX_MIN_CAPACITY;
+    while ((size_t)capacity * 5 < records * 10)
+        capacity <<= 1;
+
+    // 先清空旧文件再扩展，保证槽位全部为零
+    if (header != NULL)
+        munmap(header, map_size);
+    header = NULL;
+    if (ftruncate(index_fd, 0) != 0 || userindex_map(capacity) != SUCCESS)
+        return FAILURE;
+    memcpy(header->magic, USERINDEX_MAGIC, 4);
+    header->record_size = sizeof(UserDisk);
+    header->capacity = capacity;
+    header->count = 0;
+    if (records == 0)
+        return SUCCESS;
+
+    size_t size = record_offset(records);
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, data_fd, 0);
+    if (map == MAP_FAILED)
+    {
+        perror("映射用户数据文件失败");
+        return FAILURE;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+    const UserDisk *data = (const UserDisk *)((const char *)map + sizeof(FileHeader));
+    for (size_t i = 0; i < records; i++)
+    {
+        char name[U];
+        memcpy(name, data[i].username, U);
+        name[U - 1] = '\0';
+        slot_put(hash_username(name), (int)i);
+    }
+    header->count = records;
+    munmap(map, size);
+    return SUCCESS;
+}
+
+/**
+ * @brief 把第1版用户数据文件转换为当前格式
+ *
+ * 第1版为无文件头的LegacyUser数组（余额为浮点元）。
+ * 写入临时文件并fsync后rename覆盖，data_fd随后指向新文件。
+ *
+ * @param size 旧文件长度
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int userstore_migrate(size_t size)
+{
+    size_t records = size / sizeof(LegacyUser);
+    char tmpname[64];
+    snprintf(tmpname, sizeof(tmpname), "%s.tmp", USERINFO_FILE);
+    int fd = open(tmpname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        perror("创建用户数据临时文件失败");
+        return FAILURE;
+    }
+
+    int ok = header_write(fd, USERS_FILE_MAGIC, sizeof(UserDisk), records, 0) == SUCCESS;
+    for (size_t i = 0; ok && i < records; i++)
+    {
+        User u;
+        UserDisk d;
+        LegacyUser old;
+        ok = pread(data_fd, &old, sizeof(old), (off_t)i * sizeof(old)) == (ssize_t)sizeof(old);
+        if (!ok)
+            break;
+        user_from_legacy(&old, &u);
+        user_to_disk(&u, &d);
+        ok = pwrite(fd, &d, sizeof(d), record_offset(i)) == (ssize_t)sizeof(d);
+    }
+    if (!ok || fsync(fd) != 0 || rename(tmpname, USERINFO_FILE) != 0)
+    {
+        perror("转换用户数据文件失败");
+        close(fd);
+        unlink(tmpname);
+        return FAILURE;
+    }
+    close(data_fd);
+    data_fd = fd;
+    return SUCCESS;
+}
+
+/**
+ * @brief 打开用户存储（首次调用时打开文件并校验索引）
+ *
+ * 空文件写入文件头；第1版文件先转换为当前格式。
+ *
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int userstore_open()
+{
+    if (header != NULL)
+        return SUCCESS;
+
+    if (data_fd < 0)
+        data_fd = open(USERINFO_FILE, O_RDWR | O_CREAT, 0644);
+    if (index_fd < 0)
+        index_fd = open(USERINDEX_FILE, O_RDWR | O_CREAT, 0644);
+    if (data_fd < 0 || index_fd < 0)
+    {
+        perror("打开用户数据失败");
+        return FAILURE;
+    }
+
+    struct stat ds, is;
+    if (fstat(data_fd, &ds) != 0 || fstat(index_fd, &is) != 0)
+    {
+        perror("读取用户数据信息失败");
+        return FAILURE;
+    }
+    // 校验数据文件头：空文件新建文件头，第1版文件转换
+    FileHeader fh;
+    int ret = ERR_NOT_FOUND;
+    if ((size_t)ds.st_size >= sizeof(fh) && pread(data_fd, &fh, sizeof(fh), 0) == (ssize_t)sizeof(fh))
+        ret = header_check(&fh, USERS_FILE_MAGIC, sizeof(UserDisk));
+    if (ret == ERR_INVALID_INPUT)
+    {
+        fprintf(stderr, "用户数据文件头无效（版本、字节序或校验不符）\n");
+        return FAILURE;
+    }
+    if (ret == FAILURE)
+        return FAILURE;
+    if (ret == ERR_NOT_FOUND)
+    {
+        if (ds.st_size == 0)
+            ret = header_write(data_fd, USERS_FILE_MAGIC, sizeof(UserDisk), 0, 0);
+        else
+            ret = userstore_migrate(ds.st_size);
+        if (ret != SUCCESS || fstat(data_fd, &ds) != 0)
+            return FAILURE;
+    }
+    size_t records = (ds.st_size - sizeof(FileHeader)) / sizeof(UserDisk);
+
+    // 校验已有索引：文件头、长度与数据文件记录数都一致才可直接使用
+    if ((size_t)is.st_size > sizeof(UserIndexHeader))
+    {
+        UserIndexHeader h;
+        if (pread(index_fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) &&
+            !memcmp(h.magic, USERINDEX_MAGIC, 4) && h.record_size == sizeof(UserDisk) &&
+            h.capacity >= USERINDEX_MIN_CAPACITY && !(h.capacity & (h.capacity - 1)) &&
+            (size_t)is.st_size == sizeof(h) + (size_t)h.capacity * sizeof(UserIndexSlot) &&
+            h.count == records)
+        {
+            void *p = mmap(NULL, is.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, index_fd, 0);
+            if (p != MAP_FAILED)
+            {
+                header = (UserIndexHeader *)p;
+                slots = (UserIndexSlot *)(header + 1);
+                map_size = is.st_size;
+                return SUCCESS;
+            }
+        }
+    }
+    return userindex_rebuild(records);
+}
+
+/**
+ * @brief 以共享方式锁住用户存储（未打开时先独占打开）
+ *
+ * 成功时返回后持有共享锁，由调用方解锁。
+ *
+ * @return int 成功返回SUCCESS，打开失败返回FAILURE（未持有锁）
+ */
+static int store_lock_shared()
+{
+    while (1)
+    {
+        pthread_rwlock_rdlock(&store_lock);
+        if (header != NULL)
+            return SUCCESS;
+        pthread_rwlock_unlock(&store_lock);
+
+        pthread_rwlock_wrlock(&store_lock);
+        int ret = userstore_open();
+        pthread_rwlock_unlock(&store_lock);
+        if (ret != SUCCESS)
+            return FAILURE;
+    }
+}
+
+/**
+ * @brief 查找用户名对应的记录号
+ *
+ * @param username 用户名
+ * @param out 输出：用户记录（可为NULL）
+ * @return int 找到返回记录号，未找到返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+static int record_find(const char *username, User *out)
+{
+    if (userstore_open() != SUCCESS)
+        return FAILURE;
+
+    unsigned int h = hash_username(username);
+    size_t pos = h & (header->capacity - 1);
+    while (slots[pos].record != 0)
+    {
+        if (slots[pos].hash == h)
+        {
+            // 哈希相同时读出记录核对用户名
+            UserDisk d;
+            int record = slots[pos].record - 1;
+            if (pread(data_fd, &d, sizeof(d), record_offset(record)) == (ssize_t)sizeof(d))
+            {
+                d.username[U - 1] = '\0';
+                if (!strcmp(d.username, username))
+                {
+                    if (d.crc != record_crc(&d, sizeof(d), offsetof(UserDisk, crc)))
+                    {
+                        fprintf(stderr, "用户%s的记录校验失败\n", username);
+                        return FAILURE;
+                    }
+                    if (out)
+                        user_from_disk(&d, out);
+                    return record;
+                }
+            }
+        }
+        pos = (pos + 1) & (header->capacity - 1);
+    }
+    return ERR_NOT_FOUND;
+}
+
+/**
+ * @brief 按用户名读取用户记录
+ *
+ * @param username 用户名
+ * @param out 输出：用户记录
+ * @return int 找到返回SUCCESS，未找到返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+int userstore_find(const char *username, User *out)
+{
+    if (store_lock_shared() != SUCCESS)
+        return FAILURE;
+    int r = record_find(username, out);
+    pthread_rwlock_unlock(&store_lock);
+    return r >= 0 ? SUCCESS : r;
+}
+
+/**
+ * @brief 追加新用户
+ *
+ * 先写数据文件再更新索引；中途退出时两者记录数不一致，下次打开时重建索引。
+ *
+ * @param u 用户记录
+ * @return int 成功返回SUCCESS，用户名已存在返回ERR_EXISTS，失败返回FAILURE
+ */
+int userstore_add(const User *u)
+{
+    // 追加可能扩容并重新映射索引，独占执行
+    pthread_rwlock_wrlock(&store_lock);
+    int r = record_find(u->username, NULL);
+    int ret = SUCCESS;
+    if (r >= 0)
+        ret = ERR_EXISTS;
+    else if (r == FAILURE)
+        ret = FAILURE;
+    else if ((header->count + 1) * 10 > header->capacity * 7 && userindex_grow() != SUCCESS)
+        ret = FAILURE;
+    if (ret != SUCCESS)
+    {
+        pthread_rwlock_unlock(&store_lock);
+        return ret;
+    }
+
+    int record = header->count;
+    UserDisk d;
+    user_to_disk(u, &d);
+    if (pwrite(data_fd, &d, sizeof(d), record_offset(record)) != (ssize_t)sizeof(d) ||
+        header_write(data_fd, USERS_FILE_MAGIC, sizeof(UserDisk), record + 1, 0) != SUCCESS)
+    {
+        perror("fwrite");
+        pthread_rwlock_unlock(&store_lock);
+        return FAILURE;
+    }
+    slot_put(hash_username(u->username), record);
+    header->count++;
+    pthread_rwlock_unlock(&store_lock);
+    return SUCCESS;
+}
+
+/**
+ * @brief 按用户名原地更新用户记录
+ *
+ * @param u 用户记录
+ * @return int 成功返回SUCCESS，未找到返回ERR_NOT_FOUND，失败返回FAILURE
+ */
+int userstore_update(const User *u)
+{
+    // 不同记录的原地写互不影响，共享锁即可（同一用户的更新由调用方串行化）
+    if (store_lock_shared() != SUCCESS)
+        return FAILURE;
+    int record = record_find(u->username, NULL);
+    int ret = record < 0 ? record : SUCCESS;
+    if (record >= 0)
+    {
+        UserDisk d;
+        user_to_disk(u, &d);
+        if (pwrite(data_fd, &d, sizeof(d), record_offset(record)) != (ssize_t)sizeof(d))
+        {
+            perror("fwrite");
+            ret = FAILURE;
+        }
+    }
+    pthread_rwlock_unlock(&store_lock);
+    return ret;
+}
+
+/**
+ * @brief 打开用户存储并完成数据文件格式转换
+ *
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+int userstore_migrate_all()
+{
+    pthread_rwlock_wrlock(&store_lock);
+    int ret = userstore_open();
+    pthread_rwlock_unlock(&store_lock);
+    return ret;
+}
+
+/**
+ * @brief 关闭用户存储（数据文件被其他方式改写后须先关闭）
+ */
+void userstore_close()
+{
+    pthread_rwlock_wrlock(&store_lock);
+    if (header != NULL)
+        munmap(header, map_size);
+    header = NULL;
+    slots = NULL;
+    map_size = 0;
+    if (data_fd >= 0)
+        close(data_fd);
+    if (index_fd >= 0)
+        close(index_fd);
+    data_fd = index_fd = -1;
+    pthread_rwlock_unlock(&store_lock);
+}
@@ -0,0 +1,365 @@
+/**
+ * @file loadgen.c
+ * @brief 订票服务器压力测试客户端
+ *
+ * 建立大量并发连接（每个连接一个会话），每个连接先注册、登录并充值，
+ * 然后循环发送查询/购票/退票请求，每次只有一个未完成的请求（闭环）。
+ * 结束后输出吞吐量和请求延迟分布。
+ *
+ * 编译：make bin/loadgen
+ * 用法：bin/loadgen [-s 套接字] [-c 连接数] [-n 每连接请求数] [-u 用户数]
+ *                   [-w read|book|mixed] [-f 航班号] [-r 出发地] [-t 目的地]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+#define DEFAULT_SOCKET "data/flight.sock" ///< 默认套接字路径（与服务器一致）
+#define REQUEST_MAX 128                   ///< 一条请求的最大长度
+#define MAX_EVENTS 256                    ///< 每次epoll_wait最多处理的事件数
+#define SETUP_STEPS 3                     ///< 计时前的准备请求数（注册、登录、充值）
+
+/**
+ * @struct client
+ * @brief 一个模拟客户端连接
+ */
+typedef struct client
+{
+    int fd;                  ///< 套接字
+    int id;                  ///< 连接编号
+    int step;                ///< 已完成的请求数（含准备请求）
+    char request[REQUEST_MAX]; ///< 当前请求
+    size_t len;              ///< 请求长度
+    size_t sent;             ///< 已发送字节数
+    char line[8];            ///< 当前应答行的开头
+    size_t line_len;         ///< line中的字节数
+    struct timespec start;   ///< 当前请求的发送时刻
+} Client;
+
+static const char *socket_path = DEFAULT_SOCKET; // 套接字路径
+static int connections = 100;                    // 连接数
+static int requests = 100;                       // 每个连接计时的请求数
+static int users = 0;                            // 用户数（0表示每个连接一个用户）
+static const char *workload = "mixed";           // 请求组合
+static const char *flight = "CA1501";            // 购票的航班号
+static const char *from = "北京";                // 查询的出发地
+static const char *to = "上海";                  // 查询的目的地
+
+static uint32_t *latencies = NULL; // 计时请求的延迟（微秒）
+static int measured = 0;           // 已完成的计时请求数
+static int errors = 0;             // 返回error的计时请求数
+static int finished = 0;           // 已完成全部请求的连接数
+static struct timespec measure_start; // 第一条计时请求的发送时刻
+static int measure_started = 0;       // 已开始计时
+
+/**
+ * @brief 两个时刻之间的微秒数
+ */
+static uint32_t elapsed_us(const struct timespec *a, const struct timespec *b)
+{
+    return (uint32_t)((b->tv_sec - a->tv_sec) * 1000000L + (b->tv_nsec - a->tv_nsec) / 1000);
+}
+
+/**
+ * @brief 生成连接的下一条请求
+ *
+ * @param c 连接
+ */
+static void next_request(Client *c)
+{
+    int u = users > 0 ? c->id % users : c->id;
+    int k = c->step - SETUP_STEPS;
+    if (c->step == 0)
+        snprintf(c->request, REQUEST_MAX, "register lg%d pw\n", u);
+    else if (c->step == 1)
+        snprintf(c->request, REQUEST_MAX, "login lg%d pw\n", u);
+    else if (c->step == 2)
+        snprintf(c->request, REQUEST_MAX, "recharge 1000000\n");
+    else if (!strcmp(workload, "read"))
+        snprintf(c->request, REQUEST_MAX, k % 2 ? "orders\n" : "search %s %s price\n", from, to);
+    else if (!strcmp(workload, "book"))
+        snprintf(c->request, REQUEST_MAX, k % 2 ? "refund %s\n" : "book %s\n", flight);
+    else if (k % 4 == 0)
+        snprintf(c->request, REQUEST_MAX, "search %s %s\n", from, to);
+    else if (k % 4 == 1)
+        snprintf(c->request, REQUEST_MAX, "book %s\n", flight);
+    else if (k % 4 == 2)
+        snprintf(c->request, REQUEST_MAX, "orders\n");
+    else
+        snprintf(c->request, REQUEST_MAX, "refund %s\n", flight);
+    c->len = strlen(c->request);
+    c->sent = 0;
+    clock_gettime(CLOCK_MONOTONIC, &c->start);
+    if (c->step == SETUP_STEPS && !measure_started)
+    {
+        measure_start = c->start;
+        measure_started = 1;
+    }
+}
+
+/**
+ * @brief 发送当前请求中尚未发出的部分
+ *
+ * @param c 连接
+ * @return int 成功返回0，连接出错返回-1
+ */
+static int send_request(Client *c)
+{
+    while (c->sent < c->len)
+    {
+        ssize_t n = write(c->fd, c->request + c->sent, c->len - c->sent);
+        if (n > 0)
+            c->sent += n;
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return 0;
+        else if (n < 0 && errno == EINTR)
+            continue;
+        else
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 一条应答结束：记录延迟并发送下一条请求
+ *
+ * @param c 连接
+ * @param failed 应答是否为error
+ * @return int 连接继续返回0，全部请求完成返回1，出错返回-1
+ */
+static int complete_request(Client *c, int failed)
+{
+    if (c->step >= SETUP_STEPS)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        latencies[measured++] = elapsed_us(&c->start, &now);
+        errors += failed;
+    }
+    else if (failed && c->step > 0)
+    {
+        fprintf(stderr, "连接%d准备失败：%s", c->id, c->request);
+        return -1;
+    }
+    if (++c->step == SETUP_STEPS + requests)
+        return 1;
+    next_request(c);
+    return send_request(c);
+}
+
+/**
+ * @brief 读取应答
+ *
+ * 应答由若干数据行和结尾的"ok"或"error\t..."行组成，逐字节识别行首，不缓存整行。
+ *
+ * @param c 连接
+ * @return int 连接继续返回0，全部请求完成返回1，出错返回-1
+ */
+static int read_reply(Client *c)
+{
+    char buf[4096];
+    while (1)
+    {
+        ssize_t n = read(c->fd, buf, sizeof(buf));
+        if (n == 0)
+            return -1;
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+        for (ssize_t i = 0; i < n; i++)
+        {
+            if (buf[i] != '\n')
+            {
+                if (c->line_len < sizeof(c->line))
+                    c->line[c->line_len++] = buf[i];
+                continue;
+            }
+            int ok = c->line_len == 2 && !memcmp(c->line, "ok", 2);
+            int failed = c->line_len >= 6 && !memcmp(c->line, "error\t", 6);
+            c->line_len = 0;
+            if (ok || failed)
+            {
+                int ret = complete_request(c, failed);
+                if (ret != 0)
+                    return ret;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 连接服务器
+ *
+ * @return int 成功返回套接字，失败返回-1
+ */
+static int connect_server()
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief 延迟升序比较（qsort）
+ */
+static int compare_latency(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 输出统计结果
+ *
+ * @param seconds 从第一条计时请求发出到全部完成的耗时（秒）
+ */
+static void report(double seconds)
+{
+    qsort(latencies, measured, sizeof(uint32_t), compare_latency);
+    printf("连接数: %d  用户数: %d  请求组合: %s\n", connections, users > 0 ? users : connections, workload);
+    printf("完成请求: %d  失败应答: %d  完成连接: %d\n", measured, errors, finished);
+    printf("耗时: %.3f s  吞吐量: %.0f 请求/秒\n", seconds, seconds > 0 ? measured / seconds : 0);
+    if (measured > 0)
+    {
+        printf("延迟(us): p50 %u  p90 %u  p99 %u  最大 %u\n", latencies[measured / 2],
+               latencies[(int)(measured * 0.9)], latencies[(int)(measured * 0.99)], latencies[measured - 1]);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "s:c:n:u:w:f:r:t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 's': socket_path = optarg; break;
+        case 'c': connections = atoi(optarg); break;
+        case 'n': requests = atoi(optarg); break;
+        case 'u': users = atoi(optarg); break;
+        case 'w': workload = optarg; break;
+        case 'f': flight = optarg; break;
+        case 'r': from = optarg; break;
+        case 't': to = optarg; break;
+        default:
+            fprintf(stderr, "用法：%s [-s 套接字] [-c 连接数] [-n 每连接请求数] [-u 用户数] "
+                            "[-w read|book|mixed] [-f 航班号] [-r 出发地] [-t 目的地]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (connections <= 0 || requests <= 0)
+    {
+        fprintf(stderr, "连接数和请求数须为正数\n");
+        return 2;
+    }
+
+    // 每个连接一个文件描述符
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0)
+    {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    Client *clients = (Client *)calloc(connections, sizeof(Client));
+    latencies = (uint32_t *)malloc((size_t)connections * requests * sizeof(uint32_t));
+    int ep = epoll_create1(0);
+    if (clients == NULL || latencies == NULL || ep < 0)
+    {
+        perror("loadgen");
+        return 1;
+    }
+
+    // 建立全部连接并发出第一条请求
+    for (int i = 0; i < connections; i++)
+    {
+        Client *c = &clients[i];
+        c->id = i;
+        c->fd = connect_server();
+        if (c->fd < 0)
+        {
+            fprintf(stderr, "连接%d失败：%s\n", i, strerror(errno));
+            return 1;
+        }
+        struct epoll_event ev = {.events = EPOLLIN | EPOLLOUT, .data.ptr = c};
+        epoll_ctl(ep, EPOLL_CTL_ADD, c->fd, &ev);
+        next_request(c);
+    }
+
+    struct timespec end;
+    int active = connections;
+    struct epoll_event events[MAX_EVENTS];
+    while (active > 0)
+    {
+        int n = epoll_wait(ep, events, MAX_EVENTS, -1);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            Client *c = (Client *)events[i].data.ptr;
+            int ret = 0;
+            if (events[i].events & EPOLLOUT)
+            {
+                ret = send_request(c);
+                // 请求发完后只关注应答
+                if (ret == 0 && c->sent == c->len)
+                {
+                    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = c};
+                    epoll_ctl(ep, EPOLL_CTL_MOD, c->fd, &ev);
+                }
+            }
+            if (ret == 0 && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+                ret = read_reply(c);
+            if (ret == 0 && c->sent < c->len)
+            {
+                struct epoll_event ev = {.events = EPOLLIN | EPOLLOUT, .data.ptr = c};
+                epoll_ctl(ep, EPOLL_CTL_MOD, c->fd, &ev);
+            }
+            if (ret != 0)
+            {
+                if (ret == 1)
+                    finished++;
+                else
+                    fprintf(stderr, "连接%d异常断开\n", c->id);
+                epoll_ctl(ep, EPOLL_CTL_DEL, c->fd, NULL);
+                close(c->fd);
+                active--;
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    report(measure_started ? (end.tv_sec - measure_start.tv_sec) + (end.tv_nsec - measure_start.tv_nsec) / 1e9 : 0);
+    close(ep);
+    free(clients);
+    free(latencies);
+    return finished == connections ? 0 : 1;
+}
@@ -0,0 +1,439 @@
+/**
+ * @file stress.c
+ * @brief 订票引擎并发一致性测试
+ *
+ * 多个线程在共享的航班和用户上随机调用booking_purchase()、booking_purchase_seats()、
+ * booking_refund()和booking_recharge()，结束后核对：
+ * 已售座位数不超过座位数、没有残留的暂占座位、已售座位数等于有效订单数、
+ * 座位图的已分配座位数等于订单的座位数，用户记录的余额等于初始余额加充值减去新增有效订单的票价。
+ * 已结算的事件序号等于订单文件的最后一个事件。
+ * 然后每个用户一个线程并发退订全部订单，核对座位全部归还、余额全部退回。
+ * 两个阶段中采样线程反复读取座位库存，任何时刻都应满足0 ≤ 已售、0 ≤ 暂占、已售 + 暂占 ≤ 座位数。
+ * 任何一项不符时退出码为1。
+ *
+ * 直接链接订票系统的源文件，在当前目录的data下读写数据，应在数据目录的副本中运行。
+ * 航班（ST01…）和用户（stress0…）不存在时创建，重复运行时沿用上次留下的订单。
+ *
+ * 编译：make bin/stress
+ * 用法：bin/stress [-d 工作目录] [-t 线程数] [-n 每线程操作数] [-u 用户数] [-f 航班数] [-c 座位数]
+ */
+#include <stdarg.h>
+#include "../include/head.h"
+
+#define STRESS_FLIGHTS_MAX 64         ///< 航班数上限
+#define STRESS_USERS_MAX 256          ///< 用户数上限
+#define STRESS_THREADS_MAX 256        ///< 线程数上限
+#define STRESS_PRICE "100.00"         ///< 测试航班票价
+#define STRESS_FUNDS (100000 * 100)   ///< 准备阶段给每个用户充值的金额（分）
+#define STRESS_RECHARGE_MAX (500 * 100) ///< 运行中单次充值的最大金额（分）
+
+/**
+ * @struct stress_user
+ * @brief 一个测试用户：所有线程共用同一份用户记录和订单会话
+ */
+typedef struct stress_user
+{
+    User u;               ///< 用户记录（余额由订票引擎在用户锁内修改）
+    OrderSession *orders; ///< 订单会话
+    Money initial;        ///< 开始时的余额
+    Money initial_spent;  ///< 开始时有效订单的票价合计
+    Money recharged;      ///< 运行中充值成功的金额（原子累加）
+} StressUser;
+
+static int threads = 8;       // 线程数
+static int operations = 2000; // 每个线程的操作数
+static int user_count = 4;    // 用户数
+static int flights = 4;       // 航班数
+static int capacity = 30;     // 每个航班的座位数
+
+static StressUser users[STRESS_USERS_MAX];          // 测试用户
+static char numbers[STRESS_FLIGHTS_MAX][10];        // 测试航班号
+static long counts[4];                              // 各类操作的成功次数（原子累加）
+static const char *op_names[4] = {"购票", "多张购票", "退票", "充值"};
+static int failures = 0;                            // 不符合不变式的项数（原子累加）
+static int other_orders[STRESS_FLIGHTS_MAX];        // 本次测试用户以外的有效订单数（开始时统计）
+static int other_seated[STRESS_FLIGHTS_MAX];        // 本次测试用户以外占用的座位数（开始时统计）
+static int running = 0;                             // 工作线程运行中（原子读写，采样线程据此退出）
+static long samples = 0;                            // 采样线程读取座位库存的次数
+
+/**
+ * @brief 记录一项不符合的不变式
+ */
+static void violation(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    printf("不一致：");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    __atomic_fetch_add(&failures, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 切换到测试用户：订单函数通过全局user和当前会话工作
+ */
+static void enter(StressUser *s)
+{
+    user = &s->u;
+    order_session_bind(s->orders);
+}
+
+/**
+ * @brief 回到未登录状态
+ */
+static void leave()
+{
+    user = NULL;
+    order_session_bind(NULL);
+}
+
+/**
+ * @brief 由会话建立订单链表，按测试航班统计有效订单和有座位号的订单
+ *
+ * 订单的座位号须在座位图中已分配。
+ *
+ * @param s 测试用户（须已enter()）
+ * @param orders 累加：各航班的有效订单数
+ * @param seated 累加：各航班有座位号的订单数
+ * @return Money 有效订单的票价合计（分）
+ */
+static Money tally(StressUser *s, int *orders, int *seated)
+{
+    Money spent = 0;
+    if (read_from_order() != SUCCESS)
+    {
+        violation("建立%s的订单链表失败", s->u.username);
+        return 0;
+    }
+    for (FlightNode *p = s->u.userorders->next; p; p = p->next)
+    {
+        spent += p->flight.price;
+        int k = 0;
+        while (k < flights && strcmp(numbers[k], p->flight.number))
+            k++;
+        if (k == flights)
+            continue;
+        orders[k]++;
+        if (p->flight.seat == SEAT_NONE)
+            continue;
+        seated[k]++;
+        if (!seat_is_taken(index_find(numbers[k]), p->flight.seat))
+            violation("%s的订单座位%d在%s的座位图中未分配", s->u.username, p->flight.seat, numbers[k]);
+    }
+    free_node(&s->u.userorders);
+    return spent;
+}
+
+/**
+ * @brief 准备测试航班：不存在时创建，已存在时沿用
+ *
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int setup_flights()
+{
+    for (int i = 0; i < flights; i++)
+    {
+        char text[128];
+        sprintf(numbers[i], "ST%02d", i + 1);
+        snprintf(text, sizeof(text), "%.9s 测试航空 08:00 10:00 测试甲 测试乙 准点 %s %d", numbers[i], STRESS_PRICE, capacity);
+        int ret = add_flight(text);
+        if (ret != SUCCESS && ret != ERR_EXISTS)
+        {
+            printf("创建航班%s失败（%d）\n", numbers[i], ret);
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 准备测试用户：不存在时注册，打开订单会话、结算并充值
+ *
+ * 同时统计测试航班上其他用户（如上次运行的更多测试用户）的订单，核对时计入。
+ *
+ * @return int 成功返回SUCCESS，失败返回FAILURE
+ */
+static int setup_users()
+{
+    for (int i = 0; i < user_count; i++)
+    {
+        StressUser *s = &users[i];
+        char name[U];
+        snprintf(name, sizeof(name), "stress%d", i);
+        if (userstore_find(name, &s->u) != SUCCESS)
+        {
+            memset(&s->u, 0, sizeof(User));
+            strcpy(s->u.username, name);
+            strcpy(s->u.password, "1");
+            s->u.type = USER;
+            if (userstore_add(&s->u) != SUCCESS)
+            {
+                printf("注册用户%s失败\n", name);
+                return FAILURE;
+            }
+        }
+        s->u.userorders = NULL;
+        if ((s->orders = order_session_create()) == NULL)
+            return FAILURE;
+        enter(s);
+        int ret = order_session_open();
+        if (ret == SUCCESS)
+            ret = booking_settle(&s->u, s->orders);
+        if (ret == SUCCESS)
+            ret = booking_recharge(&s->u, STRESS_FUNDS);
+        s->initial = s->u.balance;
+        s->initial_spent = tally(s, other_orders, other_seated);
+        leave();
+        if (ret != SUCCESS)
+        {
+            printf("准备用户%s失败（%d）\n", name, ret);
+            return FAILURE;
+        }
+    }
+    for (int k = 0; k < flights; k++)
+    {
+        FlightNode *f = index_find(numbers[k]);
+        other_orders[k] = f->flight.sold - other_orders[k];
+        other_seated[k] = seat_taken_count(f) - other_seated[k];
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 工作线程：在随机的用户和航班上随机操作
+ */
+static void *worker(void *arg)
+{
+    unsigned int seed = (unsigned int)(uintptr_t)arg * 2654435761u + 1;
+    for (int i = 0; i < operations; i++)
+    {
+        StressUser *s = &users[rand_r(&seed) % user_count];
+        const char *legs[2] = {numbers[rand_r(&seed) % flights], numbers[rand_r(&seed) % flights]};
+        int op = rand_r(&seed) % 4;
+        int ret = FAILURE;
+        switch (op)
+        {
+        case 0: // 一个或两个航段
+            ret = booking_purchase(&s->u, s->orders, legs, legs[0] == legs[1] ? 1 : 2, NULL);
+            break;
+        case 1: // 同一航班的多张票，座位自动分配
+        {
+            int seats[3] = {SEAT_NONE, SEAT_NONE, SEAT_NONE};
+            ret = booking_purchase_seats(&s->u, s->orders, legs[0], 1 + rand_r(&seed) % 3, SEAT_ANY, seats);
+            break;
+        }
+        case 2:
+            ret = booking_refund(&s->u, s->orders, legs[0]);
+            break;
+        case 3:
+        {
+            Money amount = 1 + rand_r(&seed) % STRESS_RECHARGE_MAX;
+            ret = booking_recharge(&s->u, amount);
+            if (ret == SUCCESS)
+                __atomic_fetch_add(&s->recharged, amount, __ATOMIC_RELAXED);
+            break;
+        }
+        }
+        if (ret == SUCCESS)
+            __atomic_fetch_add(&counts[op], 1, __ATOMIC_RELAXED);
+        else if (ret != ERR_SOLD_OUT && ret != ERR_NOT_FOUND && ret != ERR_BALANCE)
+            violation("线程%ld的%s返回%d", (long)(uintptr_t)arg, op_names[op], ret);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 退订线程：退订一个用户在测试航班上的全部订单
+ */
+static void *drain(void *arg)
+{
+    StressUser *s = arg;
+    for (int k = 0; k < flights; k++)
+    {
+        int ret;
+        while ((ret = booking_refund(&s->u, s->orders, numbers[k])) == SUCCESS)
+            __atomic_fetch_add(&counts[2], 1, __ATOMIC_RELAXED);
+        if (ret != ERR_NOT_FOUND)
+            violation("%s退订%s返回%d", s->u.username, numbers[k], ret);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 采样线程：工作线程运行期间反复读取各航班的座位库存
+ *
+ * 每个航班第一次不符时报告一次。
+ */
+static void *sampler(void *arg)
+{
+    (void)arg;
+    char reported[STRESS_FLIGHTS_MAX] = {0};
+    const Flight_n *watched[STRESS_FLIGHTS_MAX];
+    for (int k = 0; k < flights; k++)
+        watched[k] = &index_find(numbers[k])->flight;
+    while (__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+    {
+        for (int k = 0; k < flights; k++)
+        {
+            const Flight_n *f = watched[k];
+            int sold, held;
+            seats_stock(f, &sold, &held);
+            if (!reported[k] && (sold < 0 || held < 0 || sold + held > f->capacity))
+            {
+                violation("%s座位库存已售%d、暂占%d，座位数%d", numbers[k], sold, held, f->capacity);
+                reported[k] = 1;
+            }
+        }
+        samples++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 启动一组线程并在采样线程运行期间等待它们结束
+ *
+ * @param count 线程数
+ * @param run 线程函数
+ * @param args 各线程的参数（NULL时传线程序号）
+ * @return double 耗时（秒）
+ */
+static double run_phase(int count, void *(*run)(void *), void **args)
+{
+    struct timespec start, end;
+    pthread_t tid[STRESS_THREADS_MAX], watch;
+    __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+    pthread_create(&watch, NULL, sampler, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < count; i++)
+        pthread_create(&tid[i], NULL, run, args ? args[i] : (void *)i);
+    for (int i = 0; i < count; i++)
+        pthread_join(tid[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+    pthread_join(watch, NULL);
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief 核对航班座位、订单和余额
+ */
+static void check()
+{
+    int orders[STRESS_FLIGHTS_MAX], seated[STRESS_FLIGHTS_MAX];
+    memcpy(orders, other_orders, sizeof(orders));
+    memcpy(seated, other_seated, sizeof(seated));
+
+    for (int i = 0; i < user_count; i++)
+    {
+        StressUser *s = &users[i];
+        enter(s);
+        Money spent = tally(s, orders, seated);
+        uint32_t seq = order_session_seq(s->orders);
+        leave();
+
+        // 余额以用户记录为准，不经结算补记
+        User stored;
+        if (userstore_find(s->u.username, &stored) != SUCCESS)
+        {
+            violation("读取用户%s失败", s->u.username);
+            continue;
+        }
+        Money expected = s->initial + s->recharged - (spent - s->initial_spent);
+        if (stored.balance != expected)
+            violation("%s的余额%lld，应为%lld", s->u.username, (long long)stored.balance, (long long)expected);
+        if (stored.order_seq != seq)
+            violation("%s已结算到事件%u，订单文件到事件%u", s->u.username, stored.order_seq, seq);
+    }
+
+    for (int k = 0; k < flights; k++)
+    {
+        FlightNode *f = index_find(numbers[k]);
+        if (f->flight.sold > f->flight.capacity)
+            violation("%s已售%d超过座位数%d", numbers[k], f->flight.sold, f->flight.capacity);
+        if (f->flight.held != 0)
+            violation("%s残留暂占座位%d", numbers[k], f->flight.held);
+        if (f->flight.sold != orders[k])
+            violation("%s已售%d，有效订单%d", numbers[k], f->flight.sold, orders[k]);
+        if (seat_taken_count(f) != seated[k])
+            violation("%s座位图已分配%d，订单座位%d", numbers[k], seat_taken_count(f), seated[k]);
+        printf("%s：座位%d，已售%d，有效订单%d\n", numbers[k], f->flight.capacity, f->flight.sold, orders[k]);
+    }
+}
+
+/**
+ * @brief 关闭测试用户的订单会话（写入未提交的订单、需要时压缩订单文件）
+ */
+static void close_sessions()
+{
+    for (int i = 0; i < user_count; i++)
+    {
+        StressUser *s = &users[i];
+        enter(s);
+        if (order_session_close() != SUCCESS)
+            violation("%s的订单写入失败", s->u.username);
+        leave();
+        order_session_destroy(s->orders);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "d:t:n:u:f:c:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            if (chdir(optarg) != 0)
+            {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        case 't': threads = atoi(optarg); break;
+        case 'n': operations = atoi(optarg); break;
+        case 'u': user_count = atoi(optarg); break;
+        case 'f': flights = atoi(optarg); break;
+        case 'c': capacity = atoi(optarg); break;
+        default:
+            fprintf(stderr, "用法：%s [-d 工作目录] [-t 线程数] [-n 每线程操作数] [-u 用户数] [-f 航班数] [-c 座位数]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1 || threads > STRESS_THREADS_MAX || operations < 0 ||
+        user_count < 1 || user_count > STRESS_USERS_MAX ||
+        flights < 1 || flights > STRESS_FLIGHTS_MAX ||
+        capacity < 1 || capacity > FLIGHT_CAPACITY_MAX)
+    {
+        fprintf(stderr, "参数超出范围\n");
+        return 1;
+    }
+
+    list();
+    if (list_ensure() != SUCCESS || setup_flights() != SUCCESS || setup_users() != SUCCESS)
+    {
+        release_system();
+        return 1;
+    }
+
+    double seconds = run_phase(threads, worker, NULL);
+    printf("%d个线程共%d次操作，耗时%.3f s\n", threads, threads * operations, seconds);
+    for (int i = 0; i < 4; i++)
+        printf("%s成功：%ld\n", op_names[i], counts[i]);
+    check();
+
+    // 并发退订全部订单：座位应全部归还，余额应全部退回
+    void *args[STRESS_USERS_MAX];
+    long refunds = counts[2];
+    for (int i = 0; i < user_count; i++)
+        args[i] = &users[i];
+    seconds = run_phase(user_count, drain, args);
+    printf("%d个线程退订%ld张，耗时%.3f s\n", user_count, counts[2] - refunds, seconds);
+    check();
+    close_sessions();
+    printf("座位库存采样%ld次\n", samples);
+    release_system();
+    printf(failures ? "发现%d处不一致\n" : "全部一致\n", failures);
+    return failures ? 1 : 0;
+}